@@ -0,0 +1,455 @@
+#include "Collector.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace Collector
+{
+    namespace
+    {
+        static constexpr uint64_t TimerId = UINT64_MAX;
+        static constexpr uint64_t SignalId = UINT64_MAX - 1;
+        static constexpr int MaxEvents = 256;
+        static constexpr std::string_view RecordingHeader = "Timestamp,TimestampAligned,Raw,Filtered,BPM\n";
+
+        template <typename T>
+        char* appendValue(char* first, char* last, const T value, const char separator)
+        {
+            auto [ptr, ec] = std::to_chars(first, last - 1, value); //< leaves room for the separator
+            *ptr = separator;
+            return ptr + 1;
+        }
+
+        double cpuSeconds()
+        {
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+                    + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+        }
+    }
+
+    ClockAligner::ClockAligner(const uint64_t windowUs)
+        : windowUs_{windowUs}
+        , windowStart_{}
+        , currentMin_{}
+        , previousMin_{}
+        , offset_{}
+        , valid_{false}
+    { }
+
+    uint64_t ClockAligner::update(const uint64_t deviceUs, const uint64_t hostUs)
+    {
+        const auto offset = static_cast<int64_t>(hostUs) - static_cast<int64_t>(deviceUs);
+        if(!valid_)
+        {
+            windowStart_ = hostUs;
+            currentMin_ = previousMin_ = offset_ = offset;
+            valid_ = true;
+            return 0;
+        }
+        if(hostUs - windowStart_ >= windowUs_)
+        {
+            previousMin_ = currentMin_;
+            currentMin_ = offset;
+            windowStart_ = hostUs;
+        }
+        else
+        {
+            currentMin_ = std::min(currentMin_, offset);
+        }
+        offset_ = std::min(currentMin_, previousMin_);
+        return static_cast<uint64_t>(offset - offset_);
+    }
+
+    void ClockAligner::reset()
+    {
+        valid_ = false;
+    }
+
+    bool DropCounter::update(const uint64_t deviceUs)
+    {
+        if(!valid_ || deviceUs < lastUs_)
+        {
+            const bool restarted = valid_;
+            lastUs_ = deviceUs;
+            valid_ = true;
+            numPendingDropped_ = 0;
+            numOutOfRange_ = 0;
+            return !restarted;
+        }
+        const auto interval = deviceUs - lastUs_;
+        lastUs_ = deviceUs;
+        if(interval == 0)
+        {
+            return true;
+        }
+        if(periodUs_ == 0)
+        {
+            periodUs_ = interval;
+            return true;
+        }
+        // regular interval is within [3/4, 3/2] of the period
+        if(4 * interval >= 3 * periodUs_ && 2 * interval <= 3 * periodUs_)
+        {
+            numDropped_ += numPendingDropped_;
+            numPendingDropped_ = 0;
+            numOutOfRange_ = 0;
+            periodUs_ = (15 * periodUs_ + interval + 8) / 16;
+            return true;
+        }
+        if(interval > periodUs_)
+        {
+            numPendingDropped_ += (interval + periodUs_ / 2) / periodUs_ - 1;
+        }
+        if(++numOutOfRange_ >= MaxOutOfRange)
+        {
+            periodUs_ = interval;
+            numPendingDropped_ = 0;
+            numOutOfRange_ = 0;
+        }
+        return true;
+    }
+
+    BufferedFile::~BufferedFile()
+    {
+        if(fd_ >= 0)
+        {
+            flush();
+            ::close(fd_);
+        }
+    }
+
+    bool BufferedFile::open(const std::string& path)
+    {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        return fd_ >= 0;
+    }
+
+    bool BufferedFile::write(std::string_view data)
+    {
+        if(size_ + data.size() > buffer_.size() && !flush())
+        {
+            return false;
+        }
+        std::memcpy(buffer_.data() + size_, data.data(), data.size());
+        size_ += data.size();
+        return true;
+    }
+
+    bool BufferedFile::flush()
+    {
+        std::size_t written = 0;
+        while(written < size_)
+        {
+            const auto numWritten = ::write(fd_, buffer_.data() + written, size_ - written);
+            if(numWritten < 0)
+            {
+                if(errno == EINTR) continue;
+                return false;
+            }
+            written += static_cast<std::size_t>(numWritten);
+        }
+        if(size_ > 0)
+        {
+            numWrites_++;
+        }
+        size_ = 0;
+        return true;
+    }
+
+    DeviceCollector::DeviceCollector(const Options& options)
+        : options_{options}
+        , epollFd_{epoll_create1(EPOLL_CLOEXEC)}
+        , timerFd_{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)}
+        , signalFd_{-1}
+        , start_{}
+        , startRealtimeUs_{}
+        , lastStats_{}
+        , stop_{false}
+        , readBuffer_{}
+    { }
+
+    DeviceCollector::~DeviceCollector()
+    {
+        for(auto& device : devices_)
+        {
+            close(*device);
+        }
+        for(const int fd : {epollFd_, timerFd_, signalFd_})
+        {
+            if(fd >= 0) ::close(fd);
+        }
+    }
+
+    bool DeviceCollector::add(const std::string& path)
+    {
+        auto device = std::make_unique<Device>();
+        device->id = devices_.size();
+        device->path = path;
+        device->name = std::filesystem::path{path}.filename().string();
+        const bool duplicate = std::any_of(devices_.begin(), devices_.end()
+                                , [&device](const auto& other) { return other->name == device->name; });
+        if(duplicate)
+        {
+            std::fprintf(stderr, "Device name %s is used twice\n", device->name.c_str());
+            return false;
+        }
+        const auto filePath = (std::filesystem::path{options_.outDir} / (device->name + ".txt")).string();
+        if(!device->file.open(filePath) || !device->file.write(RecordingHeader))
+        {
+            std::fprintf(stderr, "Can't create %s\n", filePath.c_str());
+            return false;
+        }
+        devices_.push_back(std::move(device));
+        return true;
+    }
+
+    bool DeviceCollector::open(Device& device)
+    {
+        const int fd = ::open(device.path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if(fd < 0)
+        {
+            if(!device.openFailed)
+            {
+                std::fprintf(stderr, "Can't open %s: %s, retrying\n", device.path.c_str(), std::strerror(errno));
+            }
+            device.openFailed = true;
+            return false;
+        }
+        termios tty{};
+        if(tcgetattr(fd, &tty) == 0)
+        {
+            cfmakeraw(&tty);
+            tcsetattr(fd, TCSANOW, &tty);
+        }
+        // samples queued before the open have no receive time to align them with
+        tcflush(fd, TCIFLUSH);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = device.id;
+        if(epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        if(device.stats.numBytes > 0)
+        {
+            std::fprintf(stderr, "Reopened %s\n", device.path.c_str());
+            device.stats.numReconnects++;
+        }
+        else if(device.openFailed)
+        {
+            std::fprintf(stderr, "Opened %s\n", device.path.c_str());
+        }
+        device.fd = fd;
+        device.openFailed = false;
+        device.parser.reset();
+        device.aligner.reset();
+        return true;
+    }
+
+    void DeviceCollector::close(Device& device)
+    {
+        if(device.fd < 0)
+        {
+            return;
+        }
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, device.fd, nullptr);
+        ::close(device.fd);
+        device.fd = -1;
+    }
+
+    uint64_t DeviceCollector::hostUs() const
+    {
+        using namespace std::chrono;
+        return startRealtimeUs_ + duration_cast<microseconds>(steady_clock::now() - start_).count();
+    }
+
+    void DeviceCollector::read(Device& device)
+    {
+        const auto numRead = ::read(device.fd, readBuffer_.data(), readBuffer_.size());
+        if(numRead > 0)
+        {
+            device.stats.numBytes += static_cast<uint64_t>(numRead);
+            const auto now = hostUs();
+            device.parser.feed({readBuffer_.data(), static_cast<std::size_t>(numRead)}, [&](const DeviceSample& sample) {
+                onSample(device, sample, now);
+            });
+            device.stats.numMalformed = device.parser.getNumMalformed();
+            device.stats.numRecords = device.parser.getNumRecords();
+            return;
+        }
+        if(numRead < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            return;
+        }
+        std::fprintf(stderr, "%s hung up\n", device.path.c_str());
+        close(device);
+    }
+
+    void DeviceCollector::onSample(Device& device, const DeviceSample& sample, const uint64_t hostUs)
+    {
+        auto& stats = device.stats;
+        if(!device.drops.update(sample.timestamp))
+        {
+            device.aligner.reset();
+        }
+        const auto latency = device.aligner.update(sample.timestamp, hostUs);
+        stats.numSamples++;
+        stats.numDropped = device.drops.getNumDropped();
+        stats.latencySumUs += latency;
+        stats.maxLatencyUs = std::max(stats.maxLatencyUs, latency);
+
+        std::array<char, 96> line;
+        char* ptr = line.data();
+        char* const last = line.data() + line.size();
+        ptr = appendValue(ptr, last, sample.timestamp, ',');
+        ptr = appendValue(ptr, last, device.aligner.align(sample.timestamp), ',');
+        ptr = appendValue(ptr, last, sample.raw, ',');
+        ptr = appendValue(ptr, last, sample.filtered, ',');
+        ptr = appendValue(ptr, last, sample.bpm, '\n');
+        device.file.write({line.data(), static_cast<std::size_t>(ptr - line.data())});
+    }
+
+    void DeviceCollector::onTick()
+    {
+        uint64_t numExpirations = 0;
+        [[maybe_unused]] auto numRead = ::read(timerFd_, &numExpirations, sizeof(numExpirations));
+        std::size_t numConnected = 0;
+        for(auto& device : devices_)
+        {
+            device->file.flush();
+            if(device->fd < 0)
+            {
+                open(*device);
+            }
+            numConnected += device->fd >= 0;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if(options_.duration.count() > 0 && now - start_ >= options_.duration)
+        {
+            stop_ = true;
+        }
+        if(options_.statsPeriod.count() > 0 && now - lastStats_ >= options_.statsPeriod)
+        {
+            lastStats_ = now;
+            uint64_t numSamples = 0, numDropped = 0, numMalformed = 0;
+            for(const auto& device : devices_)
+            {
+                numSamples += device->stats.numSamples;
+                numDropped += device->stats.numDropped;
+                numMalformed += device->stats.numMalformed;
+            }
+            const auto elapsed = std::chrono::duration<double>(now - start_).count();
+            std::fprintf(stderr, "%.0f s: %zu/%zu devices, %llu samples, %llu dropped, %llu malformed, CPU %.1f%%\n"
+                        , elapsed, numConnected, devices_.size(), static_cast<unsigned long long>(numSamples)
+                        , static_cast<unsigned long long>(numDropped), static_cast<unsigned long long>(numMalformed)
+                        , 100.0 * cpuSeconds() / elapsed);
+            if(options_.verbose)
+            {
+                printStats(stderr);
+            }
+        }
+    }
+
+    bool DeviceCollector::run()
+    {
+        if(epollFd_ < 0 || timerFd_ < 0)
+        {
+            std::fprintf(stderr, "Can't create epoll or timer: %s\n", std::strerror(errno));
+            return false;
+        }
+        // SIGINT and SIGTERM are handled in the loop, so the recordings are flushed
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &signals, nullptr);
+        signalFd_ = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        using namespace std::chrono;
+        const auto flushNs = duration_cast<nanoseconds>(options_.flushPeriod).count();
+        itimerspec period{};
+        period.it_interval = {static_cast<time_t>(flushNs / 1'000'000'000), static_cast<long>(flushNs % 1'000'000'000)};
+        period.it_value = period.it_interval;
+        timerfd_settime(timerFd_, 0, &period, nullptr);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = TimerId;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, timerFd_, &event);
+        event.data.u64 = SignalId;
+        if(signalFd_ >= 0) epoll_ctl(epollFd_, EPOLL_CTL_ADD, signalFd_, &event);
+
+        start_ = steady_clock::now();
+        lastStats_ = start_;
+        startRealtimeUs_ = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+        for(auto& device : devices_)
+        {
+            open(*device);
+        }
+
+        std::array<epoll_event, MaxEvents> events;
+        while(!stop_)
+        {
+            const int numEvents = epoll_wait(epollFd_, events.data(), MaxEvents, -1);
+            if(numEvents < 0)
+            {
+                if(errno == EINTR) continue;
+                std::fprintf(stderr, "epoll_wait failed: %s\n", std::strerror(errno));
+                return false;
+            }
+            for(int iEvent = 0; iEvent < numEvents; ++iEvent)
+            {
+                const auto id = events[iEvent].data.u64;
+                if(id == TimerId)
+                {
+                    onTick();
+                }
+                else if(id == SignalId)
+                {
+                    stop_ = true;
+                }
+                else if(devices_[id]->fd >= 0)
+                {
+                    // a hangup is seen by read, as end of file or an error
+                    read(*devices_[id]);
+                }
+            }
+        }
+        for(auto& device : devices_)
+        {
+            device->file.flush();
+        }
+        return true;
+    }
+
+    void DeviceCollector::printStats(std::FILE* out) const
+    {
+        std::fprintf(out, "%-16s %10s %8s %8s %9s %8s %10s %8s %10s %10s %8s\n", "device", "samples", "rate", "dropped"
+                    , "malformed", "records", "reconnects", "writes", "latency", "max", "status");
+        for(const auto& device : devices_)
+        {
+            const auto& stats = device->stats;
+            const auto periodUs = device->drops.getPeriodUs();
+            const double meanLatencyMs = stats.numSamples ? 1e-3 * stats.latencySumUs / stats.numSamples : 0.0;
+            std::fprintf(out, "%-16s %10llu %6.1fHz %8llu %9u %8u %10u %8llu %8.2fms %8.2fms %8s\n", device->name.c_str()
+                        , static_cast<unsigned long long>(stats.numSamples), periodUs ? 1e6 / periodUs : 0.0
+                        , static_cast<unsigned long long>(stats.numDropped), stats.numMalformed, stats.numRecords
+                        , stats.numReconnects, static_cast<unsigned long long>(device->file.getNumWrites())
+                        , meanLatencyMs, 1e-3 * stats.maxLatencyUs, device->fd >= 0 ? "open" : "closed");
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef _PPG_COLLECTOR_HPP
+#define _PPG_COLLECTOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "StreamParser.hpp"
+
+// Collects the streams of many devices in one thread: the ports are multiplexed with epoll,
+// every stream is parsed incrementally, its samples are aligned to the host clock and
+// written to a per-device recording (data/ CSV layout) through a buffer flushed in batches.
+namespace Collector
+{
+    // Maps device timestamps to the host clock
+    //
+    // host time - device time of a sample is the clock offset plus the transfer latency,
+    // the minimum over a window is the offset of the fastest transfer. Two windows
+    // are kept, so the estimate follows the drift of the device clock.
+    class ClockAligner
+    {
+        public:
+            explicit ClockAligner(const uint64_t windowUs = 10'000'000);
+            // returns the latency of the sample, us
+            uint64_t update(const uint64_t deviceUs, const uint64_t hostUs);
+            // device time on the host clock, valid after the first update
+            uint64_t align(const uint64_t deviceUs) const { return static_cast<uint64_t>(static_cast<int64_t>(deviceUs) + offset_); }
+            void reset();
+        private:
+            uint64_t windowUs_;
+            uint64_t windowStart_;
+            int64_t currentMin_;
+            int64_t previousMin_;
+            int64_t offset_;
+            bool valid_;
+    };
+
+    // Counts the samples missing from the device timestamps
+    //
+    // Gaps are counted once the period is confirmed by the next regular interval,
+    // MaxOutOfRange irregular intervals in a row are taken as a new sample rate (profile switch).
+    class DropCounter
+    {
+        public:
+            // returns false if the timestamp went backwards, the device restarted
+            bool update(const uint64_t deviceUs);
+            uint64_t getNumDropped() const { return numDropped_; }
+            uint64_t getPeriodUs() const { return periodUs_; }
+        private:
+            static constexpr uint32_t MaxOutOfRange = 8;
+            uint64_t lastUs_{};
+            uint64_t periodUs_{};
+            uint64_t numDropped_{};
+            uint64_t numPendingDropped_{};
+            uint32_t numOutOfRange_{};
+            bool valid_{};
+    };
+
+    // File written through a fixed buffer, one write() per flush
+    class BufferedFile
+    {
+        public:
+            static constexpr std::size_t BufferSize = 16384;
+
+            BufferedFile() = default;
+            BufferedFile(const BufferedFile&) = delete;
+            BufferedFile& operator=(const BufferedFile&) = delete;
+            ~BufferedFile();
+            bool open(const std::string& path);
+            // appends data, flushes first when it doesn't fit
+            bool write(std::string_view data);
+            bool flush();
+            uint64_t getNumWrites() const { return numWrites_; }
+        private:
+            int fd_{-1};
+            std::array<char, BufferSize> buffer_{};
+            std::size_t size_{};
+            uint64_t numWrites_{};
+    };
+
+    struct DeviceStats
+    {
+        uint64_t numSamples;
+        uint64_t numBytes;
+        uint64_t numDropped;
+        uint32_t numMalformed;
+        uint32_t numRecords;
+        uint32_t numReconnects;
+        uint64_t latencySumUs;
+        uint64_t maxLatencyUs;
+    };
+
+    class DeviceCollector
+    {
+        public:
+            struct Options
+            {
+                std::string outDir;
+                std::chrono::milliseconds flushPeriod{1000};
+                std::chrono::seconds statsPeriod{10};
+                std::chrono::seconds duration{0};       //< 0 until SIGINT/SIGTERM
+                bool verbose{false};
+            };
+
+            explicit DeviceCollector(const Options& options);
+            DeviceCollector(const DeviceCollector&) = delete;
+            DeviceCollector& operator=(const DeviceCollector&) = delete;
+            ~DeviceCollector();
+            // registers a device port, opened in run() and reopened after a hangup
+            bool add(const std::string& path);
+            bool run();
+            void printStats(std::FILE* out) const;
+        private:
+            struct Device
+            {
+                std::size_t id;            //< index in devices_, epoll event data
+                std::string path;
+                std::string name;
+                int fd{-1};
+                StreamParser parser;
+                ClockAligner aligner;
+                DropCounter drops;
+                BufferedFile file;
+                DeviceStats stats{};
+                bool openFailed{false};    //< logged once until the next successful open
+            };
+
+            bool open(Device& device);
+            void close(Device& device);
+            void read(Device& device);
+            void onSample(Device& device, const DeviceSample& sample, const uint64_t hostUs);
+            void onTick();
+            uint64_t hostUs() const;
+        private:
+            Options options_;
+            std::vector<std::unique_ptr<Device>> devices_;
+            int epollFd_;
+            int timerFd_;
+            int signalFd_;
+            std::chrono::steady_clock::time_point start_;
+            uint64_t startRealtimeUs_;
+            std::chrono::steady_clock::time_point lastStats_;
+            bool stop_;
+            std::array<char, 65536> readBuffer_;
+    };
+}
+
+#endif //_PPG_COLLECTOR_HPP
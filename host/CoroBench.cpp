@@ -0,0 +1,192 @@
+// Compares the hand-off cost of the coroutine pipeline framework (src/Coroutine.hpp)
+// with threads connected by blocking bounded queues, the k_msgq approach of the firmware
+//
+// usage: ppg_coro_bench [--items <n>]
+// for every configuration it prints ns per item passed through the whole pipeline
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Coroutine.hpp"
+
+namespace
+{
+    // bounded queue with blocking put and get, like k_msgq with K_FOREVER timeouts
+    template <typename T, std::size_t Capacity>
+    class BlockingQueue
+    {
+        public:
+            void put(const T& value)
+            {
+                std::unique_lock lock{mutex_};
+                notFull_.wait(lock, [this] { return numItems_ < Capacity; });
+                items_[(iFirst_ + numItems_) % Capacity] = value;
+                numItems_++;
+                notEmpty_.notify_one();
+            }
+
+            T get()
+            {
+                std::unique_lock lock{mutex_};
+                notEmpty_.wait(lock, [this] { return numItems_ > 0; });
+                T value = items_[iFirst_];
+                iFirst_ = (iFirst_ + 1) % Capacity;
+                numItems_--;
+                notFull_.notify_one();
+                return value;
+            }
+        private:
+            std::mutex mutex_;
+            std::condition_variable notEmpty_;
+            std::condition_variable notFull_;
+            std::array<T, Capacity> items_{};
+            std::size_t iFirst_{};
+            std::size_t numItems_{};
+    };
+
+    template <std::size_t Capacity>
+    using CoroChannel = Coro::Channel<uint32_t, Capacity>;
+
+    template <std::size_t Capacity>
+    Coro::Task produce(CoroChannel<Capacity>& out, const uint32_t numItems)
+    {
+        for(uint32_t i = 0; i < numItems; ++i)
+        {
+            co_await out.send(i);
+        }
+    }
+
+    template <std::size_t Capacity>
+    Coro::Task forward(CoroChannel<Capacity>& in, CoroChannel<Capacity>& out, const uint32_t numItems)
+    {
+        for(uint32_t i = 0; i < numItems; ++i)
+        {
+            co_await out.send(co_await in.receive() + 1);
+        }
+    }
+
+    template <std::size_t Capacity>
+    Coro::Task consume(CoroChannel<Capacity>& in, const uint32_t numItems, uint64_t& sum)
+    {
+        for(uint32_t i = 0; i < numItems; ++i)
+        {
+            sum += co_await in.receive();
+        }
+    }
+
+    struct Result
+    {
+        double nsPerItem;
+        std::size_t numSwitches; //< coroutine resumes, 0 for threads
+        uint64_t checksum;
+    };
+
+    // numStages stages in a chain: producer, numStages - 2 forwarders, consumer
+    template <std::size_t Capacity>
+    Result runCoroutines(const std::size_t numStages, const uint32_t numItems)
+    {
+        Coro::Scheduler scheduler;
+        std::vector<std::unique_ptr<CoroChannel<Capacity>>> channels;
+        for(std::size_t iChannel = 0; iChannel + 1 < numStages; ++iChannel)
+        {
+            channels.push_back(std::make_unique<CoroChannel<Capacity>>(scheduler));
+        }
+        uint64_t sum = 0;
+        std::vector<Coro::Task> tasks;
+        tasks.push_back(produce(*channels.front(), numItems));
+        for(std::size_t iStage = 1; iStage + 1 < numStages; ++iStage)
+        {
+            tasks.push_back(forward(*channels[iStage - 1], *channels[iStage], numItems));
+        }
+        tasks.push_back(consume(*channels.back(), numItems, sum));
+        for(const auto& task : tasks)
+        {
+            if(!scheduler.spawn(task))
+            {
+                std::fprintf(stderr, "Coroutine frame pool too small\n");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto numSwitches = scheduler.runUntilIdle();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return {elapsed.count() / numItems, numSwitches, sum};
+    }
+
+    template <std::size_t Capacity>
+    Result runThreads(const std::size_t numStages, const uint32_t numItems)
+    {
+        std::vector<std::unique_ptr<BlockingQueue<uint32_t, Capacity>>> queues;
+        for(std::size_t iQueue = 0; iQueue + 1 < numStages; ++iQueue)
+        {
+            queues.push_back(std::make_unique<BlockingQueue<uint32_t, Capacity>>());
+        }
+        uint64_t sum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> threads;
+            threads.emplace_back([&] {
+                for(uint32_t i = 0; i < numItems; ++i) queues.front()->put(i);
+            });
+            for(std::size_t iStage = 1; iStage + 1 < numStages; ++iStage)
+            {
+                threads.emplace_back([&, iStage] {
+                    for(uint32_t i = 0; i < numItems; ++i) queues[iStage]->put(queues[iStage - 1]->get() + 1);
+                });
+            }
+            threads.emplace_back([&] {
+                for(uint32_t i = 0; i < numItems; ++i) sum += queues.back()->get();
+            });
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return {elapsed.count() / numItems, 0, sum};
+    }
+
+    template <std::size_t Capacity>
+    void runConfiguration(const std::size_t numStages, const uint32_t numItems)
+    {
+        const auto coroutines = runCoroutines<Capacity>(numStages, numItems);
+        const auto threads = runThreads<Capacity>(numStages, numItems);
+        if(coroutines.checksum != threads.checksum)
+        {
+            std::fprintf(stderr, "Checksum mismatch\n");
+            std::exit(EXIT_FAILURE);
+        }
+        std::printf("%zu,%zu,%.1f,%.1f,%.1f\n", numStages, Capacity, coroutines.nsPerItem
+                    , coroutines.nsPerItem * numItems / coroutines.numSwitches, threads.nsPerItem);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t numItems = 1000000;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--items" && iArg + 1 < argc)
+        {
+            numItems = std::strtoul(argv[++iArg], nullptr, 10);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: ppg_coro_bench [--items <n>]\n");
+            return EXIT_FAILURE;
+        }
+    }
+    std::printf("stages,capacity,coroutine_ns_per_item,coroutine_ns_per_switch,thread_ns_per_item\n");
+    // 2 stages: plain hand-off, 4 stages: acquisition, filter, heart rate, output like the firmware pipeline
+    runConfiguration<1>(2, numItems);
+    runConfiguration<10>(2, numItems);
+    runConfiguration<1>(4, numItems);
+    runConfiguration<10>(4, numItems);
+    return EXIT_SUCCESS;
+}
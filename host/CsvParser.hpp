@@ -0,0 +1,101 @@
+#ifndef _PPG_CSV_PARSER_HPP
+#define _PPG_CSV_PARSER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "Recording.hpp"
+
+namespace Csv
+{
+    // splits a line of comma separated numbers into values, returns number of parsed fields
+    inline std::optional<std::size_t> parseLine(std::string_view line, std::span<double> values)
+    {
+        while(!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+        {
+            line.remove_suffix(1);
+        }
+        std::size_t iValue = 0;
+        const char* first = line.data();
+        const char* last = line.data() + line.size();
+        while(first < last)
+        {
+            if(iValue == values.size())
+            {
+                return {};
+            }
+            auto [ptr, ec] = std::from_chars(first, last, values[iValue]);
+            if(ec != std::errc{} || (ptr != last && *ptr != ','))
+            {
+                return {};
+            }
+            ++iValue;
+            first = ptr + 1;
+        }
+        return iValue;
+    }
+
+    inline std::optional<Recording::ColumnType> columnType(std::string_view name)
+    {
+        using Recording::ColumnType;
+        if(name == "Timestamp" || name == "TimestampSw" || name == "TimestampHw") return ColumnType::U64;
+        if(name == "TimestampAligned") return ColumnType::U64; //< device time on the host clock, us, see ppg_collect
+        if(name == "Raw") return ColumnType::U16;
+        if(name == "Filtered") return ColumnType::I16;
+        if(name == "BPM") return ColumnType::U8;
+        return {};
+    }
+
+    // schema of the device output stream, `timestampUs,raw,filtered,bpm`
+    inline Recording::Schema deviceSchema()
+    {
+        using Recording::ColumnType;
+        return {
+            {"Timestamp", ColumnType::U64},
+            {"Raw", ColumnType::U16},
+            {"Filtered", ColumnType::I16},
+            {"BPM", ColumnType::U8},
+        };
+    }
+
+    // schema from a recording header line, e.g. `TimestampSw,TimestampHw,Raw,Filtered`
+    inline std::optional<Recording::Schema> parseHeader(std::string_view line)
+    {
+        while(!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+        {
+            line.remove_suffix(1);
+        }
+        Recording::Schema schema;
+        while(!line.empty())
+        {
+            const auto comma = line.find(',');
+            const auto name = line.substr(0, comma);
+            const auto type = columnType(name);
+            if(!type.has_value())
+            {
+                return {};
+            }
+            schema.push_back({std::string{name}, type.value()});
+            line = (comma == std::string_view::npos) ? std::string_view{} : line.substr(comma + 1);
+        }
+        return schema;
+    }
+
+    // device timestamps are the reference time axis, host timestamps are only for wall-clock alignment
+    inline std::size_t timeColumn(const Recording::Schema& schema)
+    {
+        for(std::size_t iColumn = 0; iColumn < schema.size(); ++iColumn)
+        {
+            if(schema[iColumn].name == "TimestampHw" || schema[iColumn].name == "Timestamp")
+            {
+                return iColumn;
+            }
+        }
+        return 0;
+    }
+}
+
+#endif //_PPG_CSV_PARSER_HPP
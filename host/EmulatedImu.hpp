@@ -0,0 +1,93 @@
+#ifndef _PPG_EMULATED_IMU_HPP
+#define _PPG_EMULATED_IMU_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <string_view>
+
+#include "Acceleration.hpp"
+
+// Accelerometer replaying a synthetic motion trace, one sample per call to getAcceleration,
+// same interface as Hardware::Accelerometer so it can stand in for it on host
+class EmulatedImu
+{
+    public:
+        enum class Trace
+        {
+            Rest,       //< gravity and sensor noise only
+            Walking,    //< 1.8 Hz steps, inside the heart rate band
+            Running,    //< 2.7 Hz strides with larger swing
+            Random,     //< band limited random movement
+        };
+
+        static std::optional<Trace> parseTrace(std::string_view name)
+        {
+            if(name == "rest") return Trace::Rest;
+            if(name == "walking") return Trace::Walking;
+            if(name == "running") return Trace::Running;
+            if(name == "random") return Trace::Random;
+            return {};
+        }
+    public:
+        EmulatedImu(const Trace trace, const uint16_t fs, const uint32_t seed = 1)
+            : trace_{trace}
+            , fs_{fs}
+            , iSample_{}
+            , random_{seed}
+            , noise_{0.0f, 0.02f}
+            , drift_{}
+        { }
+
+        std::optional<Hardware::Acceleration> getAcceleration()
+        {
+            constexpr float g = 9.81f;
+            constexpr float twoPi = 2.0f * std::numbers::pi_v<float>;
+            const float t = static_cast<float>(iSample_++) / fs_;
+            Hardware::Acceleration acceleration{noise_(random_), noise_(random_), g + noise_(random_)};
+            switch(trace_)
+            {
+                case Trace::Rest:
+                    break;
+                case Trace::Walking:
+                case Trace::Running:
+                {
+                    const bool running = trace_ == Trace::Running;
+                    const float cadence = running ? 2.7f : 1.8f;
+                    const float swing = running ? 4.0f : 1.5f;
+                    // slowly varying intensity, so the cancellation has to keep adapting
+                    const float intensity = 1.0f + 0.3f * std::sin(twoPi * 0.02f * t);
+                    acceleration.x += intensity * swing * std::sin(twoPi * cadence * t);
+                    acceleration.y += intensity * 0.5f * swing * std::sin(twoPi * 2.0f * cadence * t + 0.7f);
+                    acceleration.z += intensity * 1.2f * swing * std::sin(twoPi * cadence * t + 1.3f);
+                    break;
+                }
+                case Trace::Random:
+                {
+                    // white noise through two one-pole lowpass filters, a few Hz bandwidth
+                    std::normal_distribution<float> step{0.0f, 1.0f};
+                    for(auto& state : drift_)
+                    {
+                        state[0] += 0.3f * (step(random_) * 6.0f - state[0]);
+                        state[1] += 0.3f * (state[0] - state[1]);
+                    }
+                    acceleration.x += drift_[0][1];
+                    acceleration.y += drift_[1][1];
+                    acceleration.z += drift_[2][1];
+                    break;
+                }
+            }
+            return acceleration;
+        }
+    private:
+        Trace trace_;
+        uint16_t fs_;
+        uint64_t iSample_;
+        std::mt19937 random_;
+        std::normal_distribution<float> noise_;
+        float drift_[3][2];
+};
+
+#endif //_PPG_EMULATED_IMU_HPP
@@ -0,0 +1,260 @@
+// Re-runs the firmware PPG filter, resampling and heart rate extraction over many recordings in parallel
+//
+// usage: ppg_batch [-j <threads>] [--out <dir>] [--coeffs b0,b1,b2,a1,a2] <recording>...
+// recordings are CSV files from data/ or *.ppgrec files
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PipelineProfile.hpp"
+#include "PpgFilter.hpp"
+#include "SampleSource.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    // high-resolution profile of Application, with the Kconfig defaults of host_autoconf.h
+    static constexpr size_t hrSamples = 100;
+    using Profile = Processor::PipelineProfile<50, hrSamples, 200, 1024>;
+
+    static constexpr std::size_t readBlockSize = 256;
+
+    struct BpmPoint
+    {
+        uint64_t timestamp;
+        uint8_t bpm;
+    };
+
+    struct Summary
+    {
+        std::size_t count;
+        double mean;
+        double median;
+        double stdDev;
+        uint8_t min;
+        uint8_t max;
+    };
+
+    struct FileResult
+    {
+        bool ok;
+        std::size_t numSamples;
+        std::vector<BpmPoint> bpm;
+        Summary summary;
+    };
+
+    Summary summarize(const std::vector<BpmPoint>& series)
+    {
+        // 0 means no estimate yet
+        std::vector<uint8_t> values;
+        for(const auto& point : series)
+        {
+            if(point.bpm) values.push_back(point.bpm);
+        }
+        Summary summary{};
+        summary.count = values.size();
+        if(values.empty())
+        {
+            return summary;
+        }
+        std::sort(values.begin(), values.end());
+        double sum = 0.0, sumSqr = 0.0;
+        for(const auto value : values)
+        {
+            sum += value;
+            sumSqr += static_cast<double>(value) * value;
+        }
+        summary.mean = sum / values.size();
+        summary.stdDev = std::sqrt(std::max(0.0, sumSqr / values.size() - summary.mean * summary.mean));
+        summary.median = values[values.size() / 2];
+        summary.min = values.front();
+        summary.max = values.back();
+        return summary;
+    }
+
+    // runs on a worker thread, every call owns its own filter and profile,
+    // the filter is applied outside the profile like in Processor::Ppg, so it can be replaced
+    FileResult analyze(const std::string& path, const std::optional<std::array<float32_t, 5>>& coeffs)
+    {
+        FileResult result{};
+        auto source = SampleSource::open(path);
+        if(!source)
+        {
+            return result;
+        }
+        auto filter = coeffs.has_value() ? Processor::PpgFilter{Dsp::IIRFilter<2>{coeffs.value()}}
+                                         : Processor::makePpgFilter<Profile::SampleRate>();
+        Profile profile{"batch"};
+        std::array<uint64_t, readBlockSize> timestamps{};
+        std::array<uint16_t, readBlockSize> raw{};
+        std::array<float32_t, readBlockSize> rawFloat{};
+        std::array<float32_t, readBlockSize> filtered{};
+        while(true)
+        {
+            const auto numRead = source->read(timestamps, raw);
+            if(numRead == 0)
+            {
+                break;
+            }
+            std::copy_n(raw.begin(), numRead, rawFloat.begin());
+            if(result.numSamples == 0)
+            {
+                filter.prime(rawFloat[0]); //< same as the firmware after reset
+            }
+            filter.process(std::span<const float32_t>{rawFloat.data(), numRead}, std::span<float32_t>{filtered.data(), numRead});
+            for(std::size_t iSample = 0; iSample < numRead; ++iSample)
+            {
+                Processor::PpgMeasurement measurement{};
+                measurement.timestamp = timestamps[iSample];
+                measurement.raw = raw[iSample];
+                measurement.filtered = filtered[iSample]; //< same truncation as the firmware
+                const auto bpm = profile.processHr(measurement); //< resampled onto the sample grid first
+                result.numSamples++;
+                if(result.numSamples % hrSamples == 0)
+                {
+                    result.bpm.push_back({measurement.timestamp, bpm});
+                }
+            }
+        }
+        result.summary = summarize(result.bpm);
+        result.ok = true;
+        return result;
+    }
+
+    bool writeSeries(const std::filesystem::path& outDir, const std::string& path, const FileResult& result)
+    {
+        const auto outPath = outDir / (std::filesystem::path{path}.stem().string() + ".bpm.csv");
+        auto* file = std::fopen(outPath.c_str(), "w");
+        if(!file)
+        {
+            return false;
+        }
+        std::fprintf(file, "Timestamp,BPM\n");
+        for(const auto& point : result.bpm)
+        {
+            std::fprintf(file, "%llu,%u\n", static_cast<unsigned long long>(point.timestamp), point.bpm);
+        }
+        return std::fclose(file) == 0;
+    }
+
+    std::optional<std::array<float32_t, 5>> parseCoeffs(std::string_view arg)
+    {
+        std::array<float32_t, 5> coeffs{};
+        std::size_t iCoeff = 0;
+        while(!arg.empty() && iCoeff < coeffs.size())
+        {
+            const auto comma = arg.find(',');
+            coeffs[iCoeff++] = std::strtof(std::string{arg.substr(0, comma)}.c_str(), nullptr);
+            arg = (comma == std::string_view::npos) ? std::string_view{} : arg.substr(comma + 1);
+        }
+        if(iCoeff != coeffs.size() || !arg.empty())
+        {
+            return {};
+        }
+        return coeffs;
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_batch [-j <threads>] [--out <dir>] [--coeffs b0,b1,b2,a1,a2] <recording>...\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t numThreads = std::thread::hardware_concurrency();
+    std::optional<std::filesystem::path> outDir;
+    std::optional<std::array<float32_t, 5>> coeffs;
+    std::vector<std::string> paths;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "-j" && iArg + 1 < argc)
+        {
+            numThreads = std::strtoul(argv[++iArg], nullptr, 10);
+        }
+        else if(arg == "--out" && iArg + 1 < argc)
+        {
+            outDir = argv[++iArg];
+        }
+        else if(arg == "--coeffs" && iArg + 1 < argc)
+        {
+            coeffs = parseCoeffs(argv[++iArg]);
+            if(!coeffs.has_value())
+            {
+                std::fprintf(stderr, "Expected 5 comma separated coefficients\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg.starts_with("-"))
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            paths.emplace_back(arg);
+        }
+    }
+    if(paths.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // one task per recording, results are written to distinct slots
+    std::vector<FileResult> results(paths.size());
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool{numThreads};
+        for(std::size_t iPath = 0; iPath < paths.size(); ++iPath)
+        {
+            pool.submit([&results, &paths, &coeffs, iPath] {
+                results[iPath] = analyze(paths[iPath], coeffs);
+            });
+        }
+        pool.wait();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::size_t totalSamples = 0;
+    std::vector<BpmPoint> allBpm;
+    bool allOk = true;
+    std::printf("file,samples,estimates,mean,median,std,min,max\n");
+    for(std::size_t iPath = 0; iPath < paths.size(); ++iPath)
+    {
+        const auto& result = results[iPath];
+        if(!result.ok)
+        {
+            std::fprintf(stderr, "Can't read %s\n", paths[iPath].c_str());
+            allOk = false;
+            continue;
+        }
+        const auto& summary = result.summary;
+        std::printf("%s,%zu,%zu,%.1f,%.1f,%.1f,%u,%u\n", paths[iPath].c_str(), result.numSamples, summary.count
+                    , summary.mean, summary.median, summary.stdDev, summary.min, summary.max);
+        totalSamples += result.numSamples;
+        allBpm.insert(allBpm.end(), result.bpm.begin(), result.bpm.end());
+        if(outDir.has_value() && !writeSeries(outDir.value(), paths[iPath], result))
+        {
+            std::fprintf(stderr, "Can't write BPM series of %s\n", paths[iPath].c_str());
+            allOk = false;
+        }
+    }
+    const auto total = summarize(allBpm);
+    std::printf("all,%zu,%zu,%.1f,%.1f,%.1f,%u,%u\n", totalSamples, total.count
+                , total.mean, total.median, total.stdDev, total.min, total.max);
+    std::fprintf(stderr, "%zu recordings, %zu samples in %.3f s on %zu threads (%.1f Msamples/s)\n"
+                , paths.size(), totalSamples, elapsed.count(), numThreads
+                , totalSamples / elapsed.count() / 1e6);
+    return allOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
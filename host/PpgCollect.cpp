@@ -0,0 +1,83 @@
+// Records the streams of many devices at once, one recording per device
+//
+// usage: ppg_collect [--out <dir>] [--flush <ms>] [--stats <s>] [--seconds <s>] [-v] <device>...
+// devices are CDC ports (/dev/ttyACMx) or PTYs of ppg_fake_devices, recordings are <dir>/<device>.txt
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "Collector.hpp"
+
+namespace
+{
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_collect [--out <dir>] [--flush <ms>] [--stats <s>] [--seconds <s>] [-v] <device>...\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Collector::DeviceCollector::Options options;
+    options.outDir = ".";
+    std::vector<std::string> devices;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--out" && iArg + 1 < argc)
+        {
+            options.outDir = argv[++iArg];
+        }
+        else if(arg == "--flush" && iArg + 1 < argc)
+        {
+            options.flushPeriod = std::chrono::milliseconds(std::max(1L, std::strtol(argv[++iArg], nullptr, 10)));
+        }
+        else if(arg == "--stats" && iArg + 1 < argc)
+        {
+            options.statsPeriod = std::chrono::seconds(std::strtol(argv[++iArg], nullptr, 10));
+        }
+        else if(arg == "--seconds" && iArg + 1 < argc)
+        {
+            options.duration = std::chrono::seconds(std::strtol(argv[++iArg], nullptr, 10));
+        }
+        else if(arg == "-v")
+        {
+            options.verbose = true;
+        }
+        else if(!arg.starts_with("-"))
+        {
+            devices.emplace_back(arg);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if(devices.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(options.outDir, error);
+
+    Collector::DeviceCollector collector{options};
+    for(const auto& device : devices)
+    {
+        if(!collector.add(device))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    std::fprintf(stderr, "Collecting from %zu devices to %s, press Ctrl+C to stop\n", devices.size(), options.outDir.c_str());
+    const bool ok = collector.run();
+    collector.printStats(stdout);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,980 @@
+// Python module `ppgdsp` with the firmware DSP classes, built with the host DSP backend
+//
+// Arrays are passed through the buffer protocol (NumPy arrays, memoryview, array.array) without copies,
+// the block methods release the GIL while they run. Outputs are written to `out` when given,
+// otherwise to a new buffer returned as memoryview (np.asarray() wraps it without a copy).
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Fft.hpp"
+#include "HrProcessor.hpp"
+#include "IIRFilter.hpp"
+#include "MovingAverageFilter.hpp"
+#include "PpgFilter.hpp"
+#include "Resampler.hpp"
+
+namespace
+{
+    // contiguous buffer of one element type, released with the view
+    class Buffer
+    {
+        public:
+            Buffer() = default;
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+            ~Buffer()
+            {
+                if(valid_) PyBuffer_Release(&view_);
+            }
+
+            // format is the struct code of the element type, e.g. 'f' for float32
+            bool get(PyObject* obj, const char format, const Py_ssize_t itemSize, const bool writable, const char* name)
+            {
+                const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+                if(PyObject_GetBuffer(obj, &view_, flags) != 0)
+                {
+                    return false;
+                }
+                valid_ = true;
+                std::string_view code{view_.format ? view_.format : "B"};
+                if(!code.empty() && (code.front() == '<' || code.front() == '=' || code.front() == '@'))
+                {
+                    code.remove_prefix(1);
+                }
+                if(code.size() != 1 || code.front() != format || view_.itemsize != itemSize)
+                {
+                    PyErr_Format(PyExc_TypeError, "%s must be a contiguous buffer of '%c', got '%s'"
+                                , name, format, view_.format ? view_.format : "B");
+                    return false;
+                }
+                return true;
+            }
+
+            template <typename T>
+            std::span<T> as() const
+            {
+                return {static_cast<T*>(view_.buf), static_cast<std::size_t>(view_.len / view_.itemsize)};
+            }
+        private:
+            Py_buffer view_{};
+            bool valid_{false};
+    };
+
+    // output buffer, the one given by the caller or a new one
+    template <typename T>
+    class Output
+    {
+        public:
+            bool get(PyObject* out, const char format, const std::size_t size)
+            {
+                if(out && out != Py_None)
+                {
+                    if(!buffer_.get(out, format, sizeof(T), true, "out"))
+                    {
+                        return false;
+                    }
+                    data_ = buffer_.as<T>();
+                    if(data_.size() != size)
+                    {
+                        PyErr_Format(PyExc_ValueError, "out has %zd elements, expected %zd", data_.size(), size);
+                        return false;
+                    }
+                    result_ = Py_NewRef(out);
+                    return true;
+                }
+                PyObject* bytes = PyByteArray_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(size * sizeof(T)));
+                if(!bytes)
+                {
+                    return false;
+                }
+                data_ = {reinterpret_cast<T*>(PyByteArray_AS_STRING(bytes)), size};
+                PyObject* view = PyMemoryView_FromObject(bytes);
+                Py_DECREF(bytes);
+                if(!view)
+                {
+                    return false;
+                }
+                const char code[2] = {format, '\0'};
+                result_ = PyObject_CallMethod(view, "cast", "s", code);
+                Py_DECREF(view);
+                return result_ != nullptr;
+            }
+
+            std::span<T> data() const { return data_; }
+            PyObject* release() { return std::exchange(result_, nullptr); }
+            ~Output() { Py_XDECREF(result_); }
+        private:
+            Buffer buffer_;
+            std::span<T> data_;
+            PyObject* result_{nullptr};
+    };
+
+    // the GIL is released in the block methods, so an object must not be used by two threads at once
+    class BusyGuard
+    {
+        public:
+            explicit BusyGuard(bool& busy)
+                : busy_{busy}
+                , acquired_{!busy}
+            {
+                if(acquired_)
+                {
+                    busy_ = true;
+                }
+                else
+                {
+                    PyErr_SetString(PyExc_RuntimeError, "object is in use by another thread");
+                }
+            }
+            ~BusyGuard()
+            {
+                if(acquired_) busy_ = false;
+            }
+            explicit operator bool() const { return acquired_; }
+        private:
+            bool& busy_;
+            bool acquired_;
+    };
+
+    template <typename F>
+    void withoutGil(F&& f)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        f();
+        Py_END_ALLOW_THREADS
+    }
+
+    template <typename ObjectT>
+    void dealloc(PyObject* self)
+    {
+        delete reinterpret_cast<ObjectT*>(self)->impl;
+        PyTypeObject* type = Py_TYPE(self);
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    template <typename ObjectT>
+    ObjectT* checkInit(PyObject* self)
+    {
+        auto* object = reinterpret_cast<ObjectT*>(self);
+        if(!object->impl)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "object is not initialized");
+            return nullptr;
+        }
+        return object;
+    }
+
+    bool parseFloats(PyObject* obj, std::span<float32_t> values, const char* name)
+    {
+        PyObject* seq = PySequence_Fast(obj, name);
+        if(!seq)
+        {
+            return false;
+        }
+        bool ok = static_cast<std::size_t>(PySequence_Fast_GET_SIZE(seq)) == values.size();
+        for(std::size_t i = 0; ok && i < values.size(); ++i)
+        {
+            values[i] = static_cast<float32_t>(PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i)));
+            ok = !PyErr_Occurred();
+        }
+        Py_DECREF(seq);
+        return ok;
+    }
+
+    // IIRFilter
+
+    template <size_t NumSections>
+    using Biquads = Dsp::IIRFilter<2 * NumSections>;
+    using IirVariant = std::variant<Biquads<1>, Biquads<2>, Biquads<3>, Biquads<4>>;
+    static constexpr size_t MaxBiquads = 4;
+
+    struct IirObject
+    {
+        PyObject_HEAD
+        IirVariant* impl;
+        bool busy;
+    };
+
+    template <size_t NumSections>
+    IirVariant* makeIir(std::span<const float32_t> coeffs)
+    {
+        std::array<float32_t, 5 * NumSections> sectionCoeffs{};
+        std::copy_n(coeffs.begin(), sectionCoeffs.size(), sectionCoeffs.begin());
+        return new IirVariant{std::in_place_type<Biquads<NumSections>>, sectionCoeffs};
+    }
+
+    int iirInit(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"coeffs", nullptr};
+        PyObject* coeffsObj = nullptr;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char**>(keywords), &coeffsObj))
+        {
+            return -1;
+        }
+        const Py_ssize_t numCoeffs = PySequence_Size(coeffsObj);
+        if(numCoeffs < 0 || numCoeffs % 5 != 0 || numCoeffs == 0 || static_cast<size_t>(numCoeffs) > 5 * MaxBiquads)
+        {
+            PyErr_Clear();
+            PyErr_Format(PyExc_ValueError, "coeffs must be 5 values {b0, b1, b2, -a1, -a2} per section, 1 to %zu sections", MaxBiquads);
+            return -1;
+        }
+        std::array<float32_t, 5 * MaxBiquads> coeffs{};
+        if(!parseFloats(coeffsObj, std::span{coeffs}.first(numCoeffs), "coeffs must be a sequence of floats"))
+        {
+            return -1;
+        }
+        auto* object = reinterpret_cast<IirObject*>(self);
+        delete std::exchange(object->impl, nullptr);
+        switch(numCoeffs / 5)
+        {
+            case 1: object->impl = makeIir<1>(coeffs); break;
+            case 2: object->impl = makeIir<2>(coeffs); break;
+            case 3: object->impl = makeIir<3>(coeffs); break;
+            default: object->impl = makeIir<4>(coeffs); break;
+        }
+        return 0;
+    }
+
+    PyObject* iirProcess(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"x", "out", nullptr};
+        PyObject* inObj = nullptr;
+        PyObject* outObj = nullptr;
+        auto* object = checkInit<IirObject>(self);
+        if(!object || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &inObj, &outObj))
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        Buffer in;
+        Output<float32_t> out;
+        if(!guard || !in.get(inObj, 'f', sizeof(float32_t), false, "x") || !out.get(outObj, 'f', in.as<float32_t>().size()))
+        {
+            return nullptr;
+        }
+        withoutGil([&] {
+            std::visit([&](auto& filter) { filter.process(in.as<const float32_t>(), out.data()); }, *object->impl);
+        });
+        return out.release();
+    }
+
+    PyObject* iirProcessSample(PyObject* self, PyObject* arg)
+    {
+        auto* object = checkInit<IirObject>(self);
+        const auto sample = static_cast<float32_t>(PyFloat_AsDouble(arg));
+        if(!object || PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        return PyFloat_FromDouble(std::visit([sample](auto& filter) { return filter.process(sample); }, *object->impl));
+    }
+
+    PyObject* iirPrime(PyObject* self, PyObject* arg)
+    {
+        auto* object = checkInit<IirObject>(self);
+        const auto sample = static_cast<float32_t>(PyFloat_AsDouble(arg));
+        if(!object || PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        return PyFloat_FromDouble(std::visit([sample](auto& filter) { return filter.prime(sample); }, *object->impl));
+    }
+
+    PyObject* iirReset(PyObject* self, PyObject*)
+    {
+        auto* object = checkInit<IirObject>(self);
+        if(!object) return nullptr;
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        std::visit([](auto& filter) { filter.reset(); }, *object->impl);
+        Py_RETURN_NONE;
+    }
+
+    PyMethodDef iirMethods[] = {
+        {"process", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(iirProcess)), METH_VARARGS | METH_KEYWORDS
+            , "process(x, out=None)\n--\n\nFilters a float32 block with the block kernel, releases the GIL"},
+        {"process_sample", iirProcessSample, METH_O, "process_sample(x)\n--\n\nFilters one sample with the per-sample path"},
+        {"prime", iirPrime, METH_O, "prime(x)\n--\n\nSets the steady state for a constant input x, returns the output"},
+        {"reset", iirReset, METH_NOARGS, "reset()\n--\n\nClears the states"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyType_Slot iirSlots[] = {
+        {Py_tp_doc, const_cast<char*>("IIRFilter(coeffs)\n--\n\nCascade of biquads, Dsp::IIRFilter; "
+                                        "coeffs has {b0, b1, b2, -a1, -a2} per section, like the firmware")},
+        {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+        {Py_tp_init, reinterpret_cast<void*>(iirInit)},
+        {Py_tp_dealloc, reinterpret_cast<void*>(dealloc<IirObject>)},
+        {Py_tp_methods, iirMethods},
+        {0, nullptr},
+    };
+
+    PyType_Spec iirSpec = {"ppgdsp.IIRFilter", sizeof(IirObject), 0, Py_TPFLAGS_DEFAULT, iirSlots};
+
+    // Fft
+
+    using FftVariant = std::variant<Dsp::Fft<256>, Dsp::Fft<512>, Dsp::Fft<1024>, Dsp::Fft<2048>>;
+
+    template <typename FftT>
+    constexpr size_t fftLengthOf = std::tuple_size_v<typename FftT::InputT>;
+
+    struct FftObject
+    {
+        PyObject_HEAD
+        FftVariant* impl;
+        bool busy;
+    };
+
+    int fftInit(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"length", nullptr};
+        int length = 0;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "i", const_cast<char**>(keywords), &length))
+        {
+            return -1;
+        }
+        auto* object = reinterpret_cast<FftObject*>(self);
+        delete std::exchange(object->impl, nullptr);
+        switch(length)
+        {
+            case 256: object->impl = new FftVariant{std::in_place_type<Dsp::Fft<256>>}; break;
+            case 512: object->impl = new FftVariant{std::in_place_type<Dsp::Fft<512>>}; break;
+            case 1024: object->impl = new FftVariant{std::in_place_type<Dsp::Fft<1024>>}; break;
+            case 2048: object->impl = new FftVariant{std::in_place_type<Dsp::Fft<2048>>}; break;
+            default:
+                PyErr_Format(PyExc_ValueError, "FFT length %d is not supported, use 256, 512, 1024 or 2048", length);
+                return -1;
+        }
+        return 0;
+    }
+
+    // runs the transform over every frame of x (length samples each), MagnitudeOnly selects the output
+    template <bool MagnitudeOnly>
+    PyObject* fftApply(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"x", "out", nullptr};
+        PyObject* inObj = nullptr;
+        PyObject* outObj = nullptr;
+        auto* object = checkInit<FftObject>(self);
+        if(!object || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &inObj, &outObj))
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        Buffer in;
+        if(!guard || !in.get(inObj, 'f', sizeof(float32_t), false, "x"))
+        {
+            return nullptr;
+        }
+        const auto input = in.as<const float32_t>();
+        const size_t length = std::visit([](const auto& fft) { return fftLengthOf<std::decay_t<decltype(fft)>>; }, *object->impl);
+        if(input.empty() || input.size() % length != 0)
+        {
+            PyErr_Format(PyExc_ValueError, "x must hold frames of %zu samples, got %zu samples", length, input.size());
+            return nullptr;
+        }
+        const size_t numFrames = input.size() / length;
+        const size_t outLength = MagnitudeOnly ? length / 2 : length;
+        Output<float32_t> out;
+        if(!out.get(outObj, 'f', numFrames * outLength))
+        {
+            return nullptr;
+        }
+        withoutGil([&] {
+            std::visit([&](auto& fft) {
+                using FftT = std::decay_t<decltype(fft)>;
+                typename FftT::InputT frame;
+                for(size_t iFrame = 0; iFrame < numFrames; ++iFrame)
+                {
+                    std::copy_n(input.begin() + iFrame * length, length, frame.begin());
+                    const auto dst = out.data().begin() + iFrame * outLength;
+                    if constexpr(MagnitudeOnly)
+                    {
+                        const auto magnitude = fft.getMagnitudeSqr(frame);
+                        std::copy(magnitude.begin(), magnitude.end(), dst);
+                    }
+                    else
+                    {
+                        const auto spectrum = fft.transform(frame);
+                        std::copy(spectrum.begin(), spectrum.end(), dst);
+                    }
+                }
+            }, *object->impl);
+        });
+        return out.release();
+    }
+
+    PyObject* fftLength(PyObject* self, void*)
+    {
+        auto* object = checkInit<FftObject>(self);
+        if(!object) return nullptr;
+        return PyLong_FromSize_t(std::visit([](const auto& fft) { return fftLengthOf<std::decay_t<decltype(fft)>>; }, *object->impl));
+    }
+
+    PyMethodDef fftMethods[] = {
+        {"transform", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(fftApply<false>)), METH_VARARGS | METH_KEYWORDS
+            , "transform(x, out=None)\n--\n\nReal FFT of every frame of x, packed like arm_rfft_fast_f32: "
+              "{X[0].re, X[N/2].re, X[1].re, X[1].im, ...}; releases the GIL"},
+        {"magnitude_sqr", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(fftApply<true>)), METH_VARARGS | METH_KEYWORDS
+            , "magnitude_sqr(x, out=None)\n--\n\nSquared magnitude of the first N/2 bins of every frame of x; releases the GIL"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyGetSetDef fftGetSet[] = {
+        {"length", fftLength, nullptr, "FFT length", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+    };
+
+    PyType_Slot fftSlots[] = {
+        {Py_tp_doc, const_cast<char*>("Fft(length)\n--\n\nReal FFT, Dsp::Fft<length>")},
+        {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+        {Py_tp_init, reinterpret_cast<void*>(fftInit)},
+        {Py_tp_dealloc, reinterpret_cast<void*>(dealloc<FftObject>)},
+        {Py_tp_methods, fftMethods},
+        {Py_tp_getset, fftGetSet},
+        {0, nullptr},
+    };
+
+    PyType_Spec fftSpec = {"ppgdsp.Fft", sizeof(FftObject), 0, Py_TPFLAGS_DEFAULT, fftSlots};
+
+    // MovingAverage
+
+    template <size_t Length>
+    using MovingAverage = Dsp::MovingAverageFilter<Length, float32_t>;
+    using MovingAverageVariant = std::variant<MovingAverage<2>, MovingAverage<4>, MovingAverage<8>, MovingAverage<16>
+                                            , MovingAverage<32>, MovingAverage<64>, MovingAverage<128>, MovingAverage<256>>;
+
+    struct MovingAverageObject
+    {
+        PyObject_HEAD
+        MovingAverageVariant* impl;
+        bool busy;
+    };
+
+    template <size_t Index = 0>
+    MovingAverageVariant* makeMovingAverage(const size_t length)
+    {
+        if constexpr(Index == std::variant_size_v<MovingAverageVariant>)
+        {
+            return nullptr;
+        }
+        else
+        {
+            using AlternativeT = std::variant_alternative_t<Index, MovingAverageVariant>;
+            if(length == (size_t{2} << Index))
+            {
+                return new MovingAverageVariant{std::in_place_type<AlternativeT>};
+            }
+            return makeMovingAverage<Index + 1>(length);
+        }
+    }
+
+    int movingAverageInit(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"length", nullptr};
+        Py_ssize_t length = 0;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "n", const_cast<char**>(keywords), &length))
+        {
+            return -1;
+        }
+        auto* object = reinterpret_cast<MovingAverageObject*>(self);
+        delete std::exchange(object->impl, nullptr);
+        object->impl = length > 0 ? makeMovingAverage(static_cast<size_t>(length)) : nullptr;
+        if(!object->impl)
+        {
+            PyErr_Format(PyExc_ValueError, "moving average length %zd is not supported, use a power of 2 from 2 to 256", length);
+            return -1;
+        }
+        return 0;
+    }
+
+    PyObject* movingAverageProcess(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"x", "out", nullptr};
+        PyObject* inObj = nullptr;
+        PyObject* outObj = nullptr;
+        auto* object = checkInit<MovingAverageObject>(self);
+        if(!object || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &inObj, &outObj))
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        Buffer in;
+        Output<float32_t> out;
+        if(!guard || !in.get(inObj, 'f', sizeof(float32_t), false, "x") || !out.get(outObj, 'f', in.as<float32_t>().size()))
+        {
+            return nullptr;
+        }
+        withoutGil([&] {
+            std::visit([&](auto& filter) {
+                const auto input = in.as<const float32_t>();
+                auto output = out.data();
+                for(size_t iSample = 0; iSample < input.size(); ++iSample)
+                {
+                    output[iSample] = filter.process(input[iSample]);
+                }
+            }, *object->impl);
+        });
+        return out.release();
+    }
+
+    PyObject* movingAverageProcessSample(PyObject* self, PyObject* arg)
+    {
+        auto* object = checkInit<MovingAverageObject>(self);
+        const auto sample = static_cast<float32_t>(PyFloat_AsDouble(arg));
+        if(!object || PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        return PyFloat_FromDouble(std::visit([sample](auto& filter) { return filter.process(sample); }, *object->impl));
+    }
+
+    PyObject* movingAveragePrime(PyObject* self, PyObject* arg)
+    {
+        auto* object = checkInit<MovingAverageObject>(self);
+        const auto sample = static_cast<float32_t>(PyFloat_AsDouble(arg));
+        if(!object || PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        return PyFloat_FromDouble(std::visit([sample](auto& filter) { return filter.prime(sample); }, *object->impl));
+    }
+
+    PyObject* movingAverageReset(PyObject* self, PyObject*)
+    {
+        auto* object = checkInit<MovingAverageObject>(self);
+        if(!object) return nullptr;
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        std::visit([](auto& filter) { filter.reset(); }, *object->impl);
+        Py_RETURN_NONE;
+    }
+
+    PyMethodDef movingAverageMethods[] = {
+        {"process", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(movingAverageProcess)), METH_VARARGS | METH_KEYWORDS
+            , "process(x, out=None)\n--\n\nAverages a float32 block, releases the GIL"},
+        {"process_sample", movingAverageProcessSample, METH_O, "process_sample(x)\n--\n\nAverages one sample"},
+        {"prime", movingAveragePrime, METH_O, "prime(x)\n--\n\nFills the window with x, returns the output"},
+        {"reset", movingAverageReset, METH_NOARGS, "reset()\n--\n\nClears the window"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyType_Slot movingAverageSlots[] = {
+        {Py_tp_doc, const_cast<char*>("MovingAverage(length)\n--\n\nMoving average of float32 samples, Dsp::MovingAverageFilter<length, float32_t>")},
+        {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+        {Py_tp_init, reinterpret_cast<void*>(movingAverageInit)},
+        {Py_tp_dealloc, reinterpret_cast<void*>(dealloc<MovingAverageObject>)},
+        {Py_tp_methods, movingAverageMethods},
+        {0, nullptr},
+    };
+
+    PyType_Spec movingAverageSpec = {"ppgdsp.MovingAverage", sizeof(MovingAverageObject), 0, Py_TPFLAGS_DEFAULT, movingAverageSlots};
+
+    // HeartRate, in the configurations of the firmware pipeline profiles,
+    // with the harmonic estimator by default like CONFIG_PPG_HR_HARMONIC_ESTIMATOR
+
+    template <size_t NumSamples, size_t NumSamplesHistory, size_t FftLength>
+    using HarmonicHeartRate = Processor::HeartRate<NumSamples, NumSamplesHistory, FftLength, Processor::HarmonicHrEstimator<FftLength>>;
+    using HeartRateVariant = std::variant<
+        HarmonicHeartRate<100, 200, 1024>, HarmonicHeartRate<50, 100, 256>
+        , Processor::HeartRate<100, 200, 1024>, Processor::HeartRate<50, 100, 256>
+    >;
+
+    struct HeartRateObject
+    {
+        PyObject_HEAD
+        HeartRateVariant* impl;
+        bool busy;
+    };
+
+    int heartRateInit(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"fs", "samples", "history", "fft_length", "estimator", nullptr};
+        int fs = 0;
+        int samples = 100, history = 200, fftLength = 1024;
+        const char* estimatorName = "harmonic";
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "i|iiis", const_cast<char**>(keywords)
+                                        , &fs, &samples, &history, &fftLength, &estimatorName))
+        {
+            return -1;
+        }
+        if(fs <= 0 || fs > UINT16_MAX)
+        {
+            PyErr_SetString(PyExc_ValueError, "fs must be in 1..65535 Hz");
+            return -1;
+        }
+        const std::string_view estimator{estimatorName};
+        if(estimator != "harmonic" && estimator != "argmax")
+        {
+            PyErr_SetString(PyExc_ValueError, "estimator must be 'harmonic' or 'argmax'");
+            return -1;
+        }
+        const bool harmonic = estimator == "harmonic";
+        auto* object = reinterpret_cast<HeartRateObject*>(self);
+        delete std::exchange(object->impl, nullptr);
+        const auto sampleRate = static_cast<uint16_t>(fs);
+        if(samples == 100 && history == 200 && fftLength == 1024)
+        {
+            object->impl = harmonic ? new HeartRateVariant{std::in_place_type<HarmonicHeartRate<100, 200, 1024>>, sampleRate}
+                                    : new HeartRateVariant{std::in_place_type<Processor::HeartRate<100, 200, 1024>>, sampleRate};
+        }
+        else if(samples == 50 && history == 100 && fftLength == 256)
+        {
+            object->impl = harmonic ? new HeartRateVariant{std::in_place_type<HarmonicHeartRate<50, 100, 256>>, sampleRate}
+                                    : new HeartRateVariant{std::in_place_type<Processor::HeartRate<50, 100, 256>>, sampleRate};
+        }
+        else
+        {
+            PyErr_SetString(PyExc_ValueError, "supported (samples, history, fft_length) are the firmware profiles "
+                                                "(100, 200, 1024) and (50, 100, 256)");
+            return -1;
+        }
+        return 0;
+    }
+
+    // one estimate per sample, filtered samples are converted to int16 like in the firmware
+    template <typename SampleT>
+    void heartRateApply(HeartRateVariant& hr, std::span<const SampleT> in, std::span<uint8_t> out)
+    {
+        std::visit([&](auto& heartRate) {
+            Processor::PpgMeasurement measurement{};
+            for(size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                measurement.filtered = in[iSample];
+                out[iSample] = heartRate.process(measurement);
+            }
+        }, hr);
+    }
+
+    PyObject* heartRateProcess(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"filtered", "out", nullptr};
+        PyObject* inObj = nullptr;
+        PyObject* outObj = nullptr;
+        auto* object = checkInit<HeartRateObject>(self);
+        if(!object || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &inObj, &outObj))
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard)
+        {
+            return nullptr;
+        }
+        // int16 like PpgMeasurement::filtered, or float32 straight from the filter
+        Buffer in;
+        const bool isFloat = !in.get(inObj, 'h', sizeof(int16_t), false, "filtered");
+        if(isFloat)
+        {
+            PyErr_Clear();
+            Buffer floatIn;
+            if(!floatIn.get(inObj, 'f', sizeof(float32_t), false, "filtered"))
+            {
+                PyErr_SetString(PyExc_TypeError, "filtered must be a contiguous buffer of int16 or float32");
+                return nullptr;
+            }
+            Output<uint8_t> out;
+            if(!out.get(outObj, 'B', floatIn.as<float32_t>().size())) return nullptr;
+            withoutGil([&] { heartRateApply(*object->impl, floatIn.as<const float32_t>(), out.data()); });
+            return out.release();
+        }
+        Output<uint8_t> out;
+        if(!out.get(outObj, 'B', in.as<int16_t>().size())) return nullptr;
+        withoutGil([&] { heartRateApply(*object->impl, in.as<const int16_t>(), out.data()); });
+        return out.release();
+    }
+
+    PyObject* heartRateProcessSample(PyObject* self, PyObject* arg)
+    {
+        auto* object = checkInit<HeartRateObject>(self);
+        const auto filtered = PyLong_AsLong(arg);
+        if(!object || PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        Processor::PpgMeasurement measurement{};
+        measurement.filtered = static_cast<int16_t>(filtered);
+        return PyLong_FromLong(std::visit([&measurement](auto& hr) { return hr.process(measurement); }, *object->impl));
+    }
+
+    PyObject* heartRateReset(PyObject* self, PyObject*)
+    {
+        auto* object = checkInit<HeartRateObject>(self);
+        if(!object) return nullptr;
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        std::visit([](auto& hr) { hr.reset(); }, *object->impl);
+        Py_RETURN_NONE;
+    }
+
+    PyObject* heartRateProvisional(PyObject* self, void*)
+    {
+        auto* object = checkInit<HeartRateObject>(self);
+        if(!object) return nullptr;
+        return PyBool_FromLong(std::visit([](const auto& hr) { return hr.isProvisional(); }, *object->impl));
+    }
+
+    PyMethodDef heartRateMethods[] = {
+        {"process", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(heartRateProcess)), METH_VARARGS | METH_KEYWORDS
+            , "process(filtered, out=None)\n--\n\nBPM after every sample of an int16 or float32 block, as uint8; releases the GIL"},
+        {"process_sample", heartRateProcessSample, METH_O, "process_sample(filtered)\n--\n\nBPM after one sample"},
+        {"reset", heartRateReset, METH_NOARGS, "reset()\n--\n\nClears the history and the estimate"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyGetSetDef heartRateGetSet[] = {
+        {"provisional", heartRateProvisional, nullptr, "estimate is based on less than the full history", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+    };
+
+    PyType_Slot heartRateSlots[] = {
+        {Py_tp_doc, const_cast<char*>("HeartRate(fs, samples=100, history=200, fft_length=1024, estimator='harmonic')\n--\n\n"
+                                        "Processor::HeartRate<samples, history, fft_length> with the HarmonicHrEstimator, "
+                                        "or the ArgmaxHrEstimator with estimator='argmax'")},
+        {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+        {Py_tp_init, reinterpret_cast<void*>(heartRateInit)},
+        {Py_tp_dealloc, reinterpret_cast<void*>(dealloc<HeartRateObject>)},
+        {Py_tp_methods, heartRateMethods},
+        {Py_tp_getset, heartRateGetSet},
+        {0, nullptr},
+    };
+
+    PyType_Spec heartRateSpec = {"ppgdsp.HeartRate", sizeof(HeartRateObject), 0, Py_TPFLAGS_DEFAULT, heartRateSlots};
+
+    // Resampler, the stage between the filter and the heart rate in the firmware pipeline profiles
+
+    using ResamplerVariant = std::variant<Dsp::Resampler<Dsp::Interpolation::Linear>, Dsp::Resampler<Dsp::Interpolation::Cubic>>;
+
+    struct ResamplerObject
+    {
+        PyObject_HEAD
+        ResamplerVariant* impl;
+        bool busy;
+    };
+
+    int resamplerInit(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"fs", "max_gap_ms", "cubic", nullptr};
+        int fs = 0;
+        int maxGapMs = 1000; //< CONFIG_PPG_RESAMPLER_MAX_GAP_MS default
+        int cubic = 0;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "i|ip", const_cast<char**>(keywords), &fs, &maxGapMs, &cubic))
+        {
+            return -1;
+        }
+        if(fs <= 0 || fs > UINT16_MAX || maxGapMs <= 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "fs must be in 1..65535 Hz and max_gap_ms positive");
+            return -1;
+        }
+        auto* object = reinterpret_cast<ResamplerObject*>(self);
+        delete std::exchange(object->impl, nullptr);
+        const auto sampleRate = static_cast<uint16_t>(fs);
+        const auto maxGap = std::chrono::milliseconds(maxGapMs);
+        if(cubic)
+        {
+            object->impl = new ResamplerVariant{std::in_place_type<Dsp::Resampler<Dsp::Interpolation::Cubic>>, sampleRate, maxGap};
+        }
+        else
+        {
+            object->impl = new ResamplerVariant{std::in_place_type<Dsp::Resampler<Dsp::Interpolation::Linear>>, sampleRate, maxGap};
+        }
+        return 0;
+    }
+
+    PyObject* resamplerProcess(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"timestamps", "filtered", nullptr};
+        PyObject* timestampsObj = nullptr;
+        PyObject* inObj = nullptr;
+        auto* object = checkInit<ResamplerObject>(self);
+        if(!object || !PyArg_ParseTupleAndKeywords(args, kwargs, "OO", const_cast<char**>(keywords), &timestampsObj, &inObj))
+        {
+            return nullptr;
+        }
+        BusyGuard guard{object->busy};
+        if(!guard)
+        {
+            return nullptr;
+        }
+        // uint64 is 'L' or 'Q' depending on the platform
+        Buffer timestampsL, timestampsQ;
+        const Buffer* timestamps = &timestampsL;
+        if(!timestampsL.get(timestampsObj, 'L', sizeof(uint64_t), false, "timestamps"))
+        {
+            PyErr_Clear();
+            if(!timestampsQ.get(timestampsObj, 'Q', sizeof(uint64_t), false, "timestamps"))
+            {
+                return nullptr;
+            }
+            timestamps = &timestampsQ;
+        }
+        Buffer in;
+        if(!in.get(inObj, 'h', sizeof(int16_t), false, "filtered"))
+        {
+            return nullptr;
+        }
+        const auto timestampsUs = timestamps->as<const uint64_t>();
+        const auto filtered = in.as<const int16_t>();
+        if(timestampsUs.size() != filtered.size())
+        {
+            PyErr_SetString(PyExc_ValueError, "timestamps and filtered must have the same length");
+            return nullptr;
+        }
+        // grid samples rounded to int16 like in Processor::PipelineProfile, the count is only known afterwards
+        std::vector<int16_t> grid;
+        withoutGil([&] {
+            grid.reserve(filtered.size() + filtered.size() / 4);
+            std::visit([&](auto& resampler) {
+                for(size_t iSample = 0; iSample < filtered.size(); ++iSample)
+                {
+                    resampler.process(timestampsUs[iSample], filtered[iSample], [&grid](const float32_t sample) {
+                        grid.push_back(static_cast<int16_t>(std::lround(sample)));
+                    });
+                }
+            }, *object->impl);
+        });
+        Output<int16_t> out;
+        if(!out.get(nullptr, 'h', grid.size())) return nullptr;
+        std::copy(grid.begin(), grid.end(), out.data().begin());
+        return out.release();
+    }
+
+    PyObject* resamplerReset(PyObject* self, PyObject*)
+    {
+        auto* object = checkInit<ResamplerObject>(self);
+        if(!object) return nullptr;
+        BusyGuard guard{object->busy};
+        if(!guard) return nullptr;
+        std::visit([](auto& resampler) { resampler.reset(); }, *object->impl);
+        Py_RETURN_NONE;
+    }
+
+    PyObject* resamplerNumFilled(PyObject* self, void*)
+    {
+        auto* object = checkInit<ResamplerObject>(self);
+        if(!object) return nullptr;
+        return PyLong_FromUnsignedLong(std::visit([](const auto& resampler) { return resampler.getNumFilled(); }, *object->impl));
+    }
+
+    PyObject* resamplerNumResyncs(PyObject* self, void*)
+    {
+        auto* object = checkInit<ResamplerObject>(self);
+        if(!object) return nullptr;
+        return PyLong_FromUnsignedLong(std::visit([](const auto& resampler) { return resampler.getNumResyncs(); }, *object->impl));
+    }
+
+    PyMethodDef resamplerMethods[] = {
+        {"process", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(resamplerProcess)), METH_VARARGS | METH_KEYWORDS
+            , "process(timestamps, filtered)\n--\n\nGrid samples of uint64 timestamps (us) and int16 filtered samples, as int16; "
+              "releases the GIL"},
+        {"reset", resamplerReset, METH_NOARGS, "reset()\n--\n\nRestarts the grid and clears the counters"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyGetSetDef resamplerGetSet[] = {
+        {"num_filled", resamplerNumFilled, nullptr, "grid samples standing in for dropped samples", nullptr},
+        {"num_resyncs", resamplerNumResyncs, nullptr, "grid restarts after long gaps or timestamps going backwards", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+    };
+
+    PyType_Slot resamplerSlots[] = {
+        {Py_tp_doc, const_cast<char*>("Resampler(fs, max_gap_ms=1000, cubic=False)\n--\n\n"
+                                        "Dsp::Resampler<Interpolation::Linear or Cubic>")},
+        {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+        {Py_tp_init, reinterpret_cast<void*>(resamplerInit)},
+        {Py_tp_dealloc, reinterpret_cast<void*>(dealloc<ResamplerObject>)},
+        {Py_tp_methods, resamplerMethods},
+        {Py_tp_getset, resamplerGetSet},
+        {0, nullptr},
+    };
+
+    PyType_Spec resamplerSpec = {"ppgdsp.Resampler", sizeof(ResamplerObject), 0, Py_TPFLAGS_DEFAULT, resamplerSlots};
+
+    // module
+
+    PyObject* ppgFilterCoeffs(PyObject*, PyObject* arg)
+    {
+        const auto fs = PyLong_AsLong(arg);
+        if(PyErr_Occurred())
+        {
+            return nullptr;
+        }
+        const Processor::PpgFilterCoeffsT* coeffs = nullptr;
+        switch(fs)
+        {
+            case 25: coeffs = &Processor::PpgFilterCoeffs<25>::value; break;
+            case 50: coeffs = &Processor::PpgFilterCoeffs<50>::value; break;
+            default:
+                PyErr_Format(PyExc_ValueError, "no PPG filter for %ld Hz, supported are 25 and 50 Hz", fs);
+                return nullptr;
+        }
+        PyObject* tuple = PyTuple_New(static_cast<Py_ssize_t>(coeffs->size()));
+        for(size_t i = 0; tuple && i < coeffs->size(); ++i)
+        {
+            PyTuple_SET_ITEM(tuple, i, PyFloat_FromDouble((*coeffs)[i]));
+        }
+        return tuple;
+    }
+
+    PyMethodDef moduleMethods[] = {
+        {"ppg_filter_coeffs", ppgFilterCoeffs, METH_O
+            , "ppg_filter_coeffs(fs)\n--\n\nCoefficients of the firmware PPG filter (Processor::PpgFilterCoeffs) for fs"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    int moduleExec(PyObject* module)
+    {
+        for(auto* spec : {&iirSpec, &fftSpec, &movingAverageSpec, &heartRateSpec, &resamplerSpec})
+        {
+            PyObject* type = PyType_FromSpec(spec);
+            const char* name = std::strrchr(spec->name, '.') + 1;
+            if(!type || PyModule_AddObject(module, name, type) != 0)
+            {
+                Py_XDECREF(type);
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    PyModuleDef_Slot moduleSlots[] = {
+        {Py_mod_exec, reinterpret_cast<void*>(moduleExec)},
+        {0, nullptr},
+    };
+
+    PyModuleDef moduleDef = {
+        PyModuleDef_HEAD_INIT, "ppgdsp", "Firmware DSP classes of the PPG pipeline, see host/PpgDspModule.cpp"
+        , 0, moduleMethods, moduleSlots, nullptr, nullptr, nullptr
+    };
+}
+
+PyMODINIT_FUNC PyInit_ppgdsp()
+{
+    return PyModuleDef_Init(&moduleDef);
+}
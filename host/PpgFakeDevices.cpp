@@ -0,0 +1,339 @@
+// Emulates devices on PTYs, each replays a recording as the `timestamp,raw,filtered,bpm` device stream
+//
+// usage: ppg_fake_devices [-n <devices>] [--dir <dir>] [--speed <x>] [--drop <p>] [--loop] <recording.txt>...
+// <dir>/devNNN link to the PTYs, to be opened by ppg_collect like CDC ports
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CsvParser.hpp"
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int)
+    {
+        stopRequested = 1;
+    }
+
+    // samples are emitted once per tick, like the device writes them per USB frame
+    static constexpr std::chrono::milliseconds tickPeriod{5};
+
+    struct Sample
+    {
+        uint64_t timestamp;
+        int32_t raw;
+        int32_t filtered;
+        int32_t bpm;
+    };
+
+    struct Replay
+    {
+        std::string path;
+        std::vector<Sample> samples;
+        uint64_t durationUs;    //< including one period, so a loop continues on the same grid
+    };
+
+    struct FakeDevice
+    {
+        int master;
+        std::filesystem::path link;
+        const Replay* replay;
+        std::size_t iSample;
+        uint64_t loopOffsetUs;  //< added to the recording timestamps after every loop
+        uint64_t bootUs;        //< device clock at the first replayed sample
+        double drift;           //< relative device clock error
+        uint64_t numWritten;
+        uint64_t numDropped;
+        uint64_t numBlocked;    //< samples lost because the PTY was full
+        std::string pending;
+    };
+
+    std::optional<Replay> loadReplay(const std::string& path)
+    {
+        std::ifstream input{path};
+        std::string line;
+        if(!input || !std::getline(input, line))
+        {
+            return {};
+        }
+        const auto schema = Csv::parseHeader(line);
+        if(!schema.has_value())
+        {
+            return {};
+        }
+        auto findColumn = [&schema](std::string_view name) -> std::optional<std::size_t> {
+            for(std::size_t iColumn = 0; iColumn < schema->size(); ++iColumn)
+            {
+                if((*schema)[iColumn].name == name) return iColumn;
+            }
+            return {};
+        };
+        const auto timeColumn = Csv::timeColumn(schema.value());
+        const auto rawColumn = findColumn("Raw");
+        const auto filteredColumn = findColumn("Filtered");
+        const auto bpmColumn = findColumn("BPM");
+        if(!rawColumn.has_value() || !filteredColumn.has_value())
+        {
+            return {};
+        }
+        Replay replay{path, {}, 0};
+        std::array<double, 8> values{};
+        while(std::getline(input, line))
+        {
+            const auto numValues = Csv::parseLine(line, values);
+            if(!numValues.has_value() || numValues.value() != schema->size())
+            {
+                continue;
+            }
+            replay.samples.push_back({static_cast<uint64_t>(values[timeColumn])
+                                    , static_cast<int32_t>(values[rawColumn.value()])
+                                    , static_cast<int32_t>(values[filteredColumn.value()])
+                                    , bpmColumn.has_value() ? static_cast<int32_t>(values[bpmColumn.value()]) : 0});
+        }
+        if(replay.samples.size() < 2)
+        {
+            return {};
+        }
+        const auto span = replay.samples.back().timestamp - replay.samples.front().timestamp;
+        replay.durationUs = span + span / (replay.samples.size() - 1);
+        return replay;
+    }
+
+    std::optional<int> openPty(std::string& slavePath)
+    {
+        const int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        {
+            if(master >= 0) close(master);
+            return {};
+        }
+        // raw, so the lines pass unchanged and nothing is echoed back
+        termios tty{};
+        tcgetattr(master, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(master, TCSANOW, &tty);
+        slavePath = ptsname(master);
+        return master;
+    }
+
+    // device timestamp of the current sample, on the device clock
+    uint64_t deviceTimestamp(const FakeDevice& device)
+    {
+        const auto& samples = device.replay->samples;
+        const auto elapsed = samples[device.iSample].timestamp - samples.front().timestamp + device.loopOffsetUs;
+        return device.bootUs + static_cast<uint64_t>(static_cast<double>(elapsed) * (1.0 + device.drift));
+    }
+
+    // replay time of the current sample, us since the start
+    uint64_t replayTime(const FakeDevice& device, const double speed)
+    {
+        const auto& samples = device.replay->samples;
+        const auto elapsed = samples[device.iSample].timestamp - samples.front().timestamp + device.loopOffsetUs;
+        return static_cast<uint64_t>(static_cast<double>(elapsed) / speed);
+    }
+
+    void appendLine(std::string& out, const uint64_t timestamp, const Sample& sample)
+    {
+        std::array<char, 64> line;
+        char* ptr = line.data();
+        char* const last = line.data() + line.size();
+        for(const int64_t value : {static_cast<int64_t>(timestamp), int64_t{sample.raw}, int64_t{sample.filtered}, int64_t{sample.bpm}})
+        {
+            ptr = std::to_chars(ptr, last, value).ptr;
+            *ptr++ = ',';
+        }
+        ptr[-1] = '\r';
+        *ptr++ = '\n';
+        out.append(line.data(), ptr);
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_fake_devices [-n <devices>] [--dir <dir>] [--speed <x>] [--drop <p>] [--loop] <recording.txt>...\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t numDevices = 1;
+    std::filesystem::path dir = "fake-devices";
+    double speed = 1.0;
+    double dropProbability = 0.0;
+    bool loop = false;
+    std::vector<std::string> paths;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "-n" && iArg + 1 < argc)
+        {
+            numDevices = std::max(1UL, std::strtoul(argv[++iArg], nullptr, 10));
+        }
+        else if(arg == "--dir" && iArg + 1 < argc)
+        {
+            dir = argv[++iArg];
+        }
+        else if(arg == "--speed" && iArg + 1 < argc)
+        {
+            speed = std::max(0.01, std::strtod(argv[++iArg], nullptr));
+        }
+        else if(arg == "--drop" && iArg + 1 < argc)
+        {
+            dropProbability = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--loop")
+        {
+            loop = true;
+        }
+        else if(!arg.starts_with("-"))
+        {
+            paths.emplace_back(arg);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if(paths.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Replay> replays;
+    for(const auto& path : paths)
+    {
+        auto replay = loadReplay(path);
+        if(!replay.has_value())
+        {
+            std::fprintf(stderr, "Can't load %s\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        replays.push_back(std::move(replay.value()));
+    }
+
+    // every device gets its own boot time, clock drift and starting point in the recording
+    std::mt19937 rng{std::random_device{}()};
+    std::uniform_int_distribution<uint64_t> bootDist{1'000'000, 600'000'000};
+    std::uniform_real_distribution<double> driftDist{-50e-6, 50e-6};
+    std::uniform_real_distribution<double> unitDist{0.0, 1.0};
+    std::filesystem::create_directories(dir);
+    std::vector<FakeDevice> devices;
+    for(std::size_t iDevice = 0; iDevice < numDevices; ++iDevice)
+    {
+        std::string slavePath;
+        const auto master = openPty(slavePath);
+        if(!master.has_value())
+        {
+            std::fprintf(stderr, "Can't open PTY %zu: %s\n", iDevice, std::strerror(errno));
+            return EXIT_FAILURE;
+        }
+        std::array<char, 32> name{};
+        std::snprintf(name.data(), name.size(), "dev%03zu", iDevice);
+        const auto link = dir / name.data();
+        std::error_code error;
+        std::filesystem::remove(link, error);
+        std::filesystem::create_symlink(slavePath, link, error);
+        const auto& replay = replays[iDevice % replays.size()];
+        devices.push_back({master.value(), link, &replay
+                        , static_cast<std::size_t>(unitDist(rng) * replay.samples.size() / 2), 0
+                        , bootDist(rng), driftDist(rng), 0, 0, 0, {}});
+        std::printf("%s -> %s\n", link.c_str(), slavePath.c_str());
+    }
+    std::fflush(stdout);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    using namespace std::chrono;
+    timespec next{};
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    const auto start = steady_clock::now();
+    // every device starts with its first replayed sample
+    std::vector<uint64_t> startOffsets;
+    for(const auto& device : devices)
+    {
+        startOffsets.push_back(replayTime(device, speed));
+    }
+    std::size_t numActive = devices.size();
+    while(!stopRequested && numActive > 0)
+    {
+        next.tv_nsec += duration_cast<nanoseconds>(tickPeriod).count();
+        if(next.tv_nsec >= 1'000'000'000)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1'000'000'000;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        const auto now = static_cast<uint64_t>(duration_cast<microseconds>(steady_clock::now() - start).count());
+        numActive = 0;
+        for(std::size_t iDevice = 0; iDevice < devices.size(); ++iDevice)
+        {
+            auto& device = devices[iDevice];
+            const auto& samples = device.replay->samples;
+            device.pending.clear();
+            while(device.iSample < samples.size() && replayTime(device, speed) - startOffsets[iDevice] <= now)
+            {
+                if(unitDist(rng) >= dropProbability)
+                {
+                    appendLine(device.pending, deviceTimestamp(device), samples[device.iSample]);
+                    device.numWritten++;
+                }
+                else
+                {
+                    device.numDropped++;
+                }
+                if(++device.iSample == samples.size() && loop)
+                {
+                    device.iSample = 0;
+                    device.loopOffsetUs += device.replay->durationUs;
+                }
+            }
+            if(!device.pending.empty())
+            {
+                // a full PTY loses the samples, like the device does when the host doesn't read
+                const auto numWritten = write(device.master, device.pending.data(), device.pending.size());
+                if(numWritten < static_cast<ssize_t>(device.pending.size()))
+                {
+                    device.numBlocked++;
+                }
+            }
+            numActive += device.iSample < samples.size();
+        }
+    }
+
+    uint64_t numWritten = 0, numDropped = 0, numBlocked = 0;
+    for(auto& device : devices)
+    {
+        numWritten += device.numWritten;
+        numDropped += device.numDropped;
+        numBlocked += device.numBlocked;
+        close(device.master);
+        std::error_code error;
+        std::filesystem::remove(device.link, error);
+    }
+    std::fprintf(stderr, "%zu devices: %llu samples written, %llu dropped on purpose, %llu writes blocked by full PTYs\n"
+                , devices.size(), static_cast<unsigned long long>(numWritten)
+                , static_cast<unsigned long long>(numDropped), static_cast<unsigned long long>(numBlocked));
+    return EXIT_SUCCESS;
+}
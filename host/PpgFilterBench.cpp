@@ -0,0 +1,178 @@
+// Times the filter paths of BenchmarkDSP with the host DSP backend: the IIR filter sample-by-sample through IFilter
+// (benchmark 2), the whole signal in one call (benchmark 3), blocks of CONFIG_PPG_FILTER_BLOCK_SIZE (benchmark 4)
+// and inline per sample (benchmark 13), and IIR + moving average through IFilter (benchmark 5) and FilterChain (benchmark 6)
+//
+// usage: ppg_filter_bench [--repeat <n>] [--block <samples>]
+// prints the best ns per sample of 5 rounds, each filtering the 1024 sample test signal <n> times
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <string_view>
+
+#include "FilterChain.hpp"
+#include "IFilter.hpp"
+#include "IIRFilter.hpp"
+#include "MovingAverageFilter.hpp"
+
+namespace
+{
+    static constexpr std::size_t NumSamples = 1024;
+    static constexpr std::size_t NumRounds = 5;
+    using SignalT = std::array<float32_t, NumSamples>;
+
+    // sig.butter(1, [3, 12], btype='bandpass', fs=fs, output='sos'), same filter as BenchmarkDSP
+    static constexpr std::array<float32_t, 5> Coeffs{ 0.38823676f, 0.0f, -0.38823676f, 0.8517672f, -0.22352648f };
+
+    // 5 and 10 Hz tones at 100 Hz sampling, the shape of the BenchmarkDSP input
+    SignalT makeSignal()
+    {
+        SignalT signal{};
+        for(std::size_t iSample = 0; iSample < NumSamples; ++iSample)
+        {
+            const double t = iSample / 100.0;
+            signal[iSample] = static_cast<float32_t>(200.0 * std::sin(2.0 * std::numbers::pi * 5.0 * t)
+                                                    + 200.0 * std::sin(2.0 * std::numbers::pi * 10.0 * t));
+        }
+        return signal;
+    }
+
+    struct Result
+    {
+        double nsPerSample;
+        double checksum;    //< keeps the filtering from being optimized away
+    };
+
+    template <typename FilterFunc>
+    Result time(const SignalT& input, const std::size_t numRepeats, FilterFunc filterSignal)
+    {
+        SignalT output{};
+        Result result{std::numeric_limits<double>::max(), 0.0};
+        for(std::size_t iRound = 0; iRound < NumRounds; ++iRound)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for(std::size_t iRepeat = 0; iRepeat < numRepeats; ++iRepeat)
+            {
+                filterSignal(input, output);
+                result.checksum += output[iRepeat % NumSamples];
+            }
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            result.nsPerSample = std::min(result.nsPerSample, elapsed.count() / (numRepeats * NumSamples));
+        }
+        return result;
+    }
+
+    // hides the dynamic type of a filter from the optimizer, so calls through IFilter stay virtual calls
+    // like with a stage chosen at runtime, the compiler would devirtualize a reference bound to a local filter
+    template <typename FilterT>
+    Dsp::IFilter<float32_t>& opaque(FilterT& filter)
+    {
+        Dsp::IFilter<float32_t>* base = &filter;
+        asm volatile("" : "+r"(base));
+        return *base;
+    }
+
+    void print(const char* const name, const Result& result)
+    {
+        std::printf("%s,%.2f,%g\n", name, result.nsPerSample, result.checksum);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t numRepeats = 2000;
+    std::size_t blockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--repeat" && iArg + 1 < argc)
+        {
+            numRepeats = std::strtoul(argv[++iArg], nullptr, 10);
+        }
+        else if(arg == "--block" && iArg + 1 < argc)
+        {
+            blockSize = std::strtoul(argv[++iArg], nullptr, 10);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: ppg_filter_bench [--repeat <n>] [--block <samples>]\n");
+            return 1;
+        }
+    }
+    if(numRepeats == 0 || blockSize == 0)
+    {
+        std::fprintf(stderr, "--repeat and --block must be positive\n");
+        return 1;
+    }
+
+    const auto input = makeSignal();
+    std::printf("path,ns_per_sample,checksum\n");
+    {
+        Dsp::IIRFilter<2> filter{Coeffs};
+        print("sample_by_sample", time(input, numRepeats, [&filter](const SignalT& in, SignalT& out) {
+            for(std::size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                out[iSample] = filter(in[iSample]);
+            }
+        }));
+    }
+    {
+        Dsp::IIRFilter<2> filter{Coeffs};
+        print("whole_signal", time(input, numRepeats, [&filter](const SignalT& in, SignalT& out) {
+            filter.apply(in, out);
+        }));
+    }
+    {
+        Dsp::IIRFilter<2> filter{Coeffs};
+        char name[32];
+        std::snprintf(name, sizeof(name), "blocks_of_%zu", blockSize);
+        print(name, time(input, numRepeats, [&filter, blockSize](const SignalT& in, SignalT& out) {
+            for(std::size_t iSample = 0; iSample < in.size(); iSample += blockSize)
+            {
+                const auto numBlock = std::min(blockSize, in.size() - iSample);
+                std::span<float32_t> outBlock{out.data() + iSample, numBlock};
+                filter.apply(std::span<const float32_t>{in.data() + iSample, numBlock}, outBlock);
+            }
+        }));
+    }
+    {
+        Dsp::IIRFilter<2> filter{Coeffs};
+        print("sample_by_sample_inline", time(input, numRepeats, [&filter](const SignalT& in, SignalT& out) {
+            for(std::size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                out[iSample] = filter.process(in[iSample]);
+            }
+        }));
+    }
+    {
+        Dsp::IIRFilter<2> iir{Coeffs};
+        Dsp::MovingAverageFilter<4, float32_t> movingAverage;
+        Dsp::IFilter<float32_t>& stage1 = opaque(iir);
+        Dsp::IFilter<float32_t>& stage2 = opaque(movingAverage);
+        print("chain_virtual", time(input, numRepeats, [&stage1, &stage2](const SignalT& in, SignalT& out) {
+            for(std::size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                out[iSample] = stage2(stage1(in[iSample]));
+            }
+        }));
+    }
+    {
+        Dsp::FilterChain<Dsp::IIRFilter<2>, Dsp::MovingAverageFilter<4, float32_t>> chain{
+            Dsp::IIRFilter<2>{Coeffs}
+            , Dsp::MovingAverageFilter<4, float32_t>{}
+        };
+        print("chain_compile_time", time(input, numRepeats, [&chain](const SignalT& in, SignalT& out) {
+            for(std::size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                out[iSample] = chain(in[iSample]);
+            }
+        }));
+    }
+    return 0;
+}
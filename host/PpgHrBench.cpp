@@ -0,0 +1,297 @@
+// Compares the heart rate estimators of the analysis frames (src/HrEstimator.hpp), on recordings against
+// a time-domain beat interval reference, and on synthetic pulses with a known rate and strong harmonics
+//
+// usage: ppg_hr_bench [--synthetic <frames>] [--repeat <n>] <recording>...
+// the instruction counts on the target are measured by the icount app (hr_frame and hr_frame_harmonic kernels)
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Fft.hpp"
+#include "HrEstimator.hpp"
+#include "PpgFilter.hpp"
+#include "SampleSource.hpp"
+
+namespace
+{
+    // same configuration as the high resolution profile
+    static constexpr uint16_t sampleRate = 50; //< Hz
+    static constexpr size_t hrSamples = 100;
+    static constexpr size_t hrSamplesHistory = 200;
+    static constexpr size_t fftLength = 1024;
+    using Fft = Dsp::Fft<fftLength>;
+
+    static constexpr std::size_t readBlockSize = 256;
+
+    struct Frame
+    {
+        Fft::MagnitudeT power;
+        float reference;    //< BPM
+    };
+
+    struct Errors
+    {
+        std::size_t numFrames;
+        double sumAbsError;
+        std::size_t numLarge;   //< more than 10 BPM off
+        std::size_t numDoubled;
+        std::size_t numHalved;
+    };
+
+    // filtered samples like the firmware, truncated to int16
+    std::optional<std::vector<float32_t>> loadFiltered(const std::string& path)
+    {
+        auto source = SampleSource::open(path);
+        if(!source)
+        {
+            return {};
+        }
+        auto filter = Processor::makePpgFilter();
+        std::vector<float32_t> filtered;
+        std::array<uint64_t, readBlockSize> timestamps{};
+        std::array<uint16_t, readBlockSize> raw{};
+        std::array<float32_t, readBlockSize> rawFloat{};
+        std::array<float32_t, readBlockSize> block{};
+        while(const auto numRead = source->read(timestamps, raw))
+        {
+            std::copy_n(raw.begin(), numRead, rawFloat.begin());
+            if(filtered.empty())
+            {
+                filter.prime(rawFloat[0]);
+            }
+            filter.process(std::span<const float32_t>{rawFloat.data(), numRead}, std::span<float32_t>{block.data(), numRead});
+            for(std::size_t iSample = 0; iSample < numRead; ++iSample)
+            {
+                filtered.push_back(static_cast<int16_t>(block[iSample]));
+            }
+        }
+        return filtered;
+    }
+
+    // rate from the median interval of the pulse maxima, independent of the spectrum,
+    // maxima closer than the refractory time are merged, needs at least 3 beats
+    std::optional<float> beatIntervalBpm(std::span<const float32_t> window)
+    {
+        static constexpr float refractorySeconds = 0.33f;
+        double sumSqr = 0.0;
+        for(const auto sample : window)
+        {
+            sumSqr += static_cast<double>(sample) * sample;
+        }
+        const auto threshold = 0.3 * std::sqrt(sumSqr / window.size());
+        std::vector<std::size_t> beats;
+        for(std::size_t iSample = 1; iSample + 1 < window.size(); ++iSample)
+        {
+            const auto sample = window[iSample];
+            if(sample < threshold || sample < window[iSample - 1] || sample <= window[iSample + 1])
+            {
+                continue;
+            }
+            if(!beats.empty() && iSample - beats.back() < refractorySeconds * sampleRate)
+            {
+                if(sample > window[beats.back()]) beats.back() = iSample;
+                continue;
+            }
+            beats.push_back(iSample);
+        }
+        if(beats.size() < 3)
+        {
+            return {};
+        }
+        std::vector<std::size_t> intervals;
+        for(std::size_t iBeat = 1; iBeat < beats.size(); ++iBeat)
+        {
+            intervals.push_back(beats[iBeat] - beats[iBeat - 1]);
+        }
+        std::nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+        return 60.0f * sampleRate / intervals[intervals.size() / 2];
+    }
+
+    // the frames HeartRate analyzes once its history is full: the last history samples, zero padded
+    Fft::MagnitudeT framePower(Fft& fft, std::span<const float32_t> history)
+    {
+        Fft::InputT samples{};
+        std::copy(history.begin(), history.end(), samples.begin());
+        return fft.getMagnitudeSqr(samples);
+    }
+
+    void addRecordingFrames(Fft& fft, const std::vector<float32_t>& filtered, std::vector<Frame>& frames)
+    {
+        for(std::size_t end = hrSamplesHistory; end <= filtered.size(); end += hrSamples)
+        {
+            const std::span<const float32_t> history{filtered.data() + end - hrSamplesHistory, hrSamplesHistory};
+            const auto reference = beatIntervalBpm(history);
+            if(reference.has_value())
+            {
+                frames.push_back({framePower(fft, history), reference.value()});
+            }
+        }
+    }
+
+    // pulses at a random rate, with a second harmonic up to twice as strong as the fundamental, and noise
+    void addSyntheticFrames(Fft& fft, const std::size_t numFrames, std::vector<Frame>& frames)
+    {
+        std::mt19937 rng{1};
+        std::uniform_real_distribution<float> bpmDist{45.0f, 150.0f};
+        std::uniform_real_distribution<float> harmonicDist{0.3f, 2.0f};
+        std::uniform_real_distribution<float> phaseDist{0.0f, 2.0f * std::numbers::pi_v<float>};
+        std::normal_distribution<float> noiseDist{0.0f, 60.0f};
+        std::array<float32_t, hrSamplesHistory> history{};
+        for(std::size_t iFrame = 0; iFrame < numFrames; ++iFrame)
+        {
+            const auto bpm = bpmDist(rng);
+            const auto harmonic = harmonicDist(rng);
+            const auto phase = phaseDist(rng);
+            const auto w = 2.0f * std::numbers::pi_v<float> * bpm / 60.0f / sampleRate;
+            for(std::size_t iSample = 0; iSample < history.size(); ++iSample)
+            {
+                const auto sample = 300.0f * (std::sin(w * iSample) + harmonic * std::sin(2.0f * w * iSample + phase)
+                                            + 0.3f * std::sin(3.0f * w * iSample + 2.0f * phase)) + noiseDist(rng);
+                history[iSample] = static_cast<int16_t>(sample);
+            }
+            frames.push_back({framePower(fft, history), bpm});
+        }
+    }
+
+    template <typename EstimatorT>
+    Errors evaluate(EstimatorT& estimator, const std::vector<Frame>& frames)
+    {
+        Errors errors{};
+        for(const auto& frame : frames)
+        {
+            const float bpm = estimator.estimate(frame.power, sampleRate);
+            const float error = std::abs(bpm - frame.reference);
+            errors.numFrames++;
+            errors.sumAbsError += error;
+            errors.numLarge += error > 10.0f;
+            errors.numDoubled += std::abs(bpm / frame.reference - 2.0f) < 0.2f;
+            errors.numHalved += std::abs(bpm / frame.reference - 0.5f) < 0.05f;
+        }
+        return errors;
+    }
+
+    // ns per frame
+    template <typename F>
+    double timePerFrame(const std::vector<Frame>& frames, const std::size_t numRepeats, F&& f)
+    {
+        using namespace std::chrono;
+        unsigned checksum = 0; //< keeps the results alive
+        const auto start = steady_clock::now();
+        for(std::size_t iRepeat = 0; iRepeat < numRepeats; ++iRepeat)
+        {
+            for(const auto& frame : frames)
+            {
+                checksum += f(frame);
+            }
+        }
+        const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+        if(checksum == 1) std::fprintf(stderr, " ");
+        return static_cast<double>(elapsed) / (numRepeats * frames.size());
+    }
+
+    void printErrors(const char* const name, const Errors& errors)
+    {
+        const auto percent = [&errors](const std::size_t count) { return 100.0 * count / std::max<std::size_t>(errors.numFrames, 1); };
+        std::printf("  %-10s %8.2f %9.1f%% %9.1f%% %9.1f%%\n", name, errors.sumAbsError / std::max<std::size_t>(errors.numFrames, 1)
+                    , percent(errors.numLarge), percent(errors.numDoubled), percent(errors.numHalved));
+    }
+
+    void printComparison(const char* const title, const std::vector<Frame>& frames)
+    {
+        Processor::ArgmaxHrEstimator<fftLength> argmax;
+        Processor::HarmonicHrEstimator<fftLength> harmonic;
+        std::printf("%s: %zu frames\n", title, frames.size());
+        std::printf("  %-10s %8s %10s %10s %10s\n", "estimator", "MAE BPM", ">10 BPM", "doubled", "halved");
+        printErrors("argmax", evaluate(argmax, frames));
+        printErrors("harmonic", evaluate(harmonic, frames));
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_hr_bench [--synthetic <frames>] [--repeat <n>] <recording>...\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t numSyntheticFrames = 1000;
+    std::size_t numRepeats = 20;
+    std::vector<std::string> paths;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--synthetic" && iArg + 1 < argc)
+        {
+            numSyntheticFrames = std::strtoul(argv[++iArg], nullptr, 10);
+        }
+        else if(arg == "--repeat" && iArg + 1 < argc)
+        {
+            numRepeats = std::max(1UL, std::strtoul(argv[++iArg], nullptr, 10));
+        }
+        else if(!arg.starts_with("-"))
+        {
+            paths.emplace_back(arg);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    Fft fft;
+    std::vector<Frame> recordingFrames;
+    for(const auto& path : paths)
+    {
+        const auto filtered = loadFiltered(path);
+        if(!filtered.has_value())
+        {
+            std::fprintf(stderr, "Can't read %s\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        addRecordingFrames(fft, filtered.value(), recordingFrames);
+    }
+    std::vector<Frame> syntheticFrames;
+    addSyntheticFrames(fft, numSyntheticFrames, syntheticFrames);
+
+    if(!recordingFrames.empty())
+    {
+        printComparison("recordings, against the beat interval", recordingFrames);
+    }
+    if(!syntheticFrames.empty())
+    {
+        printComparison("synthetic, 2nd harmonic 0.3-2x the fundamental", syntheticFrames);
+    }
+
+    // time per frame over every frame, the FFT of the frame is shared by both estimators
+    auto& frames = syntheticFrames.empty() ? recordingFrames : syntheticFrames;
+    if(frames.empty())
+    {
+        return EXIT_SUCCESS;
+    }
+    Processor::ArgmaxHrEstimator<fftLength> argmax;
+    Processor::HarmonicHrEstimator<fftLength> harmonic;
+    Fft::InputT samples{};
+    const auto fftNs = timePerFrame(frames, numRepeats, [&fft, &samples](const Frame& frame) {
+        samples[0] = frame.reference;
+        return static_cast<unsigned>(fft.getMagnitudeSqr(samples)[1] > 0.0f);
+    });
+    const auto argmaxNs = timePerFrame(frames, numRepeats, [&argmax](const Frame& frame) {
+        return static_cast<unsigned>(argmax.estimate(frame.power, sampleRate));
+    });
+    const auto harmonicNs = timePerFrame(frames, numRepeats, [&harmonic](const Frame& frame) {
+        return static_cast<unsigned>(harmonic.estimate(frame.power, sampleRate));
+    });
+    std::printf("time per frame: frame FFT %.0f ns, argmax %.0f ns, harmonic %.0f ns\n", fftNs, argmaxNs, harmonicNs);
+    return EXIT_SUCCESS;
+}
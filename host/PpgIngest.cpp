@@ -0,0 +1,195 @@
+// Converts a CSV recording, or the live CDC stream of a device, to the columnar *.ppgrec format
+//
+// usage: ppg_ingest [--fs <Hz>] [--chunk <samples>] <input.txt | /dev/ttyACMx> <output.ppgrec>
+//        ppg_ingest --info <file.ppgrec>
+
+#include <array>
+#include <csignal>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "CsvParser.hpp"
+#include "Recording.hpp"
+#include "StreamParser.hpp"
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int)
+    {
+        stopRequested = 1;
+    }
+
+    bool ingestFile(const std::string& path, std::optional<Recording::Writer>& writer, const uint32_t chunkSamples)
+    {
+        std::ifstream input{path};
+        if(!input)
+        {
+            std::fprintf(stderr, "Can't open %s\n", path.c_str());
+            return false;
+        }
+        std::string line;
+        if(!std::getline(input, line))
+        {
+            std::fprintf(stderr, "%s is empty\n", path.c_str());
+            return false;
+        }
+        auto schema = Csv::parseHeader(line);
+        if(!schema.has_value())
+        {
+            std::fprintf(stderr, "Unknown header in %s: %s\n", path.c_str(), line.c_str());
+            return false;
+        }
+        writer.emplace(schema.value(), Csv::timeColumn(schema.value()), chunkSamples);
+        std::array<double, 8> values{};
+        std::size_t lineNumber = 1;
+        while(std::getline(input, line))
+        {
+            ++lineNumber;
+            const auto numValues = Csv::parseLine(line, values);
+            if(!numValues.has_value() || numValues.value() != schema->size())
+            {
+                std::fprintf(stderr, "Skipping malformed line %zu\n", lineNumber);
+                continue;
+            }
+            writer->append({values.data(), numValues.value()});
+        }
+        return true;
+    }
+
+    bool ingestStream(const std::string& path, std::optional<Recording::Writer>& writer, const uint32_t chunkSamples)
+    {
+        const int fd = open(path.c_str(), O_RDONLY | O_NOCTTY);
+        if(fd < 0)
+        {
+            std::fprintf(stderr, "Can't open %s\n", path.c_str());
+            return false;
+        }
+        termios tty{};
+        if(tcgetattr(fd, &tty) == 0)
+        {
+            cfmakeraw(&tty);
+            tcsetattr(fd, TCSANOW, &tty);
+        }
+        const auto schema = Csv::deviceSchema();
+        writer.emplace(schema, Csv::timeColumn(schema), chunkSamples);
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::fprintf(stderr, "Recording from %s, press Ctrl+C to stop\n", path.c_str());
+
+        std::array<char, 4096> buf{};
+        // spectrum, profile and trace records between the lines are skipped, the first line may be cut
+        Collector::StreamParser parser;
+        while(!stopRequested)
+        {
+            const auto numRead = read(fd, buf.data(), buf.size());
+            if(numRead <= 0)
+            {
+                break;
+            }
+            parser.feed(std::span{buf}.first(numRead), [&writer](const Collector::DeviceSample& sample) {
+                const std::array<double, 4> values{static_cast<double>(sample.timestamp), static_cast<double>(sample.raw)
+                                                , static_cast<double>(sample.filtered), static_cast<double>(sample.bpm)};
+                writer->append(values);
+            });
+        }
+        close(fd);
+        return true;
+    }
+
+    int printInfo(const std::string& path)
+    {
+        const auto reader = Recording::Reader::open(path);
+        if(!reader.has_value())
+        {
+            std::fprintf(stderr, "%s is not a valid recording\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        const auto& header = reader->header();
+        std::printf("version: %u\n", header.version);
+        std::printf("samples: %llu\n", static_cast<unsigned long long>(header.numSamples));
+        std::printf("sample rate: %.1f Hz\n", header.sampleRate);
+        std::printf("chunks: %llu x %u samples\n", static_cast<unsigned long long>(header.numChunks), header.chunkSamples);
+        for(std::size_t iColumn = 0; iColumn < reader->columns().size(); ++iColumn)
+        {
+            const auto& column = reader->columns()[iColumn];
+            std::printf("column %zu: %s, %u bytes%s\n", iColumn, column.name.data(), column.width
+                        , iColumn == header.timeColumn ? " (time)" : "");
+        }
+        return EXIT_SUCCESS;
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_ingest [--fs <Hz>] [--chunk <samples>] <input.txt | /dev/ttyACMx> <output.ppgrec>\n");
+        std::fprintf(stderr, "       ppg_ingest --info <file.ppgrec>\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::optional<float> sampleRate;
+    uint32_t chunkSamples = 4096;
+    std::string input, output;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--info" && iArg + 1 < argc)
+        {
+            return printInfo(argv[iArg + 1]);
+        }
+        else if(arg == "--fs" && iArg + 1 < argc)
+        {
+            sampleRate = std::strtof(argv[++iArg], nullptr);
+        }
+        else if(arg == "--chunk" && iArg + 1 < argc)
+        {
+            chunkSamples = static_cast<uint32_t>(std::strtoul(argv[++iArg], nullptr, 10));
+        }
+        else if(input.empty())
+        {
+            input = arg;
+        }
+        else if(output.empty())
+        {
+            output = arg;
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if(input.empty() || output.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::optional<Recording::Writer> writer;
+    const bool isStream = input.starts_with("/dev/");
+    const bool ingested = isStream ? ingestStream(input, writer, chunkSamples)
+                                   : ingestFile(input, writer, chunkSamples);
+    if(!ingested)
+    {
+        return EXIT_FAILURE;
+    }
+    if(!writer->write(output, sampleRate))
+    {
+        std::fprintf(stderr, "Can't write %s\n", output.c_str());
+        return EXIT_FAILURE;
+    }
+    std::fprintf(stderr, "Wrote %zu samples to %s\n", writer->size(), output.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+// Evaluates the accelerometer referenced motion artifact cancellation on synthetic recordings
+//
+// usage: ppg_motion [--trace rest|walking|running|random] [--seconds <s>] [--bpm <bpm>] [--mu <step size>]
+// a PPG signal at the given heart rate is corrupted by an artifact linearly coupled to an emulated IMU trace,
+// then the firmware pipeline runs with and without the cancellation stage
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "EmulatedImu.hpp"
+#include "MotionCanceller.hpp"
+#include "PipelineProfile.hpp"
+#include "PpgFilter.hpp"
+
+namespace
+{
+    // high resolution profile, with the Kconfig defaults of host_autoconf.h
+    static constexpr size_t hrSamples = 100;
+    using Profile = Processor::PipelineProfile<50, hrSamples, 200, 1024>;
+    static constexpr uint16_t sampleRate = Profile::SampleRate; //< Hz
+    static constexpr size_t blockSize = 5;
+    static constexpr size_t numTaps = 16;
+    using MotionCanceller = Processor::MotionCanceller<numTaps, blockSize>;
+
+    static constexpr double warmUpSeconds = 20.0; //< estimates before are not scored
+
+    struct Score
+    {
+        double medianError;
+        double within5; //< fraction of estimates within 5 BPM
+    };
+
+    Score score(std::vector<double> errors)
+    {
+        if(errors.empty())
+        {
+            return {};
+        }
+        std::sort(errors.begin(), errors.end());
+        const auto numWithin5 = std::count_if(errors.begin(), errors.end(), [](double e) { return e <= 5.0; });
+        return {errors[errors.size() / 2], static_cast<double>(numWithin5) / errors.size()};
+    }
+
+    void evaluate(const EmulatedImu::Trace trace, const std::string_view name, const double seconds, const double bpm
+                , const float32_t mu)
+    {
+        constexpr double twoPi = 2.0 * std::numbers::pi;
+        const size_t numSamples = static_cast<size_t>(seconds * sampleRate);
+        EmulatedImu imu{trace, sampleRate};
+        // artifact coupling from every axis, with different delays
+        static constexpr std::array<float, 3> couplingGain{25.0f, 8.0f, 15.0f};
+        std::array<Hardware::Acceleration, 3> history{};
+
+        // the filter runs outside the profile, like in Processor::Ppg
+        auto filter = Processor::makePpgFilter<sampleRate>();
+        auto filterCancelled = Processor::makePpgFilter<sampleRate>();
+        MotionCanceller canceller{mu};
+        Profile profile{"plain"};
+        Profile profileCancelled{"cancelled"};
+
+        std::array<float32_t, blockSize> raw{};
+        std::array<float32_t, blockSize> filtered{};
+        std::array<float32_t, blockSize> cleaned{};
+        std::array<Hardware::Acceleration, blockSize> motion{};
+        std::vector<double> errors, errorsCancelled;
+        std::chrono::nanoseconds cancellerTime{};
+
+        for(size_t iSample = 0; iSample < numSamples; ++iSample)
+        {
+            const double t = static_cast<double>(iSample) / sampleRate;
+            const auto acceleration = imu.getAcceleration().value();
+            std::rotate(history.rbegin(), history.rbegin() + 1, history.rend());
+            history[0] = acceleration;
+            const double heart = 30.0 * std::sin(twoPi * bpm / 60.0 * t) + 8.0 * std::sin(2.0 * twoPi * bpm / 60.0 * t + 0.5);
+            const double artifact = couplingGain[0] * history[1].x + couplingGain[1] * history[0].y
+                                    + couplingGain[2] * (history[2].z - 9.81f);
+            const auto iBlock = iSample % blockSize;
+            raw[iBlock] = static_cast<uint16_t>(std::clamp(19000.0 + heart + artifact, 0.0, 65535.0));
+            motion[iBlock] = acceleration;
+            if(iSample == 0)
+            {
+                filter.prime(raw[0]);
+                filterCancelled.prime(raw[0]);
+            }
+            if(iBlock + 1 < blockSize)
+            {
+                continue;
+            }
+
+            filter.process(std::span<const float32_t>{raw}, std::span<float32_t>{filtered});
+            filterCancelled.process(std::span<const float32_t>{raw}, std::span<float32_t>{cleaned});
+            const auto start = std::chrono::steady_clock::now();
+            canceller.process(motion, cleaned);
+            cancellerTime += std::chrono::steady_clock::now() - start;
+
+            for(size_t i = 0; i < blockSize; ++i)
+            {
+                const auto n = iSample + 1 - blockSize + i + 1;
+                Processor::PpgMeasurement measurement{};
+                measurement.timestamp = (n - 1) * 1000000U / sampleRate;
+                measurement.filtered = filtered[i];
+                const auto estimate = profile.processHr(measurement);
+                measurement.filtered = cleaned[i];
+                const auto estimateCancelled = profileCancelled.processHr(measurement);
+                if(n % hrSamples == 0 && n >= warmUpSeconds * sampleRate)
+                {
+                    errors.push_back(std::fabs(estimate - bpm));
+                    errorsCancelled.push_back(std::fabs(estimateCancelled - bpm));
+                }
+            }
+        }
+        const auto plain = score(errors);
+        const auto cancelled = score(errorsCancelled);
+        std::printf("%.*s,%zu,%.1f,%.0f%%,%.1f,%.0f%%,%.1f\n", static_cast<int>(name.size()), name.data(), errors.size()
+                    , plain.medianError, 100.0 * plain.within5, cancelled.medianError, 100.0 * cancelled.within5
+                    , static_cast<double>(cancellerTime.count()) / numSamples);
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_motion [--trace rest|walking|running|random] [--seconds <s>] [--bpm <bpm>] [--mu <step size>]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 300.0;
+    double bpm = 72.0;
+    float32_t mu = MotionCanceller::DefaultStepSize;
+    std::vector<std::string_view> traces{"rest", "walking", "running", "random"};
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--trace" && iArg + 1 < argc)
+        {
+            traces = {argv[++iArg]};
+        }
+        else if(arg == "--seconds" && iArg + 1 < argc)
+        {
+            seconds = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--bpm" && iArg + 1 < argc)
+        {
+            bpm = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--mu" && iArg + 1 < argc)
+        {
+            mu = std::strtof(argv[++iArg], nullptr);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf("trace,estimates,median_error,within_5,median_error_nlms,within_5_nlms,nlms_ns_per_sample\n");
+    for(const auto name : traces)
+    {
+        const auto trace = EmulatedImu::parseTrace(name);
+        if(!trace.has_value())
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+        evaluate(trace.value(), name, seconds, bpm, mu);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+// Replays recordings through the streaming pipeline in virtual time (src/VirtualTime.hpp), much faster than real time
+// and with the same timing on every run, for throughput and drop rate regressions
+//
+// usage: ppg_replay [--cost <us>] [--stall <ms>] [--stall-every <s>] [--out <dir>] <recording>...
+// the firmware DataCollector, Processor::Ppg and Processor::OutputStage run on a virtual sample timer, clock and queue,
+// with a sensor reading the raw samples of the recording; the main loop is the one of Application,
+// spending --cost per sample and a --stall every --stall-every (e.g. a USB stall) after writing the line.
+// The Kconfig options are the firmware defaults of host_autoconf.h
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Clock.hpp"
+#include "DataCollector.hpp"
+#include "IProximity.hpp"
+#include "OutputStage.hpp"
+#include "PipelineProfile.hpp"
+#include "PpgProcessor.hpp"
+#include "SampleSource.hpp"
+#include "VirtualTime.hpp"
+
+namespace
+{
+    using HighResolutionProfile = Processor::PipelineProfile<50, 100, 200, 1024>;
+    using PpgQueue = Hardware::VirtualMessageQueue<Processor::Ppg::Measurement, Processor::Ppg::QueueSize>;
+
+    static constexpr std::size_t readBlockSize = 256;
+
+    struct Options
+    {
+        std::chrono::microseconds cost{500};
+        std::chrono::microseconds stall{0};
+        std::chrono::microseconds stallEvery{std::chrono::seconds(60)};
+        std::optional<std::filesystem::path> outDir;
+    };
+
+    struct Result
+    {
+        bool ok;
+        std::size_t numSamples;
+        uint64_t virtualUs;
+        double wallSeconds;
+        uint32_t numDropped;
+        std::size_t maxBacklog;
+        uint32_t numOverruns;
+        uint32_t numTransitions;
+        uint32_t numSkippedFrames;
+        uint8_t medianBpm;
+        uint32_t outputHash;
+    };
+
+    // deadline monitor time in virtual microseconds
+    class VirtualCycleCounter
+        : public Benchmark::ICycleCounter<uint64_t, 1000000>
+    {
+        public:
+            VirtualCycleCounter(Hardware::IClock& clock)
+                : clock_{clock}
+            { }
+
+            time_point now() noexcept override
+            {
+                return time_point{ duration{ clock_.nowUs() } };
+            }
+        private:
+            Hardware::IClock& clock_;
+    };
+
+    // proximity sensor returning the raw samples of the recording, fails once it ended
+    class RecordedSensor
+        : public Hardware::IProximity
+    {
+        public:
+            RecordedSensor(std::unique_ptr<SampleSource> source)
+                : source_{std::move(source)}
+            { }
+
+            std::optional<ValueT> getProximity() override
+            {
+                if(iRaw_ == numRaw_)
+                {
+                    numRaw_ = ended_ ? 0 : source_->read(timestamps_, raw_);
+                    iRaw_ = 0;
+                    if(numRaw_ == 0)
+                    {
+                        ended_ = true;
+                        return {};
+                    }
+                }
+                numRead_++;
+                return raw_[iRaw_++];
+            }
+
+            bool hasEnded() const { return ended_; }
+            std::size_t getNumRead() const { return numRead_; }
+        private:
+            std::unique_ptr<SampleSource> source_;
+            std::array<uint64_t, readBlockSize> timestamps_{};
+            std::array<uint16_t, readBlockSize> raw_{};
+            std::size_t numRaw_{};
+            std::size_t iRaw_{};
+            std::size_t numRead_{};
+            bool ended_{};
+    };
+
+    uint32_t fnv1a(const uint32_t hash, std::string_view bytes)
+    {
+        uint32_t result = hash;
+        for(const auto byte : bytes)
+        {
+            result = (result ^ static_cast<uint8_t>(byte)) * 16777619U;
+        }
+        return result;
+    }
+
+    // the main loop of Application, waiting for a measurement runs the next event instead of blocking
+    Result replay(const std::string& path, const Options& options)
+    {
+        Result result{};
+        auto source = SampleSource::open(path);
+        if(!source)
+        {
+            return result;
+        }
+        FILE* out = nullptr;
+        if(options.outDir.has_value())
+        {
+            const auto outPath = options.outDir.value() / (std::filesystem::path{path}.stem().string() + ".txt");
+            out = std::fopen(outPath.c_str(), "w");
+            if(!out)
+            {
+                return result;
+            }
+        }
+        const auto wallStart = std::chrono::steady_clock::now();
+
+        Hardware::VirtualClock clock;
+        Hardware::VirtualTimer sampleTimer{clock};
+        RecordedSensor sensor{std::move(source)};
+        HighResolutionProfile profile{"high-resolution"};
+        PpgQueue queue{clock};
+        Processor::Ppg ppg{sensor, profile.filter(), queue};
+        DataCollector dataCollector{ppg, clock, sampleTimer};
+        VirtualCycleCounter counter{clock};
+        Processor::OutputStage<VirtualCycleCounter> outputStage{counter, profile};
+
+        std::vector<uint8_t> bpms;
+        uint32_t hash = 2166136261U;
+        uint64_t nextStallUs = options.stallEvery.count();
+        bool stopped = false;
+        profile.reset();
+        dataCollector.start(profile.sampleTime());
+        while(true)
+        {
+            const auto measurement = ppg.getMeasurement(std::chrono::milliseconds(10));
+            if(!measurement.has_value())
+            {
+                if(!sensor.hasEnded())
+                {
+                    continue;
+                }
+                if(stopped)
+                {
+                    break; //< the recording ended and the queue is empty
+                }
+                // publish the last partial block
+                dataCollector.stop();
+                ppg.flush();
+                stopped = true;
+                continue;
+            }
+            outputStage.begin();
+            const auto line = outputStage.process(measurement.value());
+            if(outputStage.getBpm()) bpms.push_back(outputStage.getBpm());
+            if(!line.empty())
+            {
+                hash = fnv1a(hash, line);
+                if(out) std::fwrite(line.data(), 1, line.size(), out);
+            }
+            // processing and output time, the samples measured meanwhile are queued
+            auto cost = options.cost;
+            if(options.stall.count() > 0 && clock.nowUs() >= nextStallUs)
+            {
+                cost += options.stall;
+                nextStallUs += options.stallEvery.count();
+            }
+            clock.runFor(cost);
+            outputStage.end(ppg.getBacklog());
+        }
+        if(out) std::fclose(out);
+
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        result.numSamples = sensor.getNumRead();
+        result.virtualUs = clock.nowUs();
+        result.numDropped = ppg.getNumDropped();
+        result.maxBacklog = queue.getMaxSize();
+        result.numOverruns = outputStage.monitor().stats().overruns;
+        result.numTransitions = outputStage.monitor().stats().transitions;
+        result.numSkippedFrames = profile.getNumSkippedFrames();
+        if(!bpms.empty())
+        {
+            std::nth_element(bpms.begin(), bpms.begin() + bpms.size() / 2, bpms.end());
+            result.medianBpm = bpms[bpms.size() / 2];
+        }
+        result.outputHash = hash;
+        result.ok = true;
+        return result;
+    }
+
+    void printResult(const std::string& name, const Result& result)
+    {
+        const auto virtualSeconds = result.virtualUs / 1e6;
+        std::printf("%s: %zu samples, %.1f s in %.3f s (%.0fx), %u dropped, max backlog %zu"
+                    ", %u overruns, %u mode changes, %u skipped frames, median %u BPM, output %08x\n"
+                    , name.c_str(), result.numSamples, virtualSeconds, result.wallSeconds
+                    , virtualSeconds / std::max(result.wallSeconds, 1e-9), result.numDropped, result.maxBacklog
+                    , result.numOverruns, result.numTransitions, result.numSkippedFrames, result.medianBpm, result.outputHash);
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_replay [--cost <us>] [--stall <ms>] [--stall-every <s>] [--out <dir>] <recording>...\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<std::string> paths;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--cost" && iArg + 1 < argc)
+        {
+            options.cost = std::chrono::microseconds(std::strtoul(argv[++iArg], nullptr, 10));
+        }
+        else if(arg == "--stall" && iArg + 1 < argc)
+        {
+            options.stall = std::chrono::milliseconds(std::strtoul(argv[++iArg], nullptr, 10));
+        }
+        else if(arg == "--stall-every" && iArg + 1 < argc)
+        {
+            options.stallEvery = std::chrono::seconds(std::max(1UL, std::strtoul(argv[++iArg], nullptr, 10)));
+        }
+        else if(arg == "--out" && iArg + 1 < argc)
+        {
+            options.outDir = argv[++iArg];
+        }
+        else if(!arg.starts_with("-"))
+        {
+            paths.emplace_back(arg);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if(paths.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    if(options.outDir.has_value())
+    {
+        std::filesystem::create_directories(options.outDir.value());
+    }
+
+    for(const auto& path : paths)
+    {
+        const auto result = replay(path, options);
+        if(!result.ok)
+        {
+            std::fprintf(stderr, "Can't replay %s\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        printResult(std::filesystem::path{path}.filename().string(), result);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+// Evaluates the timestamp-aware resampling stage on synthetic recordings with sampling jitter and dropped samples
+//
+// usage: ppg_resample [--seconds <s>] [--bpm <bpm>] [--jitter <us>] [--drop <fraction>] [--max-gap <ms>]
+// a PPG signal is sampled at 50 Hz with random latency up to the jitter and randomly dropped samples,
+// then the firmware filter and heart rate run without resampling and with linear and cubic resampling
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "HrProcessor.hpp"
+#include "PpgFilter.hpp"
+#include "Resampler.hpp"
+
+namespace
+{
+    // same configuration as the high resolution profile
+    static constexpr uint16_t sampleRate = 50; //< Hz
+    static constexpr size_t hrSamples = 100;
+    static constexpr size_t hrSamplesHistory = 200;
+    using HeartRate = Processor::HeartRate<hrSamples, hrSamplesHistory>;
+
+    static constexpr double warmUpSeconds = 20.0; //< estimates before are not scored
+
+    struct Sample
+    {
+        uint64_t timestamp; //< us
+        float32_t filtered;
+    };
+
+    struct Score
+    {
+        double medianError;
+        double within3; //< fraction of estimates within 3 BPM, about one FFT bin
+    };
+
+    Score score(std::vector<double> errors)
+    {
+        if(errors.empty())
+        {
+            return {};
+        }
+        std::sort(errors.begin(), errors.end());
+        const auto numWithin3 = std::count_if(errors.begin(), errors.end(), [](double e) { return e <= 3.0; });
+        return {errors[errors.size() / 2], static_cast<double>(numWithin3) / errors.size()};
+    }
+
+    // measured and filtered samples, like the firmware output before the heart rate stage
+    std::vector<Sample> acquire(const double seconds, const double bpm, const double jitterUs, const double drop)
+    {
+        constexpr double twoPi = 2.0 * std::numbers::pi;
+        std::mt19937 generator{42};
+        std::uniform_real_distribution<double> latency{0.0, jitterUs};
+        std::bernoulli_distribution dropped{drop};
+        auto filter = Processor::makePpgFilter();
+        std::vector<Sample> samples;
+        const auto numPeriods = static_cast<size_t>(seconds * sampleRate);
+        for(size_t iPeriod = 0; iPeriod < numPeriods; ++iPeriod)
+        {
+            // the workqueue runs late by up to the jitter, the sensor is read at that time
+            const double t = static_cast<double>(iPeriod) / sampleRate + latency(generator) * 1e-6;
+            if(iPeriod > 0 && dropped(generator))
+            {
+                continue;
+            }
+            const double heart = 30.0 * std::sin(twoPi * bpm / 60.0 * t) + 8.0 * std::sin(2.0 * twoPi * bpm / 60.0 * t + 0.5);
+            const auto raw = static_cast<float32_t>(static_cast<uint16_t>(19000.0 + heart));
+            if(samples.empty())
+            {
+                filter.prime(raw);
+            }
+            float32_t filtered{};
+            filter.process(std::span<const float32_t>{&raw, 1}, std::span<float32_t>{&filtered, 1});
+            samples.push_back({static_cast<uint64_t>(t * 1e6), filtered});
+        }
+        return samples;
+    }
+
+    // scores estimates taken every hrSamples grid samples, and the time spent in the resampler
+    template <typename ResamplerT>
+    void evaluate(const std::string_view name, const std::vector<Sample>& samples, const double bpm, ResamplerT* resampler)
+    {
+        HeartRate hr{sampleRate};
+        std::vector<double> errors;
+        size_t numGrid = 0;
+        const auto onGrid = [&](const float32_t filtered) {
+            Processor::PpgMeasurement measurement{};
+            measurement.filtered = static_cast<int16_t>(std::lround(filtered));
+            const auto estimate = hr.process(measurement);
+            numGrid++;
+            if(numGrid % hrSamples == 0 && numGrid >= warmUpSeconds * sampleRate)
+            {
+                errors.push_back(std::fabs(estimate - bpm));
+            }
+        };
+        std::chrono::nanoseconds resamplerTime{};
+        if(resampler)
+        {
+            // time the resampler alone first, then feed the heart rate from the same grid
+            std::vector<float32_t> grid;
+            grid.reserve(samples.size() * 2);
+            const auto start = std::chrono::steady_clock::now();
+            for(const auto& sample : samples)
+            {
+                resampler->process(sample.timestamp, sample.filtered, [&grid](const float32_t value) { grid.push_back(value); });
+            }
+            resamplerTime = std::chrono::steady_clock::now() - start;
+            std::for_each(grid.begin(), grid.end(), onGrid);
+        }
+        else
+        {
+            for(const auto& sample : samples)
+            {
+                onGrid(sample.filtered);
+            }
+        }
+        const auto result = score(errors);
+        std::printf("%.*s,%zu,%zu,%.1f,%.0f%%,%u,%u,%.1f\n", static_cast<int>(name.size()), name.data(), samples.size(), numGrid
+                    , result.medianError, 100.0 * result.within3
+                    , resampler ? resampler->getNumFilled() : 0U, resampler ? resampler->getNumResyncs() : 0U
+                    , static_cast<double>(resamplerTime.count()) / samples.size());
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: ppg_resample [--seconds <s>] [--bpm <bpm>] [--jitter <us>] [--drop <fraction>] [--max-gap <ms>]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 300.0;
+    double bpm = 72.0;
+    double jitterUs = 2000.0;
+    double drop = 0.05;
+    long maxGapMs = 1000;
+    for(int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string_view arg{argv[iArg]};
+        if(arg == "--seconds" && iArg + 1 < argc)
+        {
+            seconds = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--bpm" && iArg + 1 < argc)
+        {
+            bpm = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--jitter" && iArg + 1 < argc)
+        {
+            jitterUs = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--drop" && iArg + 1 < argc)
+        {
+            drop = std::strtod(argv[++iArg], nullptr);
+        }
+        else if(arg == "--max-gap" && iArg + 1 < argc)
+        {
+            maxGapMs = std::strtol(argv[++iArg], nullptr, 10);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto samples = acquire(seconds, bpm, jitterUs, drop);
+    const std::chrono::milliseconds maxGap{maxGapMs};
+    Dsp::Resampler<Dsp::Interpolation::Linear> linear{sampleRate, maxGap};
+    Dsp::Resampler<Dsp::Interpolation::Cubic> cubic{sampleRate, maxGap};
+    std::printf("resampler,samples,grid_samples,median_error,within_3,filled,resyncs,resampler_ns_per_sample\n");
+    evaluate<Dsp::Resampler<>>("none", samples, bpm, nullptr);
+    evaluate("linear", samples, bpm, &linear);
+    evaluate("cubic", samples, bpm, &cubic);
+    return EXIT_SUCCESS;
+}
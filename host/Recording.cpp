@@ -0,0 +1,319 @@
+#include "Recording.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Recording
+{
+    namespace
+    {
+        constexpr std::size_t alignUp(const std::size_t value)
+        {
+            return (value + Alignment - 1) / Alignment * Alignment;
+        }
+
+        template <typename T>
+        void appendValue(std::vector<std::byte>& column, const double value)
+        {
+            T converted{};
+            if constexpr(std::is_floating_point_v<T>)
+            {
+                converted = static_cast<T>(value);
+            }
+            else
+            {
+                converted = static_cast<T>(std::llround(value));
+            }
+            const auto* bytes = reinterpret_cast<const std::byte*>(&converted);
+            column.insert(column.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        double readValue(const std::byte* data)
+        {
+            T value{};
+            std::memcpy(&value, data, sizeof(T));
+            return static_cast<double>(value);
+        }
+
+        double readValue(const ColumnType type, const std::byte* data)
+        {
+            switch(type)
+            {
+                case ColumnType::U8: return readValue<uint8_t>(data);
+                case ColumnType::U16: return readValue<uint16_t>(data);
+                case ColumnType::I16: return readValue<int16_t>(data);
+                case ColumnType::U32: return readValue<uint32_t>(data);
+                case ColumnType::I32: return readValue<int32_t>(data);
+                case ColumnType::U64: return readValue<uint64_t>(data);
+                case ColumnType::F32: return readValue<float>(data);
+            }
+            return 0.0;
+        }
+
+        bool writePadding(std::FILE* file, const std::size_t from, const std::size_t to)
+        {
+            static constexpr std::array<std::byte, Alignment> zeros{};
+            return std::fwrite(zeros.data(), 1, to - from, file) == to - from;
+        }
+    }
+
+    Writer::Writer(const Schema& schema, const std::size_t timeColumn, const uint32_t chunkSamples)
+        : schema_{schema}
+        , timeColumn_{timeColumn}
+        , chunkSamples_{chunkSamples ? chunkSamples : 1}
+        , columns_(schema.size())
+        , numSamples_{}
+    { }
+
+    bool Writer::append(std::span<const double> row)
+    {
+        if(row.size() != schema_.size())
+        {
+            return false;
+        }
+        for(std::size_t iColumn = 0; iColumn < schema_.size(); ++iColumn)
+        {
+            auto& column = columns_[iColumn];
+            const auto value = row[iColumn];
+            switch(schema_[iColumn].type)
+            {
+                case ColumnType::U8: appendValue<uint8_t>(column, value); break;
+                case ColumnType::U16: appendValue<uint16_t>(column, value); break;
+                case ColumnType::I16: appendValue<int16_t>(column, value); break;
+                case ColumnType::U32: appendValue<uint32_t>(column, value); break;
+                case ColumnType::I32: appendValue<int32_t>(column, value); break;
+                case ColumnType::U64: appendValue<uint64_t>(column, value); break;
+                case ColumnType::F32: appendValue<float>(column, value); break;
+            }
+        }
+        numSamples_++;
+        return true;
+    }
+
+    std::size_t Writer::size() const
+    {
+        return numSamples_;
+    }
+
+    uint64_t Writer::timestampAt(const std::size_t iSample) const
+    {
+        const auto type = schema_[timeColumn_].type;
+        const auto width = columnTypeWidth(type);
+        return static_cast<uint64_t>(readValue(type, columns_[timeColumn_].data() + iSample * width));
+    }
+
+    float Writer::estimateSampleRate() const
+    {
+        if(numSamples_ < 2)
+        {
+            return 0.0f;
+        }
+        // median interval is robust to gaps and jitter
+        std::vector<uint64_t> intervals;
+        intervals.reserve(numSamples_ - 1);
+        for(std::size_t iSample = 1; iSample < numSamples_; ++iSample)
+        {
+            const auto prev = timestampAt(iSample - 1);
+            const auto curr = timestampAt(iSample);
+            if(curr > prev)
+            {
+                intervals.push_back(curr - prev);
+            }
+        }
+        if(intervals.empty())
+        {
+            return 0.0f;
+        }
+        auto median = intervals.begin() + intervals.size() / 2;
+        std::nth_element(intervals.begin(), median, intervals.end());
+        return std::round(1e7f / static_cast<float>(*median)) / 10.0f; //< 0.1 Hz resolution, us timestamps
+    }
+
+    bool Writer::write(const std::string& path, std::optional<float> sampleRate) const
+    {
+        if(schema_.empty() || timeColumn_ >= schema_.size())
+        {
+            return false;
+        }
+        const auto numChunks = (numSamples_ + chunkSamples_ - 1) / chunkSamples_;
+        std::vector<ColumnDescriptor> descriptors(schema_.size());
+        std::size_t offset = alignUp(alignUp(sizeof(FileHeader)) + descriptors.size() * sizeof(ColumnDescriptor));
+        for(std::size_t iColumn = 0; iColumn < schema_.size(); ++iColumn)
+        {
+            auto& descriptor = descriptors[iColumn];
+            const auto& name = schema_[iColumn].name;
+            descriptor.name = {};
+            std::memcpy(descriptor.name.data(), name.data(), std::min(name.size(), MaxColumnNameLength - 1));
+            descriptor.type = schema_[iColumn].type;
+            descriptor.width = static_cast<uint8_t>(columnTypeWidth(descriptor.type));
+            descriptor.offset = offset;
+            offset = alignUp(offset + columns_[iColumn].size());
+        }
+        std::vector<ChunkIndexEntry> chunkIndex(numChunks);
+        for(std::size_t iChunk = 0; iChunk < numChunks; ++iChunk)
+        {
+            chunkIndex[iChunk].firstSample = iChunk * chunkSamples_;
+            chunkIndex[iChunk].firstTimestamp = timestampAt(iChunk * chunkSamples_);
+        }
+
+        FileHeader header{};
+        header.magic = Magic;
+        header.version = Version;
+        header.numColumns = static_cast<uint16_t>(schema_.size());
+        header.timeColumn = static_cast<uint16_t>(timeColumn_);
+        header.chunkSamples = chunkSamples_;
+        header.sampleRate = sampleRate.value_or(estimateSampleRate());
+        header.numSamples = numSamples_;
+        header.numChunks = numChunks;
+        header.chunkIndexOffset = offset;
+
+        auto* file = std::fopen(path.c_str(), "wb");
+        if(!file)
+        {
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && writePadding(file, sizeof(header), alignUp(sizeof(header)));
+        ok = ok && std::fwrite(descriptors.data(), sizeof(ColumnDescriptor), descriptors.size(), file) == descriptors.size();
+        std::size_t position = alignUp(sizeof(header)) + descriptors.size() * sizeof(ColumnDescriptor);
+        for(std::size_t iColumn = 0; ok && iColumn < schema_.size(); ++iColumn)
+        {
+            ok = writePadding(file, position, descriptors[iColumn].offset);
+            const auto& column = columns_[iColumn];
+            ok = ok && std::fwrite(column.data(), 1, column.size(), file) == column.size();
+            position = descriptors[iColumn].offset + column.size();
+        }
+        ok = ok && writePadding(file, position, header.chunkIndexOffset);
+        ok = ok && std::fwrite(chunkIndex.data(), sizeof(ChunkIndexEntry), chunkIndex.size(), file) == chunkIndex.size();
+        ok = (std::fclose(file) == 0) && ok;
+        return ok;
+    }
+
+    Reader::Reader(const std::byte* base, const std::size_t size)
+        : base_{base}
+        , size_{size}
+        , header_{reinterpret_cast<const FileHeader*>(base)}
+        , columns_{reinterpret_cast<const ColumnDescriptor*>(base + alignUp(sizeof(FileHeader))), header_->numColumns}
+        , chunks_{reinterpret_cast<const ChunkIndexEntry*>(base + header_->chunkIndexOffset), header_->numChunks}
+    { }
+
+    Reader::Reader(Reader&& other) noexcept
+        : base_{other.base_}
+        , size_{other.size_}
+        , header_{other.header_}
+        , columns_{other.columns_}
+        , chunks_{other.chunks_}
+    {
+        other.base_ = nullptr;
+        other.size_ = 0;
+    }
+
+    Reader::~Reader()
+    {
+        if(base_)
+        {
+            munmap(const_cast<std::byte*>(base_), size_);
+        }
+    }
+
+    std::optional<Reader> Reader::open(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            return {};
+        }
+        struct stat st{};
+        if(fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < alignUp(sizeof(FileHeader)))
+        {
+            ::close(fd);
+            return {};
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(mapped == MAP_FAILED)
+        {
+            return {};
+        }
+        const auto* base = static_cast<const std::byte*>(mapped);
+        const auto* header = reinterpret_cast<const FileHeader*>(base);
+        // validate everything the accessors rely on before handing out views,
+        // sizes are compared by division, so a crafted header can't wrap the arithmetic
+        const std::size_t descriptorsOffset = alignUp(sizeof(FileHeader));
+        bool valid = header->magic == Magic && header->version == Version
+                    && header->timeColumn < header->numColumns
+                    && header->numColumns <= (size - descriptorsOffset) / sizeof(ColumnDescriptor)
+                    && header->chunkIndexOffset <= size
+                    && header->chunkIndexOffset % Alignment == 0
+                    && header->numChunks <= (size - header->chunkIndexOffset) / sizeof(ChunkIndexEntry);
+        const auto* descriptors = reinterpret_cast<const ColumnDescriptor*>(base + descriptorsOffset);
+        for(std::size_t iColumn = 0; valid && iColumn < header->numColumns; ++iColumn)
+        {
+            const auto& descriptor = descriptors[iColumn];
+            valid = descriptor.width != 0 && descriptor.width == columnTypeWidth(descriptor.type)
+                    && descriptor.offset % Alignment == 0
+                    && descriptor.offset <= size
+                    && header->numSamples <= (size - descriptor.offset) / descriptor.width;
+        }
+        // seek() reads the time column from the first sample of a chunk
+        for(std::size_t iChunk = 0; valid && iChunk < header->numChunks; ++iChunk)
+        {
+            const auto* chunks = reinterpret_cast<const ChunkIndexEntry*>(base + header->chunkIndexOffset);
+            valid = chunks[iChunk].firstSample < header->numSamples;
+        }
+        if(!valid)
+        {
+            munmap(mapped, size);
+            return {};
+        }
+        return Reader{base, size};
+    }
+
+    std::optional<std::size_t> Reader::findColumn(std::string_view name) const
+    {
+        for(std::size_t iColumn = 0; iColumn < columns_.size(); ++iColumn)
+        {
+            const auto& columnName = columns_[iColumn].name;
+            if(name == std::string_view{columnName.data(), strnlen(columnName.data(), columnName.size())})
+            {
+                return iColumn;
+            }
+        }
+        return {};
+    }
+
+    double Reader::valueAt(const std::size_t iColumn, const std::size_t iSample) const
+    {
+        const auto& descriptor = columns_[iColumn];
+        return readValue(descriptor.type, base_ + descriptor.offset + iSample * descriptor.width);
+    }
+
+    std::size_t Reader::seek(const uint64_t timestamp) const
+    {
+        // find the chunk with the timestamp via the index, then search inside it
+        auto itrChunk = std::upper_bound(chunks_.begin(), chunks_.end(), timestamp
+                        , [](const uint64_t ts, const ChunkIndexEntry& entry) { return ts < entry.firstTimestamp; });
+        if(itrChunk == chunks_.begin())
+        {
+            return 0;
+        }
+        --itrChunk;
+        const auto timeColumn = header_->timeColumn;
+        auto iSample = itrChunk->firstSample;
+        const auto iEnd = std::min<uint64_t>(iSample + header_->chunkSamples, header_->numSamples);
+        while(iSample < iEnd && valueAt(timeColumn, iSample) < static_cast<double>(timestamp))
+        {
+            ++iSample;
+        }
+        return iSample;
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef _PPG_RECORDING_HPP
+#define _PPG_RECORDING_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Versioned binary columnar recording format (*.ppgrec)
+//
+// File layout (little-endian, every section 64-byte aligned):
+//   FileHeader
+//   ColumnDescriptor[numColumns]
+//   column 0 samples (numSamples * width)
+//   ...
+//   column N-1 samples
+//   ChunkIndexEntry[numChunks]
+//
+// Each column is one contiguous fixed-width array, so readers can map the
+// file and use the columns in place. The chunk index stores the value of the
+// time column at every chunkSamples-th sample, for seeking by timestamp.
+namespace Recording
+{
+    static constexpr std::array<char, 8> Magic{'P', 'P', 'G', 'R', 'E', 'C', '\0', '\0'};
+    static constexpr uint16_t Version = 1;
+    static constexpr std::size_t Alignment = 64;
+    static constexpr std::size_t MaxColumnNameLength = 16;
+
+    enum class ColumnType : uint8_t
+    {
+        U8 = 0,
+        U16,
+        I16,
+        U32,
+        I32,
+        U64,
+        F32,
+    };
+
+    constexpr std::size_t columnTypeWidth(const ColumnType type)
+    {
+        switch(type)
+        {
+            case ColumnType::U8: return 1;
+            case ColumnType::U16: return 2;
+            case ColumnType::I16: return 2;
+            case ColumnType::U32: return 4;
+            case ColumnType::I32: return 4;
+            case ColumnType::U64: return 8;
+            case ColumnType::F32: return 4;
+        }
+        return 0;
+    }
+
+    template <typename T>
+    constexpr std::optional<ColumnType> columnTypeOf()
+    {
+        if constexpr(std::is_same_v<T, uint8_t>) return ColumnType::U8;
+        else if constexpr(std::is_same_v<T, uint16_t>) return ColumnType::U16;
+        else if constexpr(std::is_same_v<T, int16_t>) return ColumnType::I16;
+        else if constexpr(std::is_same_v<T, uint32_t>) return ColumnType::U32;
+        else if constexpr(std::is_same_v<T, int32_t>) return ColumnType::I32;
+        else if constexpr(std::is_same_v<T, uint64_t>) return ColumnType::U64;
+        else if constexpr(std::is_same_v<T, float>) return ColumnType::F32;
+        else return {};
+    }
+
+    struct FileHeader
+    {
+        std::array<char, 8> magic;
+        uint16_t version;
+        uint16_t numColumns;
+        uint16_t timeColumn;        //< column used by the chunk index
+        uint16_t reserved0;
+        uint32_t chunkSamples;
+        float sampleRate;           //< Hz
+        uint64_t numSamples;
+        uint64_t numChunks;
+        uint64_t chunkIndexOffset;  //< bytes from the start of the file
+        uint64_t reserved1;
+    };
+    static_assert(sizeof(FileHeader) == 56);
+
+    struct ColumnDescriptor
+    {
+        std::array<char, MaxColumnNameLength> name;
+        ColumnType type;
+        uint8_t width;              //< bytes per sample
+        uint16_t reserved0;
+        uint32_t reserved1;
+        uint64_t offset;            //< bytes from the start of the file
+    };
+    static_assert(sizeof(ColumnDescriptor) == 32);
+
+    struct ChunkIndexEntry
+    {
+        uint64_t firstSample;
+        uint64_t firstTimestamp;    //< time column value of firstSample
+    };
+    static_assert(sizeof(ChunkIndexEntry) == 16);
+
+    struct Column
+    {
+        std::string name;
+        ColumnType type;
+    };
+    using Schema = std::vector<Column>;
+
+    class Writer
+    {
+        public:
+            Writer(const Schema& schema, const std::size_t timeColumn = 0, const uint32_t chunkSamples = 4096);
+            // appends one row, values are converted to the column types
+            bool append(std::span<const double> row);
+            std::size_t size() const;
+            // sample rate is estimated from the time column (in microseconds) when not given
+            bool write(const std::string& path, std::optional<float> sampleRate = {}) const;
+        private:
+            float estimateSampleRate() const;
+            uint64_t timestampAt(const std::size_t iSample) const;
+        private:
+            Schema schema_;
+            std::size_t timeColumn_;
+            uint32_t chunkSamples_;
+            std::vector<std::vector<std::byte>> columns_;
+            std::size_t numSamples_;
+    };
+
+    class Reader
+    {
+        public:
+            static std::optional<Reader> open(const std::string& path);
+            Reader(Reader&& other) noexcept;
+            Reader& operator=(Reader&& other) = delete;
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            ~Reader();
+
+            const FileHeader& header() const { return *header_; }
+            std::span<const ColumnDescriptor> columns() const { return columns_; }
+            std::span<const ChunkIndexEntry> chunks() const { return chunks_; }
+            std::optional<std::size_t> findColumn(std::string_view name) const;
+
+            // zero copy view of a column mapped from the file
+            template <typename T>
+            std::optional<std::span<const T>> column(const std::size_t iColumn) const
+            {
+                if(iColumn >= columns_.size() || columnTypeOf<T>() != columns_[iColumn].type)
+                {
+                    return {};
+                }
+                const auto* first = reinterpret_cast<const T*>(base_ + columns_[iColumn].offset);
+                return std::span<const T>{first, header_->numSamples};
+            }
+
+            template <typename T>
+            std::optional<std::span<const T>> column(std::string_view name) const
+            {
+                const auto iColumn = findColumn(name);
+                if(!iColumn.has_value()) return {};
+                return column<T>(iColumn.value());
+            }
+
+            // value of the given column at iSample, widened to double
+            double valueAt(const std::size_t iColumn, const std::size_t iSample) const;
+            // index of the first sample whose time column value is >= timestamp
+            std::size_t seek(const uint64_t timestamp) const;
+        private:
+            Reader(const std::byte* base, const std::size_t size);
+        private:
+            const std::byte* base_;
+            std::size_t size_;
+            const FileHeader* header_;
+            std::span<const ColumnDescriptor> columns_;
+            std::span<const ChunkIndexEntry> chunks_;
+    };
+}
+
+#endif //_PPG_RECORDING_HPP
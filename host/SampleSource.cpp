@@ -0,0 +1,120 @@
+#include "SampleSource.hpp"
+
+#include <array>
+#include <fstream>
+#include <optional>
+
+#include "CsvParser.hpp"
+#include "Recording.hpp"
+
+namespace
+{
+    class CsvSampleSource
+        : public SampleSource
+    {
+        public:
+            CsvSampleSource(std::ifstream&& input, const std::size_t numColumns
+                            , const std::size_t timeColumn, const std::size_t rawColumn)
+                : input_{std::move(input)}
+                , numColumns_{numColumns}
+                , timeColumn_{timeColumn}
+                , rawColumn_{rawColumn}
+            { }
+
+            std::size_t read(std::span<uint64_t> timestamps, std::span<uint16_t> raw) override
+            {
+                std::array<double, 8> values{};
+                std::size_t numRead = 0;
+                while(numRead < timestamps.size() && std::getline(input_, line_))
+                {
+                    const auto numValues = Csv::parseLine(line_, values);
+                    if(!numValues.has_value() || numValues.value() != numColumns_)
+                    {
+                        continue;
+                    }
+                    timestamps[numRead] = static_cast<uint64_t>(values[timeColumn_]);
+                    raw[numRead] = static_cast<uint16_t>(values[rawColumn_]);
+                    numRead++;
+                }
+                return numRead;
+            }
+        private:
+            std::ifstream input_;
+            std::string line_;
+            std::size_t numColumns_;
+            std::size_t timeColumn_;
+            std::size_t rawColumn_;
+    };
+
+    class RecordingSampleSource
+        : public SampleSource
+    {
+        public:
+            RecordingSampleSource(Recording::Reader&& reader, std::span<const uint16_t> raw)
+                : reader_{std::move(reader)}
+                , raw_{raw}
+                , iSample_{}
+            { }
+
+            std::size_t read(std::span<uint64_t> timestamps, std::span<uint16_t> raw) override
+            {
+                const auto numSamples = std::min(timestamps.size(), raw_.size() - iSample_);
+                const auto timeColumn = reader_.header().timeColumn;
+                for(std::size_t i = 0; i < numSamples; ++i)
+                {
+                    timestamps[i] = static_cast<uint64_t>(reader_.valueAt(timeColumn, iSample_ + i));
+                    raw[i] = raw_[iSample_ + i];
+                }
+                iSample_ += numSamples;
+                return numSamples;
+            }
+        private:
+            Recording::Reader reader_;
+            std::span<const uint16_t> raw_;
+            std::size_t iSample_;
+    };
+}
+
+std::unique_ptr<SampleSource> SampleSource::open(const std::string& path)
+{
+    if(path.ends_with(".ppgrec"))
+    {
+        auto reader = Recording::Reader::open(path);
+        if(!reader.has_value())
+        {
+            return {};
+        }
+        const auto raw = reader->column<uint16_t>("Raw");
+        if(!raw.has_value())
+        {
+            return {};
+        }
+        return std::make_unique<RecordingSampleSource>(std::move(reader.value()), raw.value());
+    }
+
+    std::ifstream input{path};
+    std::string header;
+    if(!input || !std::getline(input, header))
+    {
+        return {};
+    }
+    const auto schema = Csv::parseHeader(header);
+    if(!schema.has_value())
+    {
+        return {};
+    }
+    std::optional<std::size_t> rawColumn;
+    for(std::size_t iColumn = 0; iColumn < schema->size(); ++iColumn)
+    {
+        if((*schema)[iColumn].name == "Raw")
+        {
+            rawColumn = iColumn;
+        }
+    }
+    if(!rawColumn.has_value())
+    {
+        return {};
+    }
+    return std::make_unique<CsvSampleSource>(std::move(input), schema->size()
+                                            , Csv::timeColumn(schema.value()), rawColumn.value());
+}
@@ -0,0 +1,21 @@
+#ifndef _PPG_SAMPLE_SOURCE_HPP
+#define _PPG_SAMPLE_SOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+// Streaming reader of device timestamps and raw proximity samples from a recording,
+// either CSV (any of the data/ header layouts) or *.ppgrec
+class SampleSource
+{
+    public:
+        static std::unique_ptr<SampleSource> open(const std::string& path);
+        virtual ~SampleSource() = default;
+        // reads up to timestamps.size() samples, returns number of samples read, 0 at the end
+        virtual std::size_t read(std::span<uint64_t> timestamps, std::span<uint16_t> raw) = 0;
+};
+
+#endif //_PPG_SAMPLE_SOURCE_HPP
@@ -0,0 +1,215 @@
+#ifndef _PPG_STREAM_PARSER_HPP
+#define _PPG_STREAM_PARSER_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+
+#include "ProfileRecord.hpp"
+#include "SpectrumRecord.hpp"
+#include "TraceRecord.hpp"
+
+namespace Collector
+{
+    // one `timestamp,raw,filtered,bpm` line of the device stream
+    struct DeviceSample
+    {
+        uint64_t timestamp; //< us, device clock
+        uint16_t raw;
+        int16_t filtered;
+        uint8_t bpm;
+    };
+
+    // Incremental parser of the device stream, bytes can be fed in any chunks.
+    // Works in fixed buffers, without allocations; spectrum, profile and trace records between the lines are skipped.
+    class StreamParser
+    {
+        public:
+            static constexpr std::size_t MaxLineLength = 64;
+
+            // calls onSample(const DeviceSample&) for every sample line completed by data
+            template <typename SampleF>
+            void feed(std::span<const char> data, SampleF&& onSample)
+            {
+                for(const char c : data)
+                {
+                    const auto byte = static_cast<uint8_t>(c);
+                    if(numSkipBytes_ > 0)
+                    {
+                        numSkipBytes_--;
+                        continue;
+                    }
+                    if(lineLength_ == 0 && !discardLine_ && (numRecordHeaderBytes_ > 0 || isRecordSync(byte)))
+                    {
+                        feedRecordHeader(byte);
+                        continue;
+                    }
+                    if(c != '\n')
+                    {
+                        if(lineLength_ == line_.size())
+                        {
+                            discardLine_ = true;
+                            lineLength_ = 0;
+                        }
+                        if(!discardLine_)
+                        {
+                            line_[lineLength_++] = c;
+                        }
+                        continue;
+                    }
+                    // the first line may be cut, the device streams before the port is opened
+                    if(synced_ && !discardLine_)
+                    {
+                        DeviceSample sample;
+                        if(parseLine({line_.data(), lineLength_}, sample))
+                        {
+                            onSample(sample);
+                        }
+                        else
+                        {
+                            numMalformed_++;
+                        }
+                    }
+                    else if(synced_)
+                    {
+                        numMalformed_++;
+                    }
+                    synced_ = true;
+                    discardLine_ = false;
+                    lineLength_ = 0;
+                }
+            }
+
+            // start over, e.g. after the device was reopened
+            void reset()
+            {
+                lineLength_ = 0;
+                numRecordHeaderBytes_ = 0;
+                numSkipBytes_ = 0;
+                discardLine_ = false;
+                synced_ = false;
+            }
+
+            uint32_t getNumMalformed() const { return numMalformed_; }
+            uint32_t getNumRecords() const { return numRecords_; }
+
+            static bool parseLine(std::string_view line, DeviceSample& sample)
+            {
+                while(!line.empty() && line.back() == '\r')
+                {
+                    line.remove_suffix(1);
+                }
+                const char* first = line.data();
+                const char* const last = line.data() + line.size();
+                uint64_t timestamp = 0;
+                uint32_t raw = 0;
+                int32_t filtered = 0;
+                uint32_t bpm = 0;
+                const bool ok = parseField(first, last, timestamp, ',')
+                                && parseField(first, last, raw, ',')
+                                && parseField(first, last, filtered, ',')
+                                && parseField(first, last, bpm, '\0')
+                                && raw <= std::numeric_limits<uint16_t>::max()
+                                && filtered >= std::numeric_limits<int16_t>::min()
+                                && filtered <= std::numeric_limits<int16_t>::max()
+                                && bpm <= std::numeric_limits<uint8_t>::max();
+                if(ok)
+                {
+                    sample = {timestamp, static_cast<uint16_t>(raw), static_cast<int16_t>(filtered), static_cast<uint8_t>(bpm)};
+                }
+                return ok;
+            }
+        private:
+            // parses one value followed by separator, or by the end of the line for '\0'
+            template <typename T>
+            static bool parseField(const char*& first, const char* const last, T& value, const char separator)
+            {
+                auto [ptr, ec] = std::from_chars(first, last, value);
+                if(ec != std::errc{})
+                {
+                    return false;
+                }
+                if(separator == '\0')
+                {
+                    return ptr == last;
+                }
+                if(ptr == last || *ptr != separator)
+                {
+                    return false;
+                }
+                first = ptr + 1;
+                return true;
+            }
+
+            static bool isRecordSync(const uint8_t byte)
+            {
+                return byte == SpectrumRecord::Sync[0] || byte == ProfileRecord::Sync[0] || byte == TraceRecord::Sync[0];
+            }
+
+            void feedRecordHeader(const uint8_t byte)
+            {
+                recordHeader_[numRecordHeaderBytes_++] = byte;
+                if(numRecordHeaderBytes_ < 2)
+                {
+                    return;
+                }
+                // the second sync byte tells the record type and so the header size
+                const std::array<uint8_t, 2> sync{recordHeader_[0], recordHeader_[1]};
+                std::size_t headerSize = 0;
+                if(sync == SpectrumRecord::Sync) headerSize = sizeof(SpectrumRecord::Header);
+                else if(sync == ProfileRecord::Sync) headerSize = sizeof(ProfileRecord::Header);
+                else if(sync == TraceRecord::Sync) headerSize = sizeof(TraceRecord::Header);
+                if(headerSize == 0)
+                {
+                    numRecordHeaderBytes_ = 0;
+                    numMalformed_++;
+                    return;
+                }
+                if(numRecordHeaderBytes_ < headerSize)
+                {
+                    return;
+                }
+                numRecordHeaderBytes_ = 0;
+                numRecords_++;
+                numSkipBytes_ = recordSize(sync) - headerSize;
+            }
+
+            // size of the whole record, once its header is complete
+            std::size_t recordSize(const std::array<uint8_t, 2>& sync) const
+            {
+                if(sync == ProfileRecord::Sync)
+                {
+                    ProfileRecord::Header header;
+                    std::memcpy(&header, recordHeader_.data(), sizeof(header));
+                    return ProfileRecord::size(header.numSamples);
+                }
+                if(sync == TraceRecord::Sync)
+                {
+                    TraceRecord::Header header;
+                    std::memcpy(&header, recordHeader_.data(), sizeof(header));
+                    return TraceRecord::size(header.numEvents);
+                }
+                SpectrumRecord::Header header;
+                std::memcpy(&header, recordHeader_.data(), sizeof(header));
+                return SpectrumRecord::size(header.numBins);
+            }
+        private:
+            std::array<char, MaxLineLength> line_{};
+            std::size_t lineLength_{};
+            std::array<uint8_t, std::max({sizeof(SpectrumRecord::Header), sizeof(ProfileRecord::Header), sizeof(TraceRecord::Header)})> recordHeader_{};
+            std::size_t numRecordHeaderBytes_{};
+            std::size_t numSkipBytes_{};
+            bool discardLine_{};
+            bool synced_{};
+            uint32_t numMalformed_{};
+            uint32_t numRecords_{};
+    };
+}
+
+#endif //_PPG_STREAM_PARSER_HPP
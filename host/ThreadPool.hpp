@@ -0,0 +1,160 @@
+#ifndef _PPG_THREAD_POOL_HPP
+#define _PPG_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Every worker owns a deque with its own lock: it takes its own tasks from the back and,
+// when empty, steals the oldest task from the front of another worker.
+// Workers with nothing to take or steal park on a condition variable.
+class ThreadPool
+{
+    public:
+        using TaskT = std::function<void()>;
+    public:
+        ThreadPool(const std::size_t numThreads = std::thread::hardware_concurrency())
+            : queues_(numThreads ? numThreads : 1)
+            , iNextQueue_{}
+            , numQueued_{}
+            , numPending_{}
+            , stopping_{}
+        {
+            for(std::size_t iWorker = 0; iWorker < queues_.size(); ++iWorker)
+            {
+                queues_[iWorker] = std::make_unique<WorkerQueue>();
+            }
+            for(std::size_t iWorker = 0; iWorker < queues_.size(); ++iWorker)
+            {
+                workers_.emplace_back([this, iWorker] { work(iWorker); });
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock{mutex_};
+                stopping_ = true;
+            }
+            wakeUp_.notify_all();
+            for(auto& worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(TaskT task)
+        {
+            // pending before the task is visible, so a worker can't take and finish it first
+            numPending_++;
+            auto& queue = *queues_[iNextQueue_++ % queues_.size()];
+            {
+                std::lock_guard lock{queue.mutex};
+                queue.tasks.push_back(std::move(task));
+                numQueued_++;
+            }
+            // a worker between checking numQueued_ and parking holds mutex_, so it can't miss the notification
+            {
+                std::lock_guard lock{mutex_};
+            }
+            wakeUp_.notify_one();
+        }
+
+        // blocks until all submitted tasks are done
+        void wait()
+        {
+            std::unique_lock lock{mutex_};
+            done_.wait(lock, [this] { return numPending_ == 0; });
+        }
+
+        std::size_t size() const
+        {
+            return workers_.size();
+        }
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<TaskT> tasks;
+        };
+
+        std::optional<TaskT> take(const std::size_t iWorker)
+        {
+            {
+                auto& own = *queues_[iWorker];
+                std::lock_guard lock{own.mutex};
+                if(!own.tasks.empty())
+                {
+                    auto task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    numQueued_--;
+                    return task;
+                }
+            }
+            for(std::size_t iOffset = 1; iOffset < queues_.size(); ++iOffset)
+            {
+                auto& victim = *queues_[(iWorker + iOffset) % queues_.size()];
+                std::lock_guard lock{victim.mutex};
+                if(!victim.tasks.empty())
+                {
+                    auto task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    numQueued_--;
+                    return task;
+                }
+            }
+            return {};
+        }
+
+        void work(const std::size_t iWorker)
+        {
+            while(true)
+            {
+                if(auto task = take(iWorker))
+                {
+                    (*task)();
+                    if(--numPending_ == 0)
+                    {
+                        std::lock_guard lock{mutex_};
+                        done_.notify_all();
+                    }
+                    continue;
+                }
+                if(numQueued_ > 0)
+                {
+                    // pushed to a deque already scanned, or stolen by another worker meanwhile
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::unique_lock lock{mutex_};
+                wakeUp_.wait(lock, [this] { return stopping_ || numQueued_ > 0; });
+                if(numQueued_ == 0)
+                {
+                    return; //< stopping and nothing left
+                }
+            }
+        }
+    private:
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> workers_;
+        std::atomic<std::size_t> iNextQueue_;
+        std::atomic<std::size_t> numQueued_;    //< in a deque, changed under the deque lock
+        std::atomic<std::size_t> numPending_;   //< submitted, not finished yet
+        std::mutex mutex_;                      //< only to park workers and waiters
+        std::condition_variable wakeUp_;
+        std::condition_variable done_;
+        bool stopping_;
+};
+
+#endif //_PPG_THREAD_POOL_HPP
@@ -0,0 +1,45 @@
+#ifndef _PPG_TEST_CHECK_HPP
+#define _PPG_TEST_CHECK_HPP
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks of the host tests, every test is an executable run by ctest,
+// failures are printed and the exit code is non-zero
+namespace Test
+{
+    inline int numChecks = 0;
+    inline int numFailed = 0;
+
+    inline bool check(const bool condition, const char* const what)
+    {
+        numChecks++;
+        if(!condition)
+        {
+            numFailed++;
+            std::printf("FAILED: %s\n", what);
+        }
+        return condition;
+    }
+
+    // |actual - expected| <= tolerance
+    inline bool checkNear(const double actual, const double expected, const double tolerance, const char* const what)
+    {
+        numChecks++;
+        if(!(std::abs(actual - expected) <= tolerance))
+        {
+            numFailed++;
+            std::printf("FAILED: %s: %g, expected %g +/- %g\n", what, actual, expected, tolerance);
+            return false;
+        }
+        return true;
+    }
+
+    inline int result()
+    {
+        std::printf("%d checks, %d failed\n", numChecks, numFailed);
+        return numFailed ? 1 : 0;
+    }
+}
+
+#endif //_PPG_TEST_CHECK_HPP
@@ -0,0 +1,112 @@
+#ifndef _PPG_TEST_CMSIS_RFFT_HPP
+#define _PPG_TEST_CMSIS_RFFT_HPP
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <vector>
+
+// CMSIS-DSP side of the real FFT, to check the tables and packing the firmware hands to arm_rfft_fast_f32:
+// the table layouts of arm_common_tables.c and ports of stage_rfft_f32 and merge_rfft_f32 (arm_rfft_fast_f32.c),
+// around a double precision complex DFT in place of arm_cfft_f32
+namespace Test::Cmsis
+{
+    // twiddleCoef_rfft_<Length>: sin, cos of 2*pi*k/Length for k < Length/2
+    inline std::vector<float> rfftTwiddle(const std::size_t length)
+    {
+        std::vector<float> table(length);
+        for(std::size_t k = 0; k < length / 2; ++k)
+        {
+            const double angle = 2.0 * std::numbers::pi * k / length;
+            table[2 * k] = static_cast<float>(std::sin(angle));
+            table[2 * k + 1] = static_cast<float>(std::cos(angle));
+        }
+        return table;
+    }
+
+    // twiddleCoef_<CfftLength>: cos, sin of 2*pi*k/CfftLength for k < 3/4 CfftLength
+    inline std::vector<float> cfftTwiddle(const std::size_t cfftLength)
+    {
+        std::vector<float> table(3 * cfftLength / 2);
+        for(std::size_t k = 0; k < 3 * cfftLength / 4; ++k)
+        {
+            const double angle = 2.0 * std::numbers::pi * k / cfftLength;
+            table[2 * k] = static_cast<float>(std::cos(angle));
+            table[2 * k + 1] = static_cast<float>(std::sin(angle));
+        }
+        return table;
+    }
+
+    // interleaved complex DFT, unscaled forward and 1/n scaled inverse like arm_cfft_f32
+    inline std::vector<float> cfft(std::span<const float> in, const bool inverse)
+    {
+        const std::size_t n = in.size() / 2;
+        const double sign = inverse ? 1.0 : -1.0;
+        std::vector<float> out(in.size());
+        for(std::size_t k = 0; k < n; ++k)
+        {
+            std::complex<double> x{};
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                x += std::complex<double>{in[2 * i], in[2 * i + 1]} * std::polar(1.0, sign * 2.0 * std::numbers::pi * ((k * i) % n) / n);
+            }
+            if(inverse) x /= static_cast<double>(n);
+            out[2 * k] = static_cast<float>(x.real());
+            out[2 * k + 1] = static_cast<float>(x.imag());
+        }
+        return out;
+    }
+
+    // arm_rfft_fast_f32(..., 0): complex FFT of the even/odd samples, then stage_rfft_f32
+    inline std::vector<float> forward(std::span<const float> twiddle, std::span<const float> in)
+    {
+        const auto p = cfft(in, false);
+        const std::size_t fftLen = in.size() / 2;
+        std::vector<float> out(in.size());
+        const float* coeff = twiddle.data();
+        // first and last bin are real, packed together
+        const float t1a = p[0] + p[0];
+        const float t1b = p[1] + p[1];
+        coeff += 2;
+        out[0] = 0.5f * (t1a + t1b);
+        out[1] = 0.5f * (t1a - t1b);
+        for(std::size_t k = 1; k < fftLen; ++k)
+        {
+            const float xAR = p[2 * k], xAI = p[2 * k + 1];
+            const float xBR = p[2 * (fftLen - k)], xBI = p[2 * (fftLen - k) + 1];
+            const float twR = *coeff++;
+            const float twI = *coeff++;
+            const float t1a = xBR - xAR;
+            const float t1b = xBI + xAI;
+            out[2 * k] = 0.5f * (xAR + xBR + twR * t1a + twI * t1b);
+            out[2 * k + 1] = 0.5f * (xAI - xBI + twI * t1a - twR * t1b);
+        }
+        return out;
+    }
+
+    // arm_rfft_fast_f32(..., 1): merge_rfft_f32, then the inverse complex FFT
+    inline std::vector<float> inverse(std::span<const float> twiddle, std::span<const float> in)
+    {
+        const std::size_t fftLen = in.size() / 2;
+        std::vector<float> p(in.size());
+        const float* coeff = twiddle.data() + 2;
+        p[0] = 0.5f * (in[0] + in[1]);
+        p[1] = 0.5f * (in[0] - in[1]);
+        for(std::size_t k = 1; k < fftLen; ++k)
+        {
+            const float xAR = in[2 * k], xAI = in[2 * k + 1];
+            const float xBR = in[2 * (fftLen - k)], xBI = in[2 * (fftLen - k) + 1];
+            const float twR = *coeff++;
+            const float twI = *coeff++;
+            const float t1a = xAR - xBR;
+            const float t1b = xAI + xBI;
+            p[2 * k] = 0.5f * (xAR + xBR - twR * t1a - twI * t1b);
+            p[2 * k + 1] = 0.5f * (xAI - xBI + twI * t1a - twR * t1b);
+        }
+        return cfft(p, true);
+    }
+}
+
+#endif //_PPG_TEST_CMSIS_RFFT_HPP
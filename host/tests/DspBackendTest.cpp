@@ -0,0 +1,233 @@
+// Checks the host DSP backend against double precision references: the real FFT and its CMSIS output packing
+// against a direct DFT, the squared magnitude against the scalar formula (SIMD body and tail),
+// and the biquad cascade against a direct form II transposed filter, in blocks and per sample.
+// The inverse real FFT, used by the harmonic heart rate estimator, against the forward one (round trip).
+// Against the CMSIS-DSP backend: the real FFT against arm_rfft_fast_f32 with the CMSIS twiddle table
+// (tests/CmsisRfft.hpp), and the biquad cascade against the float loop of arm_biquad_cascade_df2T_f32.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "Check.hpp"
+#include "CmsisRfft.hpp"
+#include "DspBackend.hpp"
+#include "Fft.hpp"
+#include "IIRFilter.hpp"
+#include "PpgFilter.hpp"
+
+namespace
+{
+    template <uint16_t Length>
+    void testRealFft(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist{-1000.0f, 1000.0f};
+        std::array<float32_t, Length> input{};
+        std::generate(input.begin(), input.end(), [&] { return dist(rng); });
+        std::array<float32_t, Length> inputCopy{input};
+        std::array<float32_t, Length> output{};
+        Dsp::Backend::RealFft<Length> fft;
+        fft.forward(inputCopy.data(), output.data());
+
+        // packed {X[0].re, X[N/2].re, X[1].re, X[1].im, ..., X[N/2-1].re, X[N/2-1].im}
+        double maxError = 0.0, maxMagnitude = 0.0;
+        for(size_t k = 0; k <= Length / 2; ++k)
+        {
+            std::complex<double> x{};
+            for(size_t n = 0; n < Length; ++n)
+            {
+                x += static_cast<double>(input[n]) * std::polar(1.0, -2.0 * std::numbers::pi * k * n / Length);
+            }
+            std::complex<double> packed;
+            if(k == 0) packed = {output[0], 0.0};
+            else if(k == Length / 2) packed = {output[1], 0.0};
+            else packed = {output[2 * k], output[2 * k + 1]};
+            maxError = std::max(maxError, std::abs(packed - x));
+            maxMagnitude = std::max(maxMagnitude, std::abs(x));
+        }
+        Test::checkNear(maxError / maxMagnitude, 0.0, 1e-5, Length == 256 ? "rfft 256 vs DFT" : "rfft 1024 vs DFT");
+    }
+
+    // inverse(transform(x)) == x, through the Dsp::Fft interface the estimator uses
+    template <uint16_t Length>
+    void testRoundTrip(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist{-1000.0f, 1000.0f};
+        typename Dsp::Fft<Length>::InputT input{};
+        std::generate(input.begin(), input.end(), [&] { return dist(rng); });
+        Dsp::Fft<Length> fft;
+        const auto output = fft.inverse(fft.transform(input));
+        double maxError = 0.0;
+        for(size_t i = 0; i < Length; ++i)
+        {
+            maxError = std::max(maxError, static_cast<double>(std::abs(output[i] - input[i])));
+        }
+        Test::checkNear(maxError / 1000.0, 0.0, 1e-5, Length == 256 ? "rfft 256 forward/inverse round trip" : "rfft 1024 forward/inverse round trip");
+    }
+
+    // same packing and values as the CMSIS backend, forward and inverse
+    template <uint16_t Length>
+    void testCmsisRealFft(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist{-1000.0f, 1000.0f};
+        std::vector<float32_t> input(Length);
+        std::generate(input.begin(), input.end(), [&] { return dist(rng); });
+        const auto twiddle = Test::Cmsis::rfftTwiddle(Length);
+        const auto expected = Test::Cmsis::forward(twiddle, input);
+
+        Dsp::Backend::RealFft<Length> fft;
+        std::vector<float32_t> inputCopy{input};
+        std::vector<float32_t> output(Length);
+        fft.forward(inputCopy.data(), output.data());
+        double maxError = 0.0, maxMagnitude = 0.0;
+        for(size_t i = 0; i < Length; ++i)
+        {
+            maxError = std::max(maxError, static_cast<double>(std::abs(output[i] - expected[i])));
+            maxMagnitude = std::max(maxMagnitude, static_cast<double>(std::abs(expected[i])));
+        }
+        Test::checkNear(maxError / maxMagnitude, 0.0, 1e-5, Length == 256 ? "rfft 256 vs arm_rfft_fast_f32" : "rfft 1024 vs arm_rfft_fast_f32");
+
+        const auto expectedInverse = Test::Cmsis::inverse(twiddle, expected);
+        std::vector<float32_t> spectrum{expected.begin(), expected.end()};
+        std::vector<float32_t> inverse(Length);
+        fft.inverse(spectrum.data(), inverse.data());
+        double maxInverseError = 0.0;
+        for(size_t i = 0; i < Length; ++i)
+        {
+            maxInverseError = std::max(maxInverseError, static_cast<double>(std::abs(inverse[i] - expectedInverse[i])));
+        }
+        Test::checkNear(maxInverseError / 1000.0, 0.0, 1e-5
+                        , Length == 256 ? "inverse rfft 256 vs arm_rfft_fast_f32" : "inverse rfft 1024 vs arm_rfft_fast_f32");
+    }
+
+    void testCmplxMagSquared(std::mt19937& rng)
+    {
+        // odd count, so the AVX2, SSE2 and scalar loops all run
+        static constexpr uint32_t NumSamples = 8 + 4 + 3;
+        std::uniform_real_distribution<float> dist{-100.0f, 100.0f};
+        std::array<float32_t, 2 * NumSamples> in{};
+        std::generate(in.begin(), in.end(), [&] { return dist(rng); });
+        std::array<float32_t, NumSamples> out{};
+        Dsp::Backend::cmplxMagSquared(in.data(), out.data(), NumSamples);
+        double maxError = 0.0;
+        for(uint32_t i = 0; i < NumSamples; ++i)
+        {
+            const double expected = static_cast<double>(in[2 * i]) * in[2 * i] + static_cast<double>(in[2 * i + 1]) * in[2 * i + 1];
+            maxError = std::max(maxError, std::abs(out[i] - expected) / std::max(expected, 1.0));
+        }
+        Test::checkNear(maxError, 0.0, 1e-6, "cmplxMagSquared vs scalar");
+    }
+
+    // y = b0 x + d1, d1 = b1 x + a1 y + d2, d2 = b2 x + a2 y, a1 and a2 negated like CMSIS
+    std::vector<double> referenceDf2t(std::span<const float32_t> coeffs, std::span<const float32_t> input)
+    {
+        std::vector<double> signal(input.begin(), input.end());
+        for(size_t iSection = 0; iSection < coeffs.size() / 5; ++iSection)
+        {
+            const auto* c = coeffs.data() + 5 * iSection;
+            double d1 = 0.0, d2 = 0.0;
+            for(auto& x : signal)
+            {
+                const double y = c[0] * x + d1;
+                d1 = c[1] * x + c[3] * y + d2;
+                d2 = c[2] * x + c[4] * y;
+                x = y;
+            }
+        }
+        return signal;
+    }
+
+    // float loop of arm_biquad_cascade_df2T_f32 (scalar build), same operation order
+    void cmsisDf2t(std::span<const float32_t> coeffs, std::span<float32_t> states, std::span<const float32_t> in, std::span<float32_t> out)
+    {
+        const float32_t* sectionIn = in.data();
+        for(size_t iSection = 0; iSection < coeffs.size() / 5; ++iSection)
+        {
+            const float32_t* c = coeffs.data() + 5 * iSection;
+            float32_t d1 = states[2 * iSection], d2 = states[2 * iSection + 1];
+            for(size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                const float32_t xn = sectionIn[iSample];
+                const float32_t acc = c[0] * xn + d1;
+                d1 = c[1] * xn + d2;
+                d1 += c[3] * acc;
+                d2 = c[2] * xn;
+                d2 += c[4] * acc;
+                out[iSample] = acc;
+            }
+            states[2 * iSection] = d1;
+            states[2 * iSection + 1] = d2;
+            sectionIn = out.data();
+        }
+    }
+
+    void testBiquad(std::mt19937& rng)
+    {
+        // two sections: the PPG bandpass followed by a lowpass
+        static constexpr std::array<float32_t, 10> Coeffs{
+            0.13672873f, 0.0f, -0.13672873f, 1.705965f, -0.72654253f,
+            0.0674553f, 0.1349105f, 0.0674553f, 1.1429805f, -0.4128016f,
+        };
+        static constexpr size_t NumSamples = 1000;
+        static constexpr size_t BlockSize = 7; //< doesn't divide the length, the last block is partial
+        std::uniform_real_distribution<float> dist{-500.0f, 500.0f};
+        std::vector<float32_t> input(NumSamples);
+        std::generate(input.begin(), input.end(), [&] { return dist(rng); });
+        const auto expected = referenceDf2t(Coeffs, input);
+
+        std::array<float32_t, 4> states{};
+        Dsp::Backend::BiquadCascade cascade{2, states.data(), Coeffs.data()};
+        std::vector<float32_t> blockOut(NumSamples);
+        for(size_t iSample = 0; iSample < NumSamples; iSample += BlockSize)
+        {
+            const auto blockSize = static_cast<uint32_t>(std::min(BlockSize, NumSamples - iSample));
+            cascade.process(input.data() + iSample, blockOut.data() + iSample, blockSize);
+        }
+        Dsp::IIRFilter<4> filter{Coeffs};
+        std::vector<float32_t> sampleOut(NumSamples);
+        std::transform(input.begin(), input.end(), sampleOut.begin(), [&](const float32_t x) { return filter.process(x); });
+
+        double maxBlockError = 0.0, maxSampleError = 0.0, maxOutput = 0.0;
+        for(size_t iSample = 0; iSample < NumSamples; ++iSample)
+        {
+            maxBlockError = std::max(maxBlockError, std::abs(blockOut[iSample] - expected[iSample]));
+            maxSampleError = std::max(maxSampleError, std::abs(sampleOut[iSample] - expected[iSample]));
+            maxOutput = std::max(maxOutput, std::abs(expected[iSample]));
+        }
+        Test::checkNear(maxBlockError / maxOutput, 0.0, 1e-5, "biquad cascade blocks vs DF2T");
+        Test::checkNear(maxSampleError / maxOutput, 0.0, 1e-5, "IIRFilter per sample vs DF2T");
+
+        std::array<float32_t, 4> cmsisStates{};
+        std::vector<float32_t> cmsisOut(NumSamples);
+        for(size_t iSample = 0; iSample < NumSamples; iSample += BlockSize)
+        {
+            const auto blockSize = std::min(BlockSize, NumSamples - iSample);
+            cmsisDf2t(Coeffs, cmsisStates, std::span{input}.subspan(iSample, blockSize), std::span{cmsisOut}.subspan(iSample, blockSize));
+        }
+        double maxCmsisError = 0.0;
+        for(size_t iSample = 0; iSample < NumSamples; ++iSample)
+        {
+            maxCmsisError = std::max(maxCmsisError, static_cast<double>(std::abs(blockOut[iSample] - cmsisOut[iSample])));
+        }
+        Test::checkNear(maxCmsisError / maxOutput, 0.0, 1e-6, "biquad cascade blocks vs arm_biquad_cascade_df2T_f32");
+    }
+}
+
+int main()
+{
+    std::mt19937 rng{1};
+    testRealFft<256>(rng);
+    testRealFft<1024>(rng);
+    testRoundTrip<256>(rng);
+    testRoundTrip<1024>(rng);
+    testCmsisRealFft<256>(rng);
+    testCmsisRealFft<1024>(rng);
+    testCmplxMagSquared(rng);
+    testBiquad(rng);
+    return Test::result();
+}
@@ -0,0 +1,93 @@
+// Checks the compile time FFT tables against the CMSIS-DSP tables they replace, for every real FFT length
+// CMSIS-DSP supports (32 .. 4096): the twiddleCoef_rfft_<N> and twiddleCoef_<N/2> layouts, and the real FFT
+// of arm_rfft_fast_f32 (ported split stages) with the generated tables against a direct DFT.
+// The bit reversal tables aren't generated, the firmware takes armBitRevIndexTable<N/2> from CMSIS-DSP.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "Check.hpp"
+#include "CmsisRfft.hpp"
+#include "FftTables.hpp"
+
+namespace
+{
+    // first entries of twiddleCoef_rfft_32 in arm_common_tables.c
+    static constexpr std::array<float, 8> CmsisRfftTwiddle32{
+        0.000000000f, 1.000000000f, 0.195090322f, 0.980785280f,
+        0.382683432f, 0.923879533f, 0.555570233f, 0.831469612f,
+    };
+
+    double maxDifference(std::span<const float> table, std::span<const float> expected)
+    {
+        double maxError = 0.0;
+        for(std::size_t i = 0; i < table.size(); ++i)
+        {
+            maxError = std::max(maxError, std::abs(static_cast<double>(table[i]) - expected[i]));
+        }
+        return maxError;
+    }
+
+    template <uint16_t Length>
+    void testTables(std::mt19937& rng)
+    {
+        using Tables = Dsp::FftTables<Length>;
+        char what[96];
+
+        // a float step of values below 1
+        std::snprintf(what, sizeof(what), "rfft %u twiddles vs twiddleCoef_rfft_%u", Length, Length);
+        Test::checkNear(maxDifference(Tables::rfftTwiddle, Test::Cmsis::rfftTwiddle(Length)), 0.0, 6e-8, what);
+        std::snprintf(what, sizeof(what), "rfft %u cfft twiddles vs twiddleCoef_%u", Length, Length / 2);
+        Test::checkNear(maxDifference(Tables::cfftTwiddle, Test::Cmsis::cfftTwiddle(Length / 2)), 0.0, 6e-8, what);
+
+        // arm_rfft_fast_f32 with the generated twiddles, against a DFT of the real input
+        std::uniform_real_distribution<float> dist{-1000.0f, 1000.0f};
+        std::vector<float> input(Length);
+        std::generate(input.begin(), input.end(), [&] { return dist(rng); });
+        const auto output = Test::Cmsis::forward(Tables::rfftTwiddle, input);
+        double maxError = 0.0, maxMagnitude = 0.0;
+        for(std::size_t k = 0; k <= Length / 2; ++k)
+        {
+            std::complex<double> x{};
+            for(std::size_t n = 0; n < Length; ++n)
+            {
+                x += static_cast<double>(input[n]) * std::polar(1.0, -2.0 * std::numbers::pi * ((k * n) % Length) / Length);
+            }
+            std::complex<double> packed;
+            if(k == 0) packed = {output[0], 0.0};
+            else if(k == Length / 2) packed = {output[1], 0.0};
+            else packed = {output[2 * k], output[2 * k + 1]};
+            maxError = std::max(maxError, std::abs(packed - x));
+            maxMagnitude = std::max(maxMagnitude, std::abs(x));
+        }
+        std::snprintf(what, sizeof(what), "arm_rfft_fast_f32 %u with generated twiddles vs DFT", Length);
+        Test::checkNear(maxError / maxMagnitude, 0.0, 1e-5, what);
+
+        const auto roundTrip = Test::Cmsis::inverse(Tables::rfftTwiddle, output);
+        std::snprintf(what, sizeof(what), "inverse arm_rfft_fast_f32 %u with generated twiddles", Length);
+        Test::checkNear(maxDifference(roundTrip, input) / 1000.0, 0.0, 1e-5, what);
+    }
+}
+
+int main()
+{
+    Test::check(std::equal(CmsisRfftTwiddle32.begin(), CmsisRfftTwiddle32.end(), Dsp::FftTables<32>::rfftTwiddle.begin()
+                            , [](const float a, const float b) { return std::abs(a - b) < 1e-8f; })
+                , "rfft 32 twiddles vs twiddleCoef_rfft_32 entries");
+    std::mt19937 rng{1};
+    testTables<32>(rng);
+    testTables<64>(rng);
+    testTables<128>(rng);
+    testTables<256>(rng);
+    testTables<512>(rng);
+    testTables<1024>(rng);
+    testTables<2048>(rng);
+    testTables<4096>(rng);
+    return Test::result();
+}
@@ -0,0 +1,61 @@
+// Checks the heart rate estimators on synthetic pulses whose second harmonic is stronger than the fundamental,
+// the case the harmonic estimator is for: the argmax estimator reports twice the rate, the harmonic one the rate
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <random>
+
+#include "Check.hpp"
+#include "Fft.hpp"
+#include "HrEstimator.hpp"
+
+namespace
+{
+    static constexpr size_t FftLength = 1024;
+    static constexpr uint32_t SampleRate = 50;
+    static constexpr size_t NumFrameSamples = 400; //< 8 s, zero padded to FftLength
+    // one FFT bin
+    static constexpr double BinBpm = 60.0 * SampleRate / FftLength;
+
+    // fundamental, second harmonic of 4 times its power and a weak third, with noise;
+    // the fundamental has to stay above MinRelativePeak of the largest peak to be a candidate
+    Dsp::Fft<FftLength>::MagnitudeT pulseSpectrum(const double bpm, std::mt19937& rng)
+    {
+        std::normal_distribution<float> noise{0.0f, 0.1f};
+        Dsp::Fft<FftLength>::InputT frame{};
+        const double f = bpm / 60.0;
+        for(size_t n = 0; n < NumFrameSamples; ++n)
+        {
+            const double t = static_cast<double>(n) / SampleRate;
+            frame[n] = static_cast<float32_t>(std::sin(2.0 * std::numbers::pi * f * t)
+                                            + 2.0 * std::sin(2.0 * std::numbers::pi * 2.0 * f * t + 0.5)
+                                            + 0.3 * std::sin(2.0 * std::numbers::pi * 3.0 * f * t + 1.0))
+                        + noise(rng);
+        }
+        Dsp::Fft<FftLength> fft;
+        return fft.getMagnitudeSqr(frame);
+    }
+
+    void testPulse(const double bpm, std::mt19937& rng)
+    {
+        const auto power = pulseSpectrum(bpm, rng);
+        Processor::HarmonicHrEstimator<FftLength> harmonic;
+        Processor::ArgmaxHrEstimator<FftLength> argmax;
+        char what[96];
+        std::snprintf(what, sizeof(what), "harmonic estimator at %.0f BPM", bpm);
+        Test::checkNear(harmonic.estimate(power, SampleRate), bpm, BinBpm + 1.0, what);
+        std::snprintf(what, sizeof(what), "argmax estimator at %.0f BPM locks to the second harmonic", bpm);
+        Test::checkNear(argmax.estimate(power, SampleRate), 2.0 * bpm, BinBpm + 1.0, what);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng{1};
+    testPulse(55.0, rng);
+    testPulse(72.0, rng);
+    testPulse(100.0, rng);
+    return Test::result();
+}
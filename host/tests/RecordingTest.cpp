@@ -0,0 +1,93 @@
+// Checks that Recording::Reader reads back what Writer wrote, and rejects files whose header sizes
+// would point outside the file, including sizes chosen so that the unchecked offset + count * width wraps around
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "Recording.hpp"
+
+namespace
+{
+    static constexpr std::size_t NumSamples = 1000;
+    static constexpr uint32_t ChunkSamples = 256;
+
+    std::vector<char> readFile(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+    // writes a copy of the file with the header changed, and tries to open it
+    bool opensWith(const std::vector<char>& file, const std::string& path
+                , const std::function<void(Recording::FileHeader&, std::vector<char>&)>& change)
+    {
+        auto crafted = file;
+        Recording::FileHeader header{};
+        std::memcpy(&header, crafted.data(), sizeof(header));
+        change(header, crafted);
+        std::memcpy(crafted.data(), &header, sizeof(header));
+        std::ofstream{path, std::ios::binary}.write(crafted.data(), crafted.size());
+        return Recording::Reader::open(path).has_value();
+    }
+}
+
+int main()
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto path = (dir / "ppg_test_recording.ppgrec").string();
+    const auto craftedPath = (dir / "ppg_test_recording_crafted.ppgrec").string();
+
+    Recording::Writer writer{{{"Timestamp", Recording::ColumnType::U64}, {"Raw", Recording::ColumnType::U16}}, 0, ChunkSamples};
+    for(std::size_t iSample = 0; iSample < NumSamples; ++iSample)
+    {
+        const double row[]{20000.0 * iSample, static_cast<double>(iSample % 4096)};
+        writer.append(row);
+    }
+    Test::check(writer.write(path, 50.0f), "recording is written");
+    {
+        const auto reader = Recording::Reader::open(path);
+        Test::check(reader.has_value(), "written recording opens");
+        if(reader)
+        {
+            const auto raw = reader->column<uint16_t>("Raw");
+            Test::check(raw.has_value() && raw->size() == NumSamples && (*raw)[NumSamples - 1] == (NumSamples - 1) % 4096
+                        , "column reads back");
+            Test::check(reader->seek(20000 * 600) == 600, "seek finds the sample of a timestamp");
+        }
+    }
+
+    const auto file = readFile(path);
+    Test::check(opensWith(file, craftedPath, [](Recording::FileHeader&, std::vector<char>&) { })
+                , "unchanged copy opens");
+    // 2^60 entries of 16 bytes wrap the chunk index size to 0
+    Test::check(!opensWith(file, craftedPath, [](Recording::FileHeader& header, std::vector<char>&) {
+                    header.numChunks = uint64_t{1} << 60;
+                }), "chunk index size wrapping around is rejected");
+    // offset + one entry wraps to 0
+    Test::check(!opensWith(file, craftedPath, [](Recording::FileHeader& header, std::vector<char>&) {
+                    header.chunkIndexOffset = ~uint64_t{0} - 15;
+                    header.numChunks = 1;
+                }), "chunk index offset past the end is rejected");
+    // 2^63 samples of 2 or 8 bytes wrap the column sizes to 0
+    Test::check(!opensWith(file, craftedPath, [](Recording::FileHeader& header, std::vector<char>&) {
+                    header.numSamples = uint64_t{1} << 63;
+                }), "column size wrapping around is rejected");
+    Test::check(!opensWith(file, craftedPath, [](Recording::FileHeader& header, std::vector<char>& crafted) {
+                    Recording::ChunkIndexEntry entry{};
+                    std::memcpy(&entry, crafted.data() + header.chunkIndexOffset, sizeof(entry));
+                    entry.firstSample = header.numSamples;
+                    std::memcpy(crafted.data() + header.chunkIndexOffset, &entry, sizeof(entry));
+                }), "chunk starting past the last sample is rejected");
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(craftedPath);
+    return Test::result();
+}
@@ -0,0 +1,162 @@
+// Checks the running statistics against brute force over the window, on random streams
+// many windows long, so every ring buffer wrap and once per window resync is crossed
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <numeric>
+#include <random>
+
+#include "Check.hpp"
+#include "MovingAverageFilter.hpp"
+#include "MovingMinMax.hpp"
+#include "MovingVariance.hpp"
+
+namespace
+{
+    static constexpr size_t NumStreamSamples = 10000;
+
+    // last NumSamples samples, the window starts zero filled like the moving average
+    template <typename SampleT>
+    class Window
+    {
+        public:
+            Window(const size_t numSamples, const bool zeroFilled)
+                : numSamples_{numSamples}
+                , samples_(zeroFilled ? numSamples : 0, SampleT{})
+            { }
+
+            void push(const SampleT& sample)
+            {
+                samples_.push_back(sample);
+                if(samples_.size() > numSamples_)
+                {
+                    samples_.pop_front();
+                }
+            }
+
+            const std::deque<SampleT>& samples() const { return samples_; }
+        private:
+            size_t numSamples_;
+            std::deque<SampleT> samples_;
+    };
+
+    void testAverageFloat(std::mt19937& rng)
+    {
+        static constexpr size_t N = 8;
+        std::uniform_real_distribution<float> dist{-1000.0f, 1000.0f};
+        Dsp::MovingAverageFilter<N, float> filter;
+        Window<float> window{N, true};
+        double maxError = 0.0;
+        for(size_t iSample = 0; iSample < NumStreamSamples; ++iSample)
+        {
+            const auto sample = dist(rng);
+            window.push(sample);
+            const auto expected = std::accumulate(window.samples().begin(), window.samples().end(), 0.0) / N;
+            maxError = std::max(maxError, std::abs(filter.process(sample) - expected));
+        }
+        Test::checkNear(maxError, 0.0, 1e-3, "float moving average vs brute force");
+    }
+
+    // power of 2 length, the average is a shift of the 64-bit sum
+    void testAverageUint16(std::mt19937& rng)
+    {
+        static constexpr size_t N = 16;
+        std::uniform_int_distribution<uint32_t> dist{0, UINT16_MAX};
+        Dsp::MovingAverageFilter<N, uint16_t> filter;
+        Window<uint16_t> window{N, true};
+        size_t numMismatches = 0;
+        for(size_t iSample = 0; iSample < NumStreamSamples; ++iSample)
+        {
+            const auto sample = static_cast<uint16_t>(dist(rng));
+            window.push(sample);
+            const auto sum = std::accumulate(window.samples().begin(), window.samples().end(), int64_t{});
+            numMismatches += filter.process(sample) != static_cast<uint16_t>(sum / N);
+        }
+        Test::check(numMismatches == 0, "uint16_t moving average vs brute force");
+    }
+
+    // other lengths divide, negative sums round towards 0 like the integer division
+    void testAverageInt16(std::mt19937& rng)
+    {
+        static constexpr size_t N = 10;
+        std::uniform_int_distribution<int32_t> dist{INT16_MIN, INT16_MAX};
+        Dsp::MovingAverageFilter<N, int16_t> filter;
+        Window<int16_t> window{N, true};
+        size_t numMismatches = 0;
+        for(size_t iSample = 0; iSample < NumStreamSamples; ++iSample)
+        {
+            const auto sample = static_cast<int16_t>(dist(rng));
+            window.push(sample);
+            const auto sum = std::accumulate(window.samples().begin(), window.samples().end(), int64_t{});
+            numMismatches += filter.process(sample) != static_cast<int16_t>(sum / static_cast<int64_t>(N));
+        }
+        Test::check(numMismatches == 0, "int16_t moving average vs brute force");
+
+        Dsp::MovingAverageFilter<N, int16_t> primed;
+        Test::check(primed.prime(-1234) == -1234 && primed.process(-1234) == -1234, "primed moving average is steady");
+    }
+
+    // large DC offset with small variation, the case where the add/remove update drifts
+    void testVariance(std::mt19937& rng)
+    {
+        static constexpr size_t N = 16;
+        std::normal_distribution<float> dist{20000.0f, 30.0f};
+        Dsp::MovingVariance<N, float> stat;
+        Window<float> window{N, false};
+        double maxMeanError = 0.0, maxVarianceError = 0.0;
+        for(size_t iSample = 0; iSample < NumStreamSamples; ++iSample)
+        {
+            const auto sample = dist(rng);
+            window.push(sample);
+            stat.push(sample);
+            const auto& samples = window.samples();
+            const auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+            double m2 = 0.0;
+            for(const auto s : samples)
+            {
+                m2 += (s - mean) * (s - mean);
+            }
+            maxMeanError = std::max(maxMeanError, std::abs(stat.mean() - mean));
+            maxVarianceError = std::max(maxVarianceError, std::abs(stat.variance() - m2 / samples.size()));
+        }
+        Test::check(stat.size() == N, "moving variance window size");
+        // a few float steps at the DC level, and well below the variance of the stream, 900
+        Test::checkNear(maxMeanError, 0.0, 0.05, "moving mean vs brute force");
+        Test::checkNear(maxVarianceError, 0.0, 3.0, "moving variance vs brute force");
+    }
+
+    // small value range, so ties are frequent
+    void testMinMax(std::mt19937& rng)
+    {
+        static constexpr size_t N = 7;
+        std::uniform_int_distribution<int> dist{-20, 20};
+        Dsp::MovingMinMax<N, int> stat;
+        Window<int> window{N, false};
+        size_t numMismatches = 0;
+        for(size_t iSample = 0; iSample < NumStreamSamples; ++iSample)
+        {
+            // monotonic runs every few windows, the deques are full or hold one sample
+            int sample = dist(rng);
+            if((iSample / (3 * N)) % 4 == 1) sample = static_cast<int>(iSample % 1000);
+            if((iSample / (3 * N)) % 4 == 2) sample = -static_cast<int>(iSample % 1000);
+            window.push(sample);
+            stat.push(sample);
+            const auto [minIt, maxIt] = std::minmax_element(window.samples().begin(), window.samples().end());
+            numMismatches += stat.min() != *minIt || stat.max() != *maxIt || stat.size() != window.samples().size();
+        }
+        Test::check(numMismatches == 0, "moving min/max vs brute force");
+    }
+}
+
+int main()
+{
+    std::mt19937 rng{1};
+    testAverageFloat(rng);
+    testAverageUint16(rng);
+    testAverageInt16(rng);
+    testVariance(rng);
+    testMinMax(rng);
+    return Test::result();
+}
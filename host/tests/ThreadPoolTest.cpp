@@ -0,0 +1,56 @@
+// Checks that ThreadPool::wait returns only after every task submitted before it is done,
+// with tasks submitted from several threads at once and from running tasks,
+// and that idle workers park instead of spinning while a long task runs
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "Check.hpp"
+#include "ThreadPool.hpp"
+
+int main()
+{
+    static constexpr std::size_t NumRounds = 200;
+    static constexpr std::size_t NumSubmitters = 4;
+    static constexpr std::size_t NumTasks = 50;
+    ThreadPool pool{4};
+    std::size_t numEarlyWaits = 0;
+    for(std::size_t iRound = 0; iRound < NumRounds; ++iRound)
+    {
+        std::atomic<std::size_t> numDone{};
+        std::vector<std::thread> submitters;
+        for(std::size_t iSubmitter = 0; iSubmitter < NumSubmitters; ++iSubmitter)
+        {
+            submitters.emplace_back([&pool, &numDone] {
+                for(std::size_t iTask = 0; iTask < NumTasks; ++iTask)
+                {
+                    pool.submit([&pool, &numDone] {
+                        // nested task, submitted before this one finishes
+                        pool.submit([&numDone] { numDone++; });
+                        numDone++;
+                    });
+                }
+            });
+        }
+        for(auto& submitter : submitters)
+        {
+            submitter.join();
+        }
+        pool.wait();
+        numEarlyWaits += numDone != 2 * NumSubmitters * NumTasks;
+    }
+    Test::check(numEarlyWaits == 0, "wait returns after every submitted task is done");
+
+    // one sleeping task, the other workers have nothing to take or steal
+    static constexpr auto TaskDuration = std::chrono::milliseconds{300};
+    const std::clock_t cpuStart = std::clock();
+    pool.submit([] { std::this_thread::sleep_for(TaskDuration); });
+    pool.wait();
+    const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    Test::check(cpuSeconds < 0.1, "idle workers don't burn cpu time while a task runs");
+    return Test::result();
+}
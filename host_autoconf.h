@@ -0,0 +1,8 @@
+/* Kconfig defaults of the firmware for the host tools, generated by scripts/host_autoconf.py */
+#define CONFIG_PPG_FILTER_BLOCK_SIZE 5
+#define CONFIG_PPG_FILTER_MAX_LATENCY_MS 200
+#define CONFIG_PPG_RESAMPLING 1
+#define CONFIG_PPG_RESAMPLER_MAX_GAP_MS 1000
+#define CONFIG_PPG_DEADLINE_BUDGET_PERCENT 100
+#define CONFIG_PPG_DEADLINE_RECOVERY_PERIODS 250
+#define CONFIG_PPG_HR_HARMONIC_ESTIMATOR 1
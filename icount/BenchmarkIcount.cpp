@@ -0,0 +1,258 @@
+// Counts the instructions retired by the PPG processing kernels under QEMU, see scripts/icount_gate.py
+//
+// QEMU in icount mode advances the virtual clock by 2^shift ns per instruction, and the system timer
+// runs from the virtual clock, so the time a kernel takes is its instruction count.
+// Prints one line per kernel, `ICOUNT <kernel> <instructions per call>`, then `ICOUNT DONE`.
+// With CONFIG_PPG_PROFILER, the kernels then run in a loop under the PC sampling profiler and
+// the profile records are written to the console, then `PROFILE DONE`, see scripts/pc_profile.py.
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <span>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#if defined(CONFIG_PPG_PROFILER)
+#include <zephyr/drivers/uart.h>
+#endif
+
+#include "Benchmark.hpp"
+#include "Fft.hpp"
+#include "HrProcessor.hpp"
+#include "IIRFilter.hpp"
+#include "PpgFilter.hpp"
+#include "PpgMeasurement.hpp"
+#include "Resampler.hpp"
+#if defined(CONFIG_PPG_PROFILER)
+#include "PcSampler.hpp"
+#include "ProfileRecord.hpp"
+#endif
+
+namespace
+{
+    // system timer, driven by the QEMU virtual clock
+    class SysClockCounter
+        : public Benchmark::ICycleCounter<
+            uint32_t
+            , CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC
+        >
+    {
+        public:
+            time_point now() noexcept override
+            {
+                return time_point{ duration{ k_cycle_get_32() } };
+            }
+    };
+
+    template <typename DurationT>
+    void report(const char* const kernel, const DurationT& duration, const uint32_t numCalls = 1)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        const auto instructions = static_cast<uint32_t>((ns >> CONFIG_QEMU_ICOUNT_SHIFT) / numCalls);
+        printk("ICOUNT %s %u\n", kernel, instructions);
+    }
+
+    static constexpr size_t NumSamples = 1024;
+    static constexpr uint16_t SampleRate = 50;
+    using InputT = std::array<float32_t, NumSamples>;
+
+    // 72 BPM pulse with its second harmonic, at the level of the filtered PPG signal
+    InputT makeInput()
+    {
+        InputT input{};
+        for(size_t iSample = 0; iSample < input.size(); ++iSample)
+        {
+            const float32_t t = static_cast<float32_t>(iSample) / SampleRate;
+            input[iSample] = 300.0f * std::sin(2.0f * std::numbers::pi_v<float32_t> * 1.2f * t)
+                            + 80.0f * std::sin(2.0f * std::numbers::pi_v<float32_t> * 2.4f * t + 0.5f);
+        }
+        return input;
+    }
+
+    // the kernels, state persists between calls so they can run repeatedly
+    namespace Kernels
+    {
+        static constexpr size_t BlockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+        static constexpr uint32_t NumLines = 64;
+        // one frame of the high resolution profile, after the history is full
+        static constexpr size_t HrFrameSamples = 100;
+        static constexpr size_t HrHistorySamples = 200;
+
+        Dsp::Fft<NumSamples> fft;
+        // sig.butter(1, [0.5, 3], btype='bandpass', fs=50, output='sos')
+        Dsp::IIRFilter<2> sampleFilter{Processor::PpgFilterCoeffs<SampleRate>::value};
+        auto blockFilter = Processor::makePpgFilter<SampleRate>();
+        Processor::HeartRate<HrFrameSamples, HrHistorySamples, 1024> hr{SampleRate};
+        Processor::HeartRate<HrFrameSamples, HrHistorySamples, 1024, Processor::HarmonicHrEstimator<1024>> hrHarmonic{SampleRate};
+        Processor::PpgMeasurement measurement{};
+        size_t iHrSample = 0;
+        Dsp::Resampler<Dsp::Interpolation::Linear> resampler{SampleRate, std::chrono::milliseconds(1000)};
+        uint64_t numResamplerInputs = 0;
+        size_t numResampled = 0;
+        InputT output{};
+        char line[64]{};
+
+        auto fftTransform(const InputT& in)
+        {
+            return fft.transform(in);
+        }
+
+        void biquadSample(const InputT& in)
+        {
+            for(size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                output[iSample] = sampleFilter(in[iSample]);
+            }
+        }
+
+        void biquadBlock(const InputT& in)
+        {
+            for(size_t iSample = 0; iSample + BlockSize <= in.size(); iSample += BlockSize)
+            {
+                blockFilter.process(std::span<const float32_t>{in.data() + iSample, BlockSize}
+                                , std::span<float32_t>{output.data() + iSample, BlockSize});
+            }
+        }
+
+        template <typename HeartRateT>
+        void hrSamples(HeartRateT& heartRate, const InputT& in, const size_t numSamples)
+        {
+            for(size_t iFrameSample = 0; iFrameSample < numSamples; ++iFrameSample, ++iHrSample)
+            {
+                measurement.filtered = static_cast<int16_t>(in[iHrSample % in.size()]);
+                heartRate.process(measurement);
+            }
+        }
+
+        void hrFrame(const InputT& in)
+        {
+            hrSamples(hr, in, HrFrameSamples);
+        }
+
+        // same frame with the harmonic sum estimator instead of the spectrum maximum
+        void hrFrameHarmonic(const InputT& in)
+        {
+            hrSamples(hrHarmonic, in, HrFrameSamples);
+        }
+
+        void resampleLinear(const InputT& in)
+        {
+            for(size_t iSample = 0; iSample < in.size(); ++iSample)
+            {
+                // 20 ms +/- one 32768 Hz tick, like the DataCollector timestamps
+                const uint64_t timestamp = (numResamplerInputs + iSample) * 20000U + (iSample % 2) * 30U;
+                resampler.process(timestamp, in[iSample], [](const float32_t sample) {
+                    output[numResampled++ % output.size()] = sample;
+                });
+            }
+            numResamplerInputs += in.size();
+        }
+
+        // same line as Application::output
+        void formatLine(const InputT& in)
+        {
+            for(uint32_t iLine = 0; iLine < NumLines; ++iLine)
+            {
+                snprintf(line, sizeof(line), "%" PRIu64 ",%d,%d,%d\r\n"
+                        , static_cast<uint64_t>(135223876U + iLine * 20020U), 19151 + static_cast<int>(iLine)
+                        , static_cast<int>(in[iLine]), 73);
+            }
+        }
+    }
+
+#if defined(CONFIG_PPG_PROFILER)
+    // runs every kernel repeatedly under the profiler, the records go to the console between the rounds
+    void profileKernels(const InputT& input)
+    {
+        static constexpr uint32_t NumRounds = 200;
+        static Profiler::PcSampler sampler{DEVICE_DT_GET(DT_ALIAS(ppg_profiler_timer))};
+        static std::array<Profiler::PcSample, ProfileRecord::MaxSamples> samples{};
+        static std::array<uint8_t, ProfileRecord::MaxSize> record{};
+        const device* const console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+        if(!sampler.isReady() || !sampler.start(CONFIG_PPG_PROFILER_RATE_HZ))
+        {
+            printk("PROFILE FAILED\n");
+            return;
+        }
+        auto flush = [&]() {
+            while(const auto numSamples = sampler.drain(samples))
+            {
+                const auto len = ProfileRecord::encode(std::span{samples}.first(numSamples)
+                                                    , sampler.getRate(), sampler.getNumLost(), record);
+                for(size_t iByte = 0; iByte < len; ++iByte)
+                {
+                    uart_poll_out(console, record[iByte]);
+                }
+            }
+        };
+        for(uint32_t iRound = 0; iRound < NumRounds; ++iRound)
+        {
+            Kernels::fftTransform(input);
+            Kernels::biquadSample(input);
+            Kernels::biquadBlock(input);
+            Kernels::hrFrame(input);
+            Kernels::hrFrameHarmonic(input);
+            Kernels::resampleLinear(input);
+            Kernels::formatLine(input);
+            flush();
+        }
+        sampler.stop();
+        flush();
+        printk("\nPROFILE DONE\n");
+    }
+#endif
+}
+
+int main()
+{
+    SysClockCounter counter;
+    static const InputT input = makeInput();
+
+    {
+        Kernels::fftTransform(input); //< warm-up, the result is discarded
+        auto [duration, result] = Benchmark::benchmark(counter, Kernels::fftTransform, input);
+        report("fft_1024", duration);
+    }
+
+    {
+        auto duration = Benchmark::benchmark(counter, Kernels::biquadSample, input);
+        report("biquad_sample", duration, NumSamples);
+    }
+
+    {
+        auto duration = Benchmark::benchmark(counter, Kernels::biquadBlock, input);
+        report("biquad_block", duration, NumSamples / Kernels::BlockSize * Kernels::BlockSize);
+    }
+
+    {
+        Kernels::hrSamples(Kernels::hr, input, Kernels::HrHistorySamples);
+        auto duration = Benchmark::benchmark(counter, Kernels::hrFrame, input);
+        report("hr_frame", duration);
+    }
+
+    {
+        Kernels::hrSamples(Kernels::hrHarmonic, input, Kernels::HrHistorySamples);
+        auto duration = Benchmark::benchmark(counter, Kernels::hrFrameHarmonic, input);
+        report("hr_frame_harmonic", duration);
+    }
+
+    {
+        auto duration = Benchmark::benchmark(counter, Kernels::resampleLinear, input);
+        report("resample_linear", duration, NumSamples);
+    }
+
+    {
+        auto duration = Benchmark::benchmark(counter, Kernels::formatLine, input);
+        report("format_line", duration, Kernels::NumLines);
+    }
+
+    printk("ICOUNT DONE\n");
+#if defined(CONFIG_PPG_PROFILER)
+    profileKernels(input);
+#endif
+    return 0;
+}
@@ -0,0 +1,140 @@
+# converts the trace records streamed by the firmware after the `trace 1` command (CONFIG_PPG_TRACE)
+# to a Common Trace Format 1.8 trace, one stream per CPU, for babeltrace2, Trace Compass or other CTF viewers
+# usage: python ctf_export.py [--seconds s] <capture file | /dev/ttyACMx> <out dir>
+import argparse
+import os
+import struct
+import sys
+
+from spectrum_stream import TRACE_EVENT_SIZE, StreamDecoder, read_source
+
+# same order as Trace::Event in src/Trace.hpp
+EVENTS = [
+    "timer_expiry",
+    "work_submit",
+    "work_start",
+    "sensor_fetch_begin",
+    "sensor_fetch_end",
+    "queue_put",
+    "queue_get",
+    "hr_frame_begin",
+    "hr_frame_end",
+    "serial_write_begin",
+    "serial_write_end",
+]
+CTF_MAGIC = 0xC1FC1FC1
+# packet header (magic, stream_id) and context (content_size, packet_size, events_discarded, cpu_id)
+PACKET_FORMAT = "<IIQQII"
+PACKET_SIZE = struct.calcsize(PACKET_FORMAT)
+
+METADATA = """/* CTF 1.8 */
+
+typealias integer {{ size = 8; align = 8; signed = false; }} := uint8_t;
+typealias integer {{ size = 16; align = 8; signed = false; }} := uint16_t;
+typealias integer {{ size = 32; align = 8; signed = false; }} := uint32_t;
+typealias integer {{ size = 64; align = 8; signed = false; }} := uint64_t;
+
+trace {{
+	major = 1;
+	minor = 8;
+	byte_order = le;
+	packet.header := struct {{
+		uint32_t magic;
+		uint32_t stream_id;
+	}};
+}};
+
+env {{
+	domain = "ppg";
+	tracer_name = "ppg";
+}};
+
+clock {{
+	name = cycles;
+	description = "CPU cycle counter";
+	freq = {frequency};
+	absolute = false;
+}};
+
+typealias integer {{ size = 32; align = 8; signed = false; map = clock.cycles.value; }} := cycles_t;
+
+stream {{
+	id = 0;
+	packet.context := struct {{
+		uint64_t content_size;
+		uint64_t packet_size;
+		uint32_t events_discarded;
+		uint32_t cpu_id;
+	}};
+	event.header := struct {{
+		cycles_t timestamp;
+		uint8_t id;
+	}};
+	event.context := struct {{
+		uint8_t isr;
+		uint16_t arg;
+		integer {{ size = 32; align = 8; signed = false; base = 16; }} thread;
+	}};
+}};
+"""
+
+EVENT_METADATA = """
+event {{
+	name = "{name}";
+	id = {id};
+	stream_id = 0;
+	fields := struct {{ }};
+}};
+"""
+
+
+def metadata(frequency):
+    text = METADATA.format(frequency=frequency)
+    for event_id, name in enumerate(EVENTS):
+        text += EVENT_METADATA.format(name=name, id=event_id)
+    return text
+
+
+def write_trace(records, out_dir):
+    """Writes every trace record as one packet of the stream of its CPU, returns {cpu: number of events}"""
+    os.makedirs(out_dir, exist_ok=True)
+    streams = {}
+    num_events = {}
+    try:
+        for record in records:
+            cpu = record["cpu"]
+            if cpu not in streams:
+                streams[cpu] = open(os.path.join(out_dir, f"stream_{cpu}"), "wb")
+                num_events[cpu] = 0
+            events = record["events"]
+            size_bits = (PACKET_SIZE + len(events)) * 8
+            streams[cpu].write(struct.pack(PACKET_FORMAT, CTF_MAGIC, 0, size_bits, size_bits, record["num_lost"], cpu))
+            streams[cpu].write(events)
+            num_events[cpu] += len(events) // TRACE_EVENT_SIZE
+    finally:
+        for stream in streams.values():
+            stream.close()
+    with open(os.path.join(out_dir, "metadata"), "w") as f:
+        f.write(metadata(records[0]["frequency"]))
+    return num_events
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert the firmware trace records to a CTF trace")
+    parser.add_argument("source", help="raw capture of the device stream, or the device, e.g. /dev/ttyACM0")
+    parser.add_argument("output", help="trace directory, with metadata and one stream file per CPU")
+    parser.add_argument("--seconds", type=float, default=10.0, help="time to trace the device")
+    args = parser.parse_args()
+
+    decoder = StreamDecoder()
+    records = []
+    for chunk in read_source(args.source, "trace", args.seconds):
+        _, new_records = decoder.feed(chunk)
+        records += [record for record in new_records if record["type"] == "trace"]
+    if not records:
+        print("No trace records", file=sys.stderr)
+        raise SystemExit(1)
+    num_events = write_trace(records, args.output)
+    for cpu, count in sorted(num_events.items()):
+        print(f"CPU {cpu}: {count} events")
+    print(f"{records[-1]['num_lost']} events lost, {decoder.num_bad_records} corrupt records")
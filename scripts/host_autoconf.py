@@ -0,0 +1,65 @@
+# Kconfig defaults of the firmware for the host tools: writes host_autoconf.h next to Kconfig with kconfiglib,
+# the copy shipped with Zephyr ($ZEPHYR_BASE/scripts/kconfig) or the kconfiglib package.
+# Run it after changing a PPG_ option in Kconfig and commit the header, host/CMakeLists.txt includes it.
+# usage: python scripts/host_autoconf.py [--check]
+# exit code 0 when the header is written or up to date, 1 when --check finds it stale, 2 without kconfiglib
+import argparse
+import os
+import sys
+import tempfile
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+KCONFIG = os.path.join(REPO_DIR, "Kconfig")
+HEADER = os.path.join(REPO_DIR, "host_autoconf.h")
+BANNER = "/* Kconfig defaults of the firmware for the host tools, generated by scripts/host_autoconf.py */\n"
+
+
+def import_kconfiglib():
+    zephyr_base = os.environ.get("ZEPHYR_BASE")
+    if zephyr_base:
+        sys.path.insert(0, os.path.join(zephyr_base, "scripts", "kconfig"))
+    try:
+        import kconfiglib
+    except ImportError:
+        return None
+    return kconfiglib
+
+
+def generate(kconfiglib):
+    """autoconf.h of the Kconfig defaults, without the Zephyr symbols, as a string"""
+    with tempfile.TemporaryDirectory() as srctree:
+        # the app Kconfig ends with source "Kconfig.zephyr", resolved against srctree, empty here;
+        # the Zephyr symbols it refers to (SENSOR, COUNTER) stay undefined and n
+        open(os.path.join(srctree, "Kconfig.zephyr"), "w").close()
+        os.environ["srctree"] = srctree
+        kconf = kconfiglib.Kconfig(KCONFIG, warn=False)
+        path = os.path.join(srctree, "autoconf.h")
+        kconf.write_autoconf(path, header=BANNER)
+        with open(path) as f:
+            return f.read()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Kconfig defaults header of the host tools")
+    parser.add_argument("--check", action="store_true", help="only check that the header is up to date")
+    args = parser.parse_args()
+
+    kconfiglib = import_kconfiglib()
+    if kconfiglib is None:
+        print("kconfiglib not found, set ZEPHYR_BASE or pip install kconfiglib", file=sys.stderr)
+        sys.exit(2)
+    header = generate(kconfiglib)
+    current = None
+    if os.path.exists(HEADER):
+        with open(HEADER) as f:
+            current = f.read()
+    if args.check:
+        if current != header:
+            print(f"{HEADER} doesn't match {KCONFIG}, run scripts/host_autoconf.py", file=sys.stderr)
+            sys.exit(1)
+        sys.exit(0)
+    if current != header:
+        with open(HEADER, "w") as f:
+            f.write(header)
+        print(f"Wrote {HEADER}")
+    sys.exit(0)
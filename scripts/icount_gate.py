@@ -0,0 +1,119 @@
+# performance regression gate: instruction counts of the DSP kernels under QEMU against a checked-in baseline
+# usage: python scripts/icount_gate.py [--build] [--update] [--tolerance 0.01] [--build-dir build-icount]
+# exit code 0 when every kernel is within the tolerance, 1 on a regression, 2 when the benchmark didn't run
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BOARD = "mps2_an521"
+QEMU_MACHINE = ["-machine", "mps2-an521", "-cpu", "cortex-m33"]
+RESULT_LINE = re.compile(r"^ICOUNT (\w+) (\d+)$")
+DONE_LINE = "ICOUNT DONE"
+
+
+def build(build_dir):
+    subprocess.run(
+        ["west", "build", "-b", BOARD, "-d", build_dir, os.path.join(REPO_DIR, "icount")],
+        check=True,
+    )
+
+
+def read_icount_shift(build_dir):
+    """icount shift the benchmark was built for, QEMU has to run with the same one"""
+    with open(os.path.join(build_dir, "zephyr", ".config")) as f:
+        for line in f:
+            if line.startswith("CONFIG_QEMU_ICOUNT_SHIFT="):
+                return int(line.split("=")[1])
+    raise ValueError("CONFIG_QEMU_ICOUNT_SHIFT not set, was the build made from icount/?")
+
+
+def run_benchmark(qemu, build_dir, timeout):
+    """Returns {kernel: instructions per call}"""
+    shift = read_icount_shift(build_dir)
+    command = [qemu, *QEMU_MACHINE, "-nographic", "-monitor", "none", "-serial", "stdio",
+               "-icount", f"shift={shift},align=off,sleep=off",
+               "-kernel", os.path.join(build_dir, "zephyr", "zephyr.elf")]
+    results = {}
+    deadline = time.monotonic() + timeout
+    with subprocess.Popen(command, stdout=subprocess.PIPE, stdin=subprocess.DEVNULL, text=True) as process:
+        try:
+            for line in process.stdout:
+                line = line.strip()
+                if line == DONE_LINE:
+                    return results
+                match = RESULT_LINE.match(line)
+                if match:
+                    results[match.group(1)] = int(match.group(2))
+                if time.monotonic() > deadline:
+                    break
+        finally:
+            process.kill()
+    raise RuntimeError(f"benchmark didn't finish, got {sorted(results)}")
+
+
+def compare(results, baseline, tolerance):
+    """Prints one row per kernel, returns True when no kernel regressed"""
+    passed = True
+    print(f"{'kernel':<20}{'baseline':>12}{'current':>12}{'change':>10}")
+    for kernel in sorted(set(baseline) | set(results)):
+        base = baseline.get(kernel)
+        current = results.get(kernel)
+        if current is None:
+            print(f"{kernel:<20}{base:>12}{'missing':>12}")
+            passed = False
+            continue
+        if base is None:
+            print(f"{kernel:<20}{'new':>12}{current:>12}")
+            continue
+        change = (current - base) / base if base else 0.0
+        verdict = ""
+        if change > tolerance:
+            verdict = "  REGRESSION"
+            passed = False
+        elif change < -tolerance:
+            verdict = "  improved, update the baseline"
+        print(f"{kernel:<20}{base:>12}{current:>12}{change:>+10.2%}{verdict}")
+    return passed
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Instruction count regression gate under QEMU")
+    parser.add_argument("--build", action="store_true", help=f"build icount/ for {BOARD} with west first")
+    parser.add_argument("--build-dir", default=os.path.join(REPO_DIR, "build-icount"))
+    parser.add_argument("--baseline", default=os.path.join(REPO_DIR, "icount", "baseline.json"))
+    parser.add_argument("--tolerance", type=float, default=0.01, help="allowed relative increase per kernel")
+    parser.add_argument("--update", action="store_true", help="write the results as the new baseline")
+    parser.add_argument("--qemu", default="qemu-system-arm")
+    parser.add_argument("--timeout", type=float, default=120.0, help="seconds to wait for the benchmark")
+    args = parser.parse_args()
+
+    try:
+        if args.build:
+            build(args.build_dir)
+        results = run_benchmark(args.qemu, args.build_dir, args.timeout)
+    except (OSError, ValueError, RuntimeError, subprocess.CalledProcessError) as error:
+        print(f"icount benchmark failed: {error}", file=sys.stderr)
+        sys.exit(2)
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump({"board": BOARD, "kernels": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Wrote {len(results)} kernels to {args.baseline}")
+        sys.exit(0)
+    if not os.path.exists(args.baseline):
+        # nothing to compare with, the gate is inert until a baseline from a real run is committed
+        print(f"No baseline at {args.baseline}, the gate can't detect regressions;"
+              " create it with --update on a QEMU run and commit it", file=sys.stderr)
+        sys.exit(2)
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("board") != BOARD:
+        print(f"Baseline is for {baseline.get('board')}, not {BOARD}", file=sys.stderr)
+        sys.exit(2)
+    sys.exit(0 if compare(results, baseline["kernels"], args.tolerance) else 1)
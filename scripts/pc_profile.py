@@ -0,0 +1,125 @@
+# symbolizes the PC samples streamed by the firmware after the `profiler 1` command (CONFIG_PPG_PROFILER)
+# and writes folded stacks `thread;function;inlined function count`, input of flamegraph.pl or speedscope
+# usage: python pc_profile.py [--elf build/zephyr/zephyr.elf] [--seconds s] [--top n] <capture file | /dev/ttyACMx> [out.folded]
+import argparse
+import bisect
+import collections
+import os
+import shutil
+import subprocess
+import sys
+
+from spectrum_stream import StreamDecoder, read_source
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TOOL_PREFIXES = ("arm-zephyr-eabi-", "arm-none-eabi-", "")
+INTERRUPT = "[interrupt]"
+
+
+def find_tool(name, prefix):
+    """Returns the path of the binutils tool, the cross toolchain first"""
+    for tool_prefix in ([prefix] if prefix is not None else TOOL_PREFIXES):
+        path = shutil.which(tool_prefix + name)
+        if path:
+            return path
+    raise SystemExit(f"{name} not found, pass --tool-prefix")
+
+
+def symbolize(addr2line, elf, pcs):
+    """Returns {pc: [outermost function, ..., innermost inlined function]}"""
+    pcs = sorted(pcs)
+    if not pcs:
+        return {}
+    output = subprocess.run(
+        [addr2line, "-e", elf, "-f", "-i", "-C", "-a"] + [f"{pc:#x}" for pc in pcs],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout.splitlines()
+    frames = {}
+    pc = None
+    i_line = 0
+    while i_line < len(output):
+        line = output[i_line]
+        if line.startswith("0x"):
+            pc = int(line, 16)
+            frames[pc] = []
+            i_line += 1
+            continue
+        # function name followed by its file:line, innermost first
+        function = line if line != "??" else f"{pc:#x}"
+        frames[pc].insert(0, function)
+        i_line += 2
+    return frames
+
+
+def thread_names(nm, elf):
+    """Returns a lookup of the statically allocated object containing a thread address"""
+    output = subprocess.run(
+        [nm, "-S", "-C", "--defined-only", elf], check=True, capture_output=True, text=True
+    ).stdout.splitlines()
+    objects = []
+    for line in output:
+        fields = line.split(maxsplit=3)
+        if len(fields) == 4 and fields[2] in "bBdD":
+            objects.append((int(fields[0], 16), int(fields[1], 16), fields[3]))
+    objects.sort()
+    starts = [start for start, _, _ in objects]
+
+    def lookup(address):
+        i_object = bisect.bisect_right(starts, address) - 1
+        if i_object >= 0:
+            start, size, name = objects[i_object]
+            if address < start + size:
+                return name
+        return f"thread@{address:#x}"
+
+    return lookup
+
+
+def read_samples(source, seconds):
+    """Returns (samples, rate, lost, corrupt records) of the profile records in the capture file or the device stream"""
+    decoder = StreamDecoder()
+    samples, rate, num_lost = [], 0, 0
+    for chunk in read_source(source, "profiler", seconds):
+        _, records = decoder.feed(chunk)
+        for record in records:
+            if record["type"] != "profile":
+                continue
+            samples.extend(record["samples"].tolist())
+            rate, num_lost = record["rate"], record["num_lost"]
+    return samples, rate, num_lost, decoder.num_bad_records
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Symbolize PC samples of the firmware profiler to folded stacks")
+    parser.add_argument("source", help="raw capture of the device stream, or the device, e.g. /dev/ttyACM0")
+    parser.add_argument("output", nargs="?", help="folded stacks, default stdout")
+    parser.add_argument("--elf", default=os.path.join(REPO_DIR, "build", "zephyr", "zephyr.elf"))
+    parser.add_argument("--seconds", type=float, default=10.0, help="time to profile the device")
+    parser.add_argument("--top", type=int, default=0, help="print the n functions with most samples instead")
+    parser.add_argument("--tool-prefix", help="binutils prefix, e.g. arm-zephyr-eabi-")
+    args = parser.parse_args()
+
+    samples, rate, num_lost, num_bad = read_samples(args.source, args.seconds)
+    print(f"{len(samples)} samples at {rate} Hz, {num_lost} lost, {num_bad} corrupt records", file=sys.stderr)
+    if not samples:
+        raise SystemExit(1)
+    frames = symbolize(find_tool("addr2line", args.tool_prefix), args.elf, {pc for pc, _ in samples if pc})
+    thread_name = thread_names(find_tool("nm", args.tool_prefix), args.elf)
+
+    stacks = collections.Counter()
+    for pc, thread in samples:
+        stacks[(thread_name(thread),) + (tuple(frames[pc]) if pc else (INTERRUPT,))] += 1
+    if args.top > 0:
+        functions = collections.Counter()
+        for stack, count in stacks.items():
+            functions[stack[-1]] += count
+        for function, count in functions.most_common(args.top):
+            print(f"{100.0 * count / len(samples):6.2f}% {count:8d}  {function}")
+        raise SystemExit(0)
+    out = open(args.output, "w") if args.output else sys.stdout
+    for stack, count in sorted(stacks.items()):
+        out.write(";".join(stack) + f" {count}\n")
+    if args.output:
+        out.close()
@@ -0,0 +1,78 @@
+# runs the firmware PPG filter, resampling and heart rate over a recording with the ppgdsp module built in host/,
+# same arithmetic as host/ppg_batch and the firmware pipeline, without re-implementing it in SciPy
+# usage: python ppg_native.py [--module-dir build-host] [--fs 50] [--no-resample] [--estimator harmonic|argmax]
+#                             <recording.txt | recording.ppgrec> [out.npz]
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+from ppg_recording import load_recording
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+# same configuration as Application and ppg_batch, (samples, history, fft_length) per sample rate
+HR_CONFIG = {50: (100, 200, 1024), 25: (50, 100, 256)}
+
+
+def import_ppgdsp(module_dir):
+    sys.path.insert(0, module_dir)
+    import ppgdsp
+
+    return ppgdsp
+
+
+def load_columns(path):
+    """Returns (timestamps, raw) of a CSV recording from data/ or a *.ppgrec file"""
+    if path.endswith(".ppgrec"):
+        columns, _, _ = load_recording(path)
+    else:
+        with open(path) as f:
+            names = f.readline().strip().split(",")
+        values = np.loadtxt(path, delimiter=",", skiprows=1, ndmin=2)
+        columns = {name: values[:, i_column] for i_column, name in enumerate(names)}
+    time_name = next(name for name in ("TimestampHw", "Timestamp") if name in columns)
+    return np.asarray(columns[time_name], dtype=np.uint64), np.asarray(columns["Raw"], dtype=np.uint16)
+
+
+def run_pipeline(ppgdsp, timestamps, raw, fs, resample=True, estimator="harmonic"):
+    """Returns (filtered, bpm per heart rate sample) like the firmware after reset,
+    the heart rate samples are the resampled grid with resample, CONFIG_PPG_RESAMPLING=y,
+    and the harmonic estimator is CONFIG_PPG_HR_HARMONIC_ESTIMATOR=y"""
+    samples, history, fft_length = HR_CONFIG[fs]
+    raw = raw.astype(np.float32)
+    iir = ppgdsp.IIRFilter(ppgdsp.ppg_filter_coeffs(fs))
+    iir.prime(float(raw[0]))
+    filtered = np.asarray(iir.process(raw))
+    # truncated to int16 like PpgMeasurement::filtered
+    hr_input = filtered.astype(np.int16)
+    if resample:
+        hr_input = np.asarray(ppgdsp.Resampler(fs).process(timestamps, hr_input))
+    hr = ppgdsp.HeartRate(fs, samples, history, fft_length, estimator)
+    bpm = np.asarray(hr.process(hr_input))
+    return filtered, bpm
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Run the firmware filter and heart rate over a recording")
+    parser.add_argument("recording")
+    parser.add_argument("output", nargs="?", help="save timestamps, filtered samples and BPM (.npz)")
+    parser.add_argument("--module-dir", default=os.path.join(REPO_DIR, "build-host"), help="directory with ppgdsp")
+    parser.add_argument("--fs", type=int, default=50, choices=sorted(HR_CONFIG))
+    parser.add_argument("--no-resample", action="store_true", help="feed the samples to the heart rate as measured")
+    parser.add_argument("--estimator", default="harmonic", choices=["harmonic", "argmax"])
+    args = parser.parse_args()
+
+    ppgdsp = import_ppgdsp(args.module_dir)
+    timestamps, raw = load_columns(args.recording)
+    start = time.perf_counter()
+    filtered, bpm = run_pipeline(ppgdsp, timestamps, raw, args.fs, not args.no_resample, args.estimator)
+    elapsed = time.perf_counter() - start
+    # one estimate per analysis frame, like ppg_batch
+    frame_bpm = bpm[HR_CONFIG[args.fs][0] - 1 :: HR_CONFIG[args.fs][0]]
+    estimates = frame_bpm[frame_bpm > 0]
+    print(f"{len(raw)} samples in {elapsed:.3f} s, {len(estimates)} estimates"
+          + (f", median {np.median(estimates):.0f} BPM" if len(estimates) else ""))
+    if args.output:
+        np.savez(args.output, timestamp_us=timestamps, filtered=filtered, bpm=bpm)
@@ -0,0 +1,54 @@
+# memory-mapped reader for the columnar *.ppgrec recordings written by host/ppg_ingest
+import struct
+
+import numpy as np
+
+MAGIC = b"PPGREC\0\0"
+VERSION = 1
+ALIGNMENT = 64
+HEADER_FORMAT = "<8sHHHHIfQQQQ"
+DESCRIPTOR_FORMAT = "<16sBBHIQ"
+COLUMN_DTYPES = {
+    0: np.uint8,
+    1: np.uint16,
+    2: np.int16,
+    3: np.uint32,
+    4: np.int32,
+    5: np.uint64,
+    6: np.float32,
+}
+
+
+def load_recording(path):
+    """Map a recording, returns (columns dict of zero-copy arrays, sample rate, chunk index)"""
+    data = np.memmap(path, dtype=np.uint8, mode="r")
+    header = struct.unpack_from(HEADER_FORMAT, data, 0)
+    (magic, version, num_columns, time_column, _, chunk_samples, sample_rate,
+     num_samples, num_chunks, chunk_index_offset, _) = header
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path} is not a version {VERSION} recording")
+    descriptors_offset = ALIGNMENT
+    columns = {}
+    for i_column in range(num_columns):
+        offset = descriptors_offset + i_column * struct.calcsize(DESCRIPTOR_FORMAT)
+        name, col_type, width, _, _, col_offset = struct.unpack_from(
+            DESCRIPTOR_FORMAT, data, offset
+        )
+        name = name.rstrip(b"\0").decode()
+        dtype = COLUMN_DTYPES[col_type]
+        columns[name] = np.frombuffer(
+            data, dtype=dtype, count=num_samples, offset=col_offset
+        )
+    chunk_index = np.frombuffer(
+        data, dtype=np.uint64, count=2 * num_chunks, offset=chunk_index_offset
+    ).reshape(-1, 2)
+    return columns, sample_rate, chunk_index
+
+
+if __name__ == "__main__":
+    import sys
+
+    columns, fs, chunks = load_recording(sys.argv[1])
+    print(f"fs = {fs} Hz, {len(chunks)} chunks")
+    for name, values in columns.items():
+        print(f"{name}: {values.dtype}, {len(values)} samples")
@@ -0,0 +1,224 @@
+# decoder for the spectrum records streamed by the firmware after the `spectrum 1` command,
+# also splits out the profile records of `profiler 1` (see pc_profile.py) and the trace records of `trace 1` (see ctf_export.py)
+# usage: python spectrum_stream.py [--enable] [--seconds s] [--plot out.png] <capture file | /dev/ttyACMx> <out.npz>
+import argparse
+import binascii
+import os
+import struct
+import time
+
+import numpy as np
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+HEADER_FORMAT = "<2sBBHHHBBfQ"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+CRC_SIZE = 2
+DB_STEP = 0.5
+FLAG_PROVISIONAL = 1 << 0
+PROFILE_SYNC = b"\xa5\xc3"
+PROFILE_VERSION = 1
+PROFILE_HEADER_FORMAT = "<2sBBHHI"
+PROFILE_HEADER_SIZE = struct.calcsize(PROFILE_HEADER_FORMAT)
+PC_SAMPLE_DTYPE = np.dtype([("pc", "<u4"), ("thread", "<u4")])
+TRACE_SYNC = b"\xa5\x7e"
+TRACE_VERSION = 1
+TRACE_HEADER_FORMAT = "<2sBBB3xII"
+TRACE_HEADER_SIZE = struct.calcsize(TRACE_HEADER_FORMAT)
+TRACE_EVENT_SIZE = 12
+# common axis the frames of every profile are interpolated to
+BPM_AXIS = np.arange(30.0, 241.0, 1.0)
+
+
+class StreamDecoder:
+    """Splits the device stream into sample lines and binary records, spectrum or profile"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.num_bad_records = 0
+
+    def feed(self, data):
+        """Returns the (lines, records) completed by data, lines without the line ending"""
+        self.buffer += data
+        lines, records = [], []
+        while self.buffer:
+            if self.buffer[:1] == SYNC[:1]:
+                if len(self.buffer) < 2:
+                    break
+                if self.buffer[:2] == PROFILE_SYNC:
+                    record = self._parse_profile_record()
+                elif self.buffer[:2] == TRACE_SYNC:
+                    record = self._parse_trace_record()
+                elif len(self.buffer) < HEADER_SIZE:
+                    break
+                else:
+                    record = self._parse_record()
+                if record is None:
+                    break
+                if record is not False:
+                    records.append(record)
+                continue
+            end = self.buffer.find(b"\n")
+            if end < 0:
+                break
+            lines.append(bytes(self.buffer[:end]).rstrip(b"\r").decode(errors="replace"))
+            del self.buffer[: end + 1]
+        return lines, records
+
+    def _parse_record(self):
+        """Returns the record dict, None if incomplete, False if it was skipped as corrupt"""
+        header = struct.unpack_from(HEADER_FORMAT, self.buffer, 0)
+        sync, version, num_bins, fs, fft_length, first_bin, bpm, flags, peak, timestamp = header
+        size = HEADER_SIZE + num_bins + CRC_SIZE
+        if sync != SYNC or version != VERSION:
+            return self._skip_line()
+        if len(self.buffer) < size:
+            return None
+        (crc,) = struct.unpack_from("<H", self.buffer, HEADER_SIZE + num_bins)
+        if binascii.crc_hqx(bytes(self.buffer[: HEADER_SIZE + num_bins]), 0xFFFF) != crc:
+            return self._skip_line()
+        levels = np.frombuffer(bytes(self.buffer[HEADER_SIZE : HEADER_SIZE + num_bins]), dtype=np.uint8)
+        del self.buffer[:size]
+        bins = first_bin + np.arange(num_bins)
+        return {
+            "type": "spectrum",
+            "timestamp": timestamp,
+            "sample_rate": fs,
+            "fft_length": fft_length,
+            "bpm": bpm,
+            "provisional": bool(flags & FLAG_PROVISIONAL),
+            "peak": peak,
+            "bin_bpm": 60.0 * bins * fs / fft_length,
+            # dB relative to the peak, 255 stands for below the range
+            "level_db": -DB_STEP * levels.astype(np.float32),
+        }
+
+    def _take_counted_record(self, header_format, version, item_size):
+        """Returns (header fields, payload) of a record of header, items (counted by the third header field) and CRC,
+        None if incomplete, False if it was skipped as corrupt"""
+        header_size = struct.calcsize(header_format)
+        if len(self.buffer) < header_size:
+            return None
+        header = struct.unpack_from(header_format, self.buffer, 0)
+        payload_size = header[2] * item_size
+        size = header_size + payload_size + CRC_SIZE
+        if header[1] != version:
+            return self._skip_line()
+        if len(self.buffer) < size:
+            return None
+        (crc,) = struct.unpack_from("<H", self.buffer, header_size + payload_size)
+        if binascii.crc_hqx(bytes(self.buffer[: header_size + payload_size]), 0xFFFF) != crc:
+            return self._skip_line()
+        payload = bytes(self.buffer[header_size : header_size + payload_size])
+        del self.buffer[:size]
+        return header, payload
+
+    def _parse_profile_record(self):
+        """Returns the profile record dict, None if incomplete, False if it was skipped as corrupt"""
+        taken = self._take_counted_record(PROFILE_HEADER_FORMAT, PROFILE_VERSION, PC_SAMPLE_DTYPE.itemsize)
+        if not taken:
+            return taken
+        (_, _, _, rate, _, num_lost), payload = taken
+        samples = np.frombuffer(payload, dtype=PC_SAMPLE_DTYPE)
+        return {"type": "profile", "rate": rate, "num_lost": num_lost, "samples": samples}
+
+    def _parse_trace_record(self):
+        """Returns the trace record dict, events are CTF event records, None if incomplete, False if corrupt"""
+        taken = self._take_counted_record(TRACE_HEADER_FORMAT, TRACE_VERSION, TRACE_EVENT_SIZE)
+        if not taken:
+            return taken
+        (_, _, _, cpu, frequency, num_lost), events = taken
+        return {"type": "trace", "cpu": cpu, "frequency": frequency, "num_lost": num_lost, "events": events}
+
+    def _skip_line(self):
+        self.num_bad_records += 1
+        end = self.buffer.find(b"\n", 1)
+        if end < 0:
+            self.buffer.clear()
+        else:
+            del self.buffer[: end + 1]
+        return False
+
+
+def read_source(path, command, seconds):
+    """Yields chunks of the capture file, or of the live device stream for the given time,
+    `<command> 1` is sent to the device before reading and `<command> 0` after, unless command is None"""
+    if not path.startswith("/dev/"):
+        with open(path, "rb") as f:
+            while chunk := f.read(65536):
+                yield chunk
+        return
+    import termios
+    import tty
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    try:
+        tty.setraw(fd)
+        if command:
+            os.write(fd, f"{command} 1\n".encode())
+        end = time.monotonic() + seconds
+        while time.monotonic() < end:
+            yield os.read(fd, 4096)
+    finally:
+        if command:
+            os.write(fd, f"{command} 0\n".encode())
+            termios.tcdrain(fd)
+        os.close(fd)
+
+
+def build_spectrogram(records):
+    """Interpolates every frame to BPM_AXIS, returns dict of arrays for np.savez"""
+    levels = np.full((len(records), len(BPM_AXIS)), np.nan, dtype=np.float32)
+    for i_record, record in enumerate(records):
+        levels[i_record] = np.interp(
+            BPM_AXIS, record["bin_bpm"], record["level_db"], left=np.nan, right=np.nan
+        )
+    return {
+        "timestamp_us": np.array([r["timestamp"] for r in records], dtype=np.uint64),
+        "bpm_axis": BPM_AXIS,
+        "level_db": levels,
+        "bpm": np.array([r["bpm"] for r in records], dtype=np.uint8),
+        "provisional": np.array([r["provisional"] for r in records], dtype=bool),
+        "peak": np.array([r["peak"] for r in records], dtype=np.float32),
+        "sample_rate": np.array([r["sample_rate"] for r in records], dtype=np.uint16),
+        "fft_length": np.array([r["fft_length"] for r in records], dtype=np.uint16),
+    }
+
+
+def plot_spectrogram(spectrogram, path):
+    import matplotlib.pyplot as plt
+
+    t = (spectrogram["timestamp_us"].astype(np.float64) - spectrogram["timestamp_us"][0]) * 1e-6
+    plt.figure(figsize=(10, 5))
+    plt.pcolormesh(t, spectrogram["bpm_axis"], spectrogram["level_db"].T, shading="nearest", vmin=-40, vmax=0)
+    plt.colorbar(label="dB below frame peak")
+    plt.plot(t, spectrogram["bpm"], "w.", markersize=3, label="estimate")
+    plt.xlabel("Time [s]")
+    plt.ylabel("BPM")
+    plt.legend(loc="upper right")
+    plt.savefig(path, dpi=150)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Decode spectrum records of the device stream to a spectrogram")
+    parser.add_argument("source", help="raw capture of the device stream, or the device, e.g. /dev/ttyACM0")
+    parser.add_argument("output", help="spectrogram file (.npz)")
+    parser.add_argument("--enable", action="store_true", help="send `spectrum 1` to the device before reading")
+    parser.add_argument("--seconds", type=float, default=60.0, help="time to read from the device")
+    parser.add_argument("--plot", help="also save the spectrogram as an image")
+    args = parser.parse_args()
+
+    decoder = StreamDecoder()
+    records = []
+    num_lines = 0
+    for chunk in read_source(args.source, "spectrum" if args.enable else None, args.seconds):
+        lines, new_records = decoder.feed(chunk)
+        num_lines += len(lines)
+        records += [record for record in new_records if record["type"] == "spectrum"]
+    print(f"{num_lines} lines, {len(records)} spectrum records, {decoder.num_bad_records} corrupt")
+    if not records:
+        raise SystemExit(1)
+    spectrogram = build_spectrogram(records)
+    np.savez(args.output, **spectrogram)
+    if args.plot:
+        plot_spectrogram(spectrogram, args.plot)
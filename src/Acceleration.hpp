@@ -0,0 +1,15 @@
+#ifndef _PPG_ACCELERATION_HPP
+#define _PPG_ACCELERATION_HPP
+
+namespace Hardware
+{
+    // acceleration in m/s^2
+    struct Acceleration
+    {
+        float x;
+        float y;
+        float z;
+    };
+}
+
+#endif //_PPG_ACCELERATION_HPP
@@ -0,0 +1,34 @@
+#include "Accelerometer.hpp"
+
+namespace Hardware
+{
+    Accelerometer::Accelerometer(const device* const dev)
+        : Device{dev}
+    { }
+
+    bool Accelerometer::setSamplingFrequency(const uint16_t frequency)
+    {
+        const sensor_value value{frequency, 0};
+        return sensor_attr_set(getDevicePointer(), SENSOR_CHAN_ACCEL_XYZ
+                            , SENSOR_ATTR_SAMPLING_FREQUENCY, &value) == 0;
+    }
+
+    std::optional<Acceleration> Accelerometer::getAcceleration()
+    {
+        const auto dev = getDevicePointer();
+        if(sensor_sample_fetch_chan(dev, SENSOR_CHAN_ACCEL_XYZ) < 0)
+        {
+            return {};
+        }
+        sensor_value sensorValues[3]{};
+        if(sensor_channel_get(dev, SENSOR_CHAN_ACCEL_XYZ, sensorValues) < 0)
+        {
+            return {};
+        }
+        return Acceleration{
+            static_cast<float>(sensor_value_to_double(&sensorValues[0]))
+            , static_cast<float>(sensor_value_to_double(&sensorValues[1]))
+            , static_cast<float>(sensor_value_to_double(&sensorValues[2]))
+        };
+    }
+}
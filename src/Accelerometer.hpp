@@ -0,0 +1,24 @@
+#ifndef _PPG_ACCELEROMETER_HPP
+#define _PPG_ACCELEROMETER_HPP
+
+#include <cstdint>
+#include <optional>
+
+#include <zephyr/drivers/sensor.h>
+
+#include "Device.hpp"
+#include "Acceleration.hpp"
+
+namespace Hardware
+{
+    class Accelerometer
+        : public Device
+    {
+        public:
+            Accelerometer(const device* const dev);
+            bool setSamplingFrequency(const uint16_t frequency);
+            std::optional<Acceleration> getAcceleration();
+    };
+}
+
+#endif //_PPG_ACCELEROMETER_HPP
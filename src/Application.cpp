@@ -1,19 +1,39 @@
-#include <cstdio>
-
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(ppg);
 
+#if defined(CONFIG_PPG_MOTION_CANCELLATION) && !DT_HAS_COMPAT_STATUS_OKAY(st_lsm6dsl)
+#error "CONFIG_PPG_MOTION_CANCELLATION needs the accelerometer node, build with the ppg-motion snippet"
+#endif
+
+#if defined(CONFIG_PPG_PROFILER) && !DT_NODE_EXISTS(DT_ALIAS(ppg_profiler_timer))
+#error "CONFIG_PPG_PROFILER needs the ppg-profiler-timer alias, build with the ppg-profiler snippet"
+#endif
+
 #include "Application.hpp"
 
 Application::Application()
     : prox_{DEVICE_DT_GET_ONE(vishay_vcnl4040)}
     , neopixel_{DEVICE_DT_GET(DT_ALIAS(neopixel))}
     , serial_{DEVICE_DT_GET_ONE(zephyr_cdc_acm_uart)}
-    , ppg_{prox_}
-    , hr_{sampleRate_}
-    , dataCollector_{ppg_}
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+    , accel_{DEVICE_DT_GET_ONE(st_lsm6dsl)}
+#endif
+    , lowPowerProfile_{"low-power"}
+    , highResolutionProfile_{"high-resolution"}
+    , profiles_{&lowPowerProfile_, &highResolutionProfile_}
+    , profile_{&highResolutionProfile_}
+#if defined(CONFIG_PPG_COROUTINE_PIPELINE)
+    , coroPipeline_{prox_, serial_, clock_, highResolutionProfile_}
+#else
+    , ppg_{prox_, profile_->filter(), ppgQueue_}
+    , dataCollector_{ppg_, clock_, sampleTimer_}
+    , outputStage_{cycleCounter_, *profile_}
+#endif
+#if defined(CONFIG_PPG_PROFILER)
+    , pcSampler_{DEVICE_DT_GET(DT_ALIAS(ppg_profiler_timer))}
+#endif
 { }
 
 bool Application::run()
@@ -23,6 +43,19 @@ bool Application::run()
     auto status = init();
     if(!status) return false;
     LOG_INF("Hardware initialization successful");
+#if defined(CONFIG_PPG_COROUTINE_PIPELINE)
+    if(!coroPipeline_.start())
+    {
+        return false;
+    }
+    // main loop, the stages pause while the port is closed
+    while(true)
+    {
+        waitForConnection();
+        coroPipeline_.run();
+        LOG_INF("USB disconnected, %u ticks missed", coroPipeline_.getNumMissedTicks());
+    }
+#else
     // main loop
     while(true)
     {
@@ -30,36 +63,301 @@ bool Application::run()
         if(!serial_.isOpen())
         {
             dataCollector_.stop();
-            neopixel_.setColor(Color::Color{10, 0, 0});
-            // wait for DTR
-            LOG_INF("Waiting for USB connection");
-            while(!serial_.isOpen())
-            {
-                k_msleep(100);
-            }
-            neopixel_.setColor(Color::Color{0, 10, 0});
-            LOG_INF("USB connected");
-            dataCollector_.start(sampleTime_);
+#if defined(CONFIG_PPG_PROFILER)
+            setProfiler(false);
+#endif
+#if defined(CONFIG_PPG_TRACE)
+            setTracing(false);
+#endif
+            waitForConnection();
+            dataCollector_.start(profile_->sampleTime());
         }
         else
         {
             const auto ppgMeasurement = ppg_.getMeasurement(10ms);
             if(ppgMeasurement.has_value())
             {
-                auto bpm = hr_.process(ppgMeasurement.value());
-                auto len = snprintf(serialBuf_, sizeof(serialBuf_)
-                                , "%" PRIu64 ",%d,%d,%d\r\n"
-                                , ppgMeasurement.value().timestamp
-                                , ppgMeasurement.value().raw
-                                , ppgMeasurement.value().filtered
-                                , bpm);
-                serial_.write(reinterpret_cast<std::byte*>(serialBuf_), len);
+                outputStage_.begin();
+                output(ppgMeasurement.value());
+                updateDegradedMode();
             }
+#if defined(CONFIG_PPG_PROFILER)
+            outputProfile();
+#endif
+#if defined(CONFIG_PPG_TRACE)
+            outputTrace();
+#endif
+            pollCommands();
         }
     }
+#endif
     return true; //< should never reach this point
 }
 
+void Application::waitForConnection()
+{
+    neopixel_.setColor(Color::Color{10, 0, 0});
+    // wait for DTR
+    LOG_INF("Waiting for USB connection");
+    while(!serial_.isOpen())
+    {
+        k_msleep(100);
+    }
+    neopixel_.setColor(Color::Color{0, 10, 0});
+    LOG_INF("USB connected");
+}
+
+#if !defined(CONFIG_PPG_COROUTINE_PIPELINE)
+void Application::output(const Processor::Ppg::Measurement& measurement)
+{
+    const auto line = outputStage_.process(measurement);
+    if(line.empty())
+    {
+        return;
+    }
+    serial_.write(reinterpret_cast<const std::byte*>(line.data()), line.size());
+    if(spectrumStreaming_)
+    {
+        outputSpectrum(measurement.timestamp);
+    }
+}
+
+void Application::outputSpectrum(const uint64_t timestamp)
+{
+    const auto frame = profile_->takeSpectrum();
+    if(!frame.has_value())
+    {
+        return;
+    }
+    const auto len = SpectrumRecord::encode(frame.value(), timestamp, spectrumRecord_);
+    serial_.write(reinterpret_cast<std::byte*>(spectrumRecord_.data()), len);
+}
+
+void Application::setSpectrumStreaming(const bool enabled)
+{
+    // every profile captures, so streaming continues after a profile switch
+    for(auto* profile : profiles_)
+    {
+        profile->setSpectrumCapture(enabled);
+    }
+    spectrumStreaming_ = enabled;
+    LOG_INF("Spectrum streaming %s", enabled ? "enabled" : "disabled");
+}
+#endif
+
+#if defined(CONFIG_PPG_PROFILER)
+void Application::outputProfile()
+{
+    if(!pcSampler_.isRunning())
+    {
+        return;
+    }
+    // records are written between the sample lines, only full ones unless the ring fills up
+    while(true)
+    {
+        const auto numSamples = pcSampler_.drain(pcSamples_);
+        if(numSamples == 0)
+        {
+            return;
+        }
+        const auto len = ProfileRecord::encode(std::span{pcSamples_}.first(numSamples)
+                                            , pcSampler_.getRate(), pcSampler_.getNumLost(), profileRecord_);
+        serial_.write(reinterpret_cast<std::byte*>(profileRecord_.data()), len);
+        if(numSamples < pcSamples_.size())
+        {
+            return;
+        }
+    }
+}
+
+void Application::setProfiler(const bool enabled)
+{
+    if(enabled == pcSampler_.isRunning())
+    {
+        return;
+    }
+    if(!enabled)
+    {
+        pcSampler_.stop();
+        outputProfile();
+        LOG_INF("Profiler stopped, %u samples lost", pcSampler_.getNumLost());
+    }
+    else if(pcSampler_.start(CONFIG_PPG_PROFILER_RATE_HZ))
+    {
+        LOG_INF("Profiler started, %d Hz", CONFIG_PPG_PROFILER_RATE_HZ);
+    }
+}
+#endif
+
+#if defined(CONFIG_PPG_TRACE)
+void Application::outputTrace()
+{
+    if(!Trace::isEnabled())
+    {
+        return;
+    }
+    // writing the records traces serial writes too, so every pass leaves a few events for the next
+    for(uint8_t cpu = 0; cpu < Trace::getNumCpus(); ++cpu)
+    {
+        while(true)
+        {
+            const auto numEvents = Trace::drain(cpu, traceEvents_);
+            if(numEvents == 0)
+            {
+                break;
+            }
+            const auto len = TraceRecord::encode(std::span{traceEvents_}.first(numEvents), cpu
+                                                , Trace::getFrequency(), Trace::getNumLost(), traceRecord_);
+            serial_.write(reinterpret_cast<std::byte*>(traceRecord_.data()), len);
+            if(numEvents < traceEvents_.size())
+            {
+                break;
+            }
+        }
+    }
+}
+
+void Application::setTracing(const bool enabled)
+{
+    if(enabled == Trace::isEnabled())
+    {
+        return;
+    }
+    Trace::setEnabled(enabled);
+    if(enabled)
+    {
+        LOG_INF("Tracing started, %u Hz timestamps", Trace::getFrequency());
+    }
+    else
+    {
+        LOG_INF("Tracing stopped, %u events lost", Trace::getNumLost());
+    }
+}
+#endif
+
+#if !defined(CONFIG_PPG_COROUTINE_PIPELINE)
+void Application::pollCommands()
+{
+    std::byte received[8];
+    const auto numReceived = serial_.readAvailable(received, sizeof(received));
+    for(std::size_t iByte = 0; iByte < numReceived; ++iByte)
+    {
+        const auto command = commandReader_.feed(received[iByte]);
+        if(!command.has_value())
+        {
+            continue;
+        }
+        if(command->name == "profile" && command->arg.has_value())
+        {
+            if(!selectProfile(command->arg.value()))
+            {
+                LOG_WRN("Unknown profile %d", command->arg.value());
+            }
+        }
+        else if(command->name == "spectrum" && command->arg.has_value())
+        {
+            setSpectrumStreaming(command->arg.value() != 0);
+        }
+#if defined(CONFIG_PPG_PROFILER)
+        else if(command->name == "profiler" && command->arg.has_value())
+        {
+            setProfiler(command->arg.value() != 0);
+        }
+#endif
+#if defined(CONFIG_PPG_TRACE)
+        else if(command->name == "trace" && command->arg.has_value())
+        {
+            setTracing(command->arg.value() != 0);
+        }
+#endif
+        else if(command->name == "deadline")
+        {
+            logDeadlineStats();
+        }
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+        else if(command->name == "motion")
+        {
+            const auto cycles = ppg_.getMotionCyclesPerSample();
+            if(cycles.has_value())
+            {
+                LOG_INF("Motion cancellation: %u cycles per sample", cycles.value());
+            }
+            else
+            {
+                LOG_INF("Motion cancellation: no samples processed");
+            }
+        }
+#endif
+#if defined(CONFIG_PPG_RESAMPLING)
+        else if(command->name == "resampler")
+        {
+            LOG_INF("Resampler: %u filled samples, %u resyncs"
+                    , profile_->getNumFilledSamples(), profile_->getNumResyncs());
+        }
+#endif
+        else
+        {
+            LOG_WRN("Unknown command");
+        }
+    }
+}
+
+bool Application::selectProfile(const std::size_t iProfile)
+{
+    if(iProfile >= profiles_.size())
+    {
+        return false;
+    }
+    if(profiles_[iProfile] == profile_)
+    {
+        return true;
+    }
+    // finish every sample measured with the old profile, then restart with the new one
+    dataCollector_.stop();
+    ppg_.flush();
+    while(true)
+    {
+        const auto measurement = ppg_.getMeasurement(std::chrono::milliseconds(0));
+        if(!measurement.has_value()) break;
+        output(measurement.value());
+    }
+    profile_ = profiles_[iProfile];
+    profile_->reset();
+    outputStage_.setProfile(*profile_);
+    ppg_.setFilter(profile_->filter());
+    dataCollector_.start(profile_->sampleTime());
+    LOG_INF("Switched to %s profile, %d Hz", profile_->name().data(), profile_->sampleRate());
+    return true;
+}
+
+void Application::updateDegradedMode()
+{
+    if(!outputStage_.end(ppg_.getBacklog()))
+    {
+        return;
+    }
+    if(outputStage_.isDegraded())
+    {
+        LOG_WRN("Deadline missed or samples queued up, entering degraded mode");
+    }
+    else
+    {
+        LOG_INF("Headroom recovered, leaving degraded mode");
+    }
+    logDeadlineStats();
+}
+
+void Application::logDeadlineStats()
+{
+    const auto& deadlineMonitor = outputStage_.monitor();
+    const auto& stats = deadlineMonitor.stats();
+    LOG_INF("Deadline: %u periods, %u overruns, %u transitions, worst %u / %u cycles, %u skipped frames, %u dropped samples"
+            , stats.periods, stats.overruns, stats.transitions
+            , static_cast<uint32_t>(stats.worst.count()), static_cast<uint32_t>(deadlineMonitor.budget().count())
+            , profile_->getNumSkippedFrames(), ppg_.getNumDropped());
+}
+#endif
+
 bool Application::init()
 {
     if (!prox_.isReady())
@@ -74,10 +372,31 @@ bool Application::init()
         return false;
     }
 
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+    if (!accel_.isReady())
+    {
+        LOG_ERR("Accelerometer not ready.");
+        return false;
+    }
+    if(!accel_.setSamplingFrequency(accelSamplingFrequency_))
+    {
+        LOG_WRN("Can't set accelerometer sampling frequency.");
+    }
+    ppg_.setMotionReference(accel_);
+#endif
+
+#if defined(CONFIG_PPG_PROFILER)
+    if (!pcSampler_.isReady())
+    {
+        LOG_ERR("Profiler timer not ready.");
+        return false;
+    }
+#endif
+
     if(!serial_.enable())
     {
         LOG_ERR("Can't enable serial via USB CDC.");
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -1,15 +1,37 @@
 #ifndef _PPG_APPLICATION_HPP
 #define _PPG_APPLICATION_HPP
 
+#include <array>
 #include <chrono>
 
 #include "Proximity.hpp"
 #include "Neopixel.hpp"
 #include "Serial.hpp"
+#include "Command.hpp"
+#include "SystemClock.hpp"
+#include "SpectrumRecord.hpp"
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+#include "Accelerometer.hpp"
+#endif
 
+#include "PipelineProfile.hpp"
+#if defined(CONFIG_PPG_COROUTINE_PIPELINE)
+#include "CoroPipeline.hpp"
+#else
+#include "CycleCounter.hpp"
+#include "Timer.hpp"
+#include "MessageQueue.hpp"
 #include "PpgProcessor.hpp"
 #include "DataCollector.hpp"
-#include "HrProcessor.hpp"
+#include "OutputStage.hpp"
+#endif
+#if defined(CONFIG_PPG_PROFILER)
+#include "PcSampler.hpp"
+#include "ProfileRecord.hpp"
+#endif
+#if defined(CONFIG_PPG_TRACE)
+#include "TraceRecord.hpp"
+#endif
 
 class Application
 {
@@ -18,24 +40,80 @@ class Application
         bool run();
     private:
         bool init();
+        void waitForConnection();
+#if !defined(CONFIG_PPG_COROUTINE_PIPELINE)
+        void output(const Processor::Ppg::Measurement& measurement);
+        void outputSpectrum(const uint64_t timestamp);
+        void setSpectrumStreaming(const bool enabled);
+        void pollCommands();
+        bool selectProfile(const std::size_t iProfile);
+        // ends the deadline period of a measurement, logs mode changes
+        void updateDegradedMode();
+        void logDeadlineStats();
+#endif
+#if defined(CONFIG_PPG_PROFILER)
+        void outputProfile();
+        void setProfiler(const bool enabled);
+#endif
+#if defined(CONFIG_PPG_TRACE)
+        void outputTrace();
+        void setTracing(const bool enabled);
+#endif
+    private:
+        // profiles, <sample rate, hr samples, hr samples history, fft length>
+        using LowPowerProfile = Processor::PipelineProfile<25, 50, 100, 256>;
+        using HighResolutionProfile = Processor::PipelineProfile<50, 100, 200, 1024>;
+        static constexpr std::size_t FilterBlockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+        template <typename ProfileT>
+        static constexpr bool isWithinLatencyBound =
+            (FilterBlockSize - 1) * 1000 / ProfileT::SampleRate <= CONFIG_PPG_FILTER_MAX_LATENCY_MS;
+        static_assert(isWithinLatencyBound<LowPowerProfile> && isWithinLatencyBound<HighResolutionProfile>
+                    , "PPG filter block size exceeds the latency bound at a profile sample rate");
     private:
         // hardware
         Hardware::Proximity prox_;
         Hardware::Neopixel neopixel_;
         Hardware::Serial serial_;
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+        Hardware::Accelerometer accel_;
+        static constexpr uint16_t accelSamplingFrequency_ = 104; //< Hz, above every profile sample rate
+#endif
+        // processing profiles, each owns its filter and heart rate state
+        LowPowerProfile lowPowerProfile_;
+        HighResolutionProfile highResolutionProfile_;
+        std::array<Processor::IPipelineProfile*, 2> profiles_;
+        Processor::IPipelineProfile* profile_;
+        // time
+        Hardware::SystemClock clock_;
+#if defined(CONFIG_PPG_COROUTINE_PIPELINE)
+        Processor::CoroPipeline coroPipeline_;
+#else
+        Hardware::Timer sampleTimer_;
         // processors
+        Hardware::MessageQueue<Processor::Ppg::Measurement, Processor::Ppg::QueueSize> ppgQueue_;
         Processor::Ppg ppg_;
-        static constexpr size_t hrSamples_ = 100;
-        static constexpr size_t hrSamplesHistory_ = 200;
-        Processor::HeartRate<hrSamples_, hrSamplesHistory_> hr_;
         DataCollector dataCollector_;
-        // buffers, state vars, etc.
-        static constexpr std::size_t serialBufSize_ = 64;
-        char serialBuf_[serialBufSize_]{};
-    private:
-        // configs
-        static constexpr uint8_t sampleRate_ = 50; //< Hz
-        static constexpr auto sampleTime_ = std::chrono::milliseconds(1000 / sampleRate_);
+        // heart rate and sample lines, deadline monitored
+        CycleCounter cycleCounter_;
+        Processor::OutputStage<CycleCounter> outputStage_;
+        // spectrum streaming, one binary record after the sample line completing each heart rate frame
+        bool spectrumStreaming_{};
+        std::array<uint8_t, SpectrumRecord::MaxSize> spectrumRecord_{};
+#endif
+#if defined(CONFIG_PPG_PROFILER)
+        // PC sampling, the ring is drained into binary records from the main loop
+        Profiler::PcSampler pcSampler_;
+        std::array<Profiler::PcSample, ProfileRecord::MaxSamples> pcSamples_{};
+        std::array<uint8_t, ProfileRecord::MaxSize> profileRecord_{};
+#endif
+#if defined(CONFIG_PPG_TRACE)
+        // trace events, the rings are drained into binary records from the main loop
+        std::array<Trace::Record, TraceRecord::MaxEvents> traceEvents_{};
+        std::array<uint8_t, TraceRecord::MaxSize> traceRecord_{};
+#endif
+#if !defined(CONFIG_PPG_COROUTINE_PIPELINE)
+        CommandReader commandReader_;
+#endif
 };
 
-#endif //_PPG_APPLICATION_HPP
\ No newline at end of file
+#endif //_PPG_APPLICATION_HPP
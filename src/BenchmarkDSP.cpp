@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <array>
+#include <span>
 #include <string_view>
 
 #include <zephyr/logging/log.h>
@@ -10,6 +12,12 @@ LOG_MODULE_REGISTER(ppg, LOG_LEVEL_INF);
 #include "Benchmark.hpp"
 #include "CycleCounter.hpp"
 #include "IIRFilter.hpp"
+#include "MovingAverageFilter.hpp"
+#include "MovingMinMax.hpp"
+#include "MovingVariance.hpp"
+#include "FilterChain.hpp"
+#include "MotionCanceller.hpp"
+#include "Resampler.hpp"
 #include "Fft.hpp"
 
 template<typename ArrayT>
@@ -52,6 +60,28 @@ int main()
     LOG_INF("----------------------------------------------------------------");
     LOG_INF(" 3. IIR filter block (Butterworth, 1st order)                   ");
     LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 4. IIR filter in PPG blocks of %3d samples (Butterworth)       ", CONFIG_PPG_FILTER_BLOCK_SIZE);
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 5. IIR + moving average sample-by-sample, virtual IFilter      ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 6. IIR + moving average sample-by-sample, FilterChain          ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 7. Moving average over 64 samples, sample-by-sample            ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 8. Moving min/max over 64 samples, sample-by-sample            ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF(" 9. Moving variance over 64 samples, sample-by-sample           ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF("10. Motion cancellation, 3 axis NLMS with 16 taps, PPG blocks   ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF("11. Resampling jittered 50 Hz samples, linear, sample-by-sample ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF("12. Resampling jittered 50 Hz samples, cubic, sample-by-sample  ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF("13. IIR filter sample-by-sample, inline process (Butterworth)   ");
+    LOG_INF("----------------------------------------------------------------");
+    LOG_INF("14. Moving average over 64 uint16_t samples, sample-by-sample   ");
+    LOG_INF("----------------------------------------------------------------");
     k_msleep(300);
 
     using InputT = std::array<float32_t, 1024>;
@@ -240,8 +270,263 @@ int main()
         LOG_INF("Time = %lld us", time);
         logArray(outputData, "Output data (float32)");
     }
+
+    {
+        // sig.butter(1, [3, 12], btype='bandpass', fs=fs, output='sos')
+        Dsp::IIRFilter<2> filter{{ 0.38823676f, 0.0f, -0.38823676f, 0.8517672f, -0.22352648f }};
+        std::array<float32_t, inputData.size()> outputData{};
+        static constexpr size_t blockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+        LOG_INF("Performing benchmark 4");
+        auto duration = Benchmark::benchmark(cycCounter, [&filter, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); iSample += blockSize)
+            {
+                const auto numSamples = std::min(blockSize, input.size() - iSample);
+                std::span<float32_t> outBlock{outputData.data() + iSample, numSamples};
+                filter.apply(std::span<const float32_t>{input.data() + iSample, numSamples}, outBlock);
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 4 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
     
 
+    {
+        // sig.butter(1, [3, 12], btype='bandpass', fs=fs, output='sos')
+        Dsp::IIRFilter<2> iir{{ 0.38823676f, 0.0f, -0.38823676f, 0.8517672f, -0.22352648f }};
+        Dsp::MovingAverageFilter<4, float32_t> movingAverage;
+        Dsp::IFilter<float32_t>& stage1 = iir;
+        Dsp::IFilter<float32_t>& stage2 = movingAverage;
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 5");
+        auto duration = Benchmark::benchmark(cycCounter, [&stage1, &stage2, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                outputData[iSample] = stage2(stage1(input[iSample]));
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 5 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        // sig.butter(1, [3, 12], btype='bandpass', fs=fs, output='sos')
+        Dsp::FilterChain<Dsp::IIRFilter<2>, Dsp::MovingAverageFilter<4, float32_t>> chain{
+            Dsp::IIRFilter<2>{{ 0.38823676f, 0.0f, -0.38823676f, 0.8517672f, -0.22352648f }}
+            , Dsp::MovingAverageFilter<4, float32_t>{}
+        };
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 6");
+        auto duration = Benchmark::benchmark(cycCounter, [&chain, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                outputData[iSample] = chain(input[iSample]);
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 6 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        Dsp::MovingAverageFilter<64, float32_t> stat;
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 7");
+        auto duration = Benchmark::benchmark(cycCounter, [&stat, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                outputData[iSample] = stat.process(input[iSample]);
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 7 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        Dsp::MovingMinMax<64, float32_t> stat;
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 8");
+        auto duration = Benchmark::benchmark(cycCounter, [&stat, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                stat.push(input[iSample]);
+                outputData[iSample] = stat.max() - stat.min();
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 8 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        Dsp::MovingVariance<64, float32_t> stat;
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 9");
+        auto duration = Benchmark::benchmark(cycCounter, [&stat, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                stat.push(input[iSample]);
+                outputData[iSample] = stat.variance();
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 9 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        static constexpr size_t blockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+        Processor::MotionCanceller<16, blockSize> canceller;
+        // acceleration reference derived from the input, so the filters have something to adapt to
+        std::array<Hardware::Acceleration, inputData.size()> motion{};
+        for(size_t iSample = 0; iSample < inputData.size(); ++iSample)
+        {
+            const auto value = static_cast<float>(inputData[iSample]) * 0.01f;
+            motion[iSample] = Hardware::Acceleration{value, -0.5f * value, 9.81f + value};
+        }
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 10");
+        auto duration = Benchmark::benchmark(cycCounter, [&canceller, &motion, &outputData](const InputT& input) {
+            std::copy(input.begin(), input.end(), outputData.begin());
+            for(size_t iSample = 0; iSample + blockSize <= input.size(); iSample += blockSize)
+            {
+                canceller.process(std::span<const Hardware::Acceleration>{motion.data() + iSample, blockSize}
+                                , std::span<float32_t>{outputData.data() + iSample, blockSize});
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 10 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    // timestamps of a 50 Hz workqueue sampler, 20 ms +/- one 32768 Hz tick and every 100th sample dropped
+    std::array<uint64_t, inputData.size()> timestamps{};
+    for(size_t iSample = 1; iSample < timestamps.size(); ++iSample)
+    {
+        static constexpr uint64_t jitterUs[] = {20020, 20019, 19989, 20050};
+        timestamps[iSample] = timestamps[iSample - 1] + jitterUs[iSample % 4] * (iSample % 100 == 0 ? 2 : 1);
+    }
+
+    {
+        Dsp::Resampler<Dsp::Interpolation::Linear> resampler{50, std::chrono::milliseconds(1000)};
+        std::array<float32_t, inputData.size() + 16> outputData{};
+        size_t numOutput = 0;
+        LOG_INF("Performing benchmark 11");
+        auto duration = Benchmark::benchmark(cycCounter, [&resampler, &timestamps, &outputData, &numOutput](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                resampler.process(timestamps[iSample], input[iSample], [&outputData, &numOutput](const float32_t sample) {
+                    outputData[numOutput++] = sample;
+                });
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 11 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        LOG_INF("Output samples = %u, filled = %u", numOutput, resampler.getNumFilled());
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        Dsp::Resampler<Dsp::Interpolation::Cubic> resampler{50, std::chrono::milliseconds(1000)};
+        std::array<float32_t, inputData.size() + 16> outputData{};
+        size_t numOutput = 0;
+        LOG_INF("Performing benchmark 12");
+        auto duration = Benchmark::benchmark(cycCounter, [&resampler, &timestamps, &outputData, &numOutput](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                resampler.process(timestamps[iSample], input[iSample], [&outputData, &numOutput](const float32_t sample) {
+                    outputData[numOutput++] = sample;
+                });
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 12 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        LOG_INF("Output samples = %u, filled = %u", numOutput, resampler.getNumFilled());
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        // same filter as benchmark 2, single sample step inline instead of the block kernel
+        Dsp::IIRFilter<2> filter{{ 0.38823676f, 0.0f, -0.38823676f, 0.8517672f, -0.22352648f }};
+        std::array<float32_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 13");
+        auto duration = Benchmark::benchmark(cycCounter, [&filter, &outputData](const InputT& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                outputData[iSample] = filter.process(input[iSample]);
+            }
+        }, inputData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 13 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (float32)");
+    }
+
+    {
+        // integer path of benchmark 7: 64-bit sum and shift, on proximity-like counts
+        std::array<uint16_t, inputData.size()> rawData{};
+        std::transform(inputData.begin(), inputData.end(), rawData.begin(), [](const float32_t sample) {
+            return static_cast<uint16_t>(sample + 1000.0f);
+        });
+        Dsp::MovingAverageFilter<64, uint16_t> stat;
+        std::array<uint16_t, inputData.size()> outputData{};
+        LOG_INF("Performing benchmark 14");
+        auto duration = Benchmark::benchmark(cycCounter, [&stat, &outputData](const std::array<uint16_t, inputData.size()>& input) {
+            for(size_t iSample = 0; iSample < input.size(); ++iSample)
+            {
+                outputData[iSample] = stat.process(input[iSample]);
+            }
+        }, rawData);
+        auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        auto time = 1000000U * ticks / CycleCounter::period::den;
+        LOG_INF("Benchmark 14 done");
+        LOG_INF("Execution time");
+        LOG_INF("Ticks = %lld", ticks);
+        LOG_INF("Time = %lld us", time);
+        logArray(outputData, "Output data (uint16)");
+    }
+
     while(true) { k_msleep(100); }
 
     return 0;
@@ -0,0 +1,43 @@
+#ifndef _PPG_CLOCK_HPP
+#define _PPG_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// Time sources handed to the pipeline components, so they don't call the kernel directly:
+// Hardware::SystemClock and Hardware::Timer on the device, Hardware::VirtualClock and Hardware::VirtualTimer
+// (VirtualTime.hpp) for runs faster than real time on host and native_sim
+namespace Hardware
+{
+    class IClock
+    {
+        public:
+            virtual ~IClock() = default;
+            // monotonic time of the sample timestamps
+            virtual uint64_t nowUs() = 0;
+    };
+
+    class ITimer
+    {
+        public:
+            using CallbackT = std::function<void()>;
+        public:
+            virtual ~ITimer() = default;
+
+            // calls the callback every period, the first time one period after start,
+            // from the system workqueue, or from the expiry ISR with inIsr
+            template< class Rep, class Period >
+            void start(const std::chrono::duration<Rep, Period>& period, const CallbackT& callback, bool inIsr = false)
+            {
+                startPeriodic(std::chrono::microseconds(period), callback, inIsr);
+            }
+
+            // no callback runs after stop returns
+            virtual void stop() = 0;
+        protected:
+            virtual void startPeriodic(const std::chrono::microseconds& period, const CallbackT& callback, bool inIsr) = 0;
+    };
+}
+
+#endif //_PPG_CLOCK_HPP
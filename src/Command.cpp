@@ -0,0 +1,44 @@
+#include "Command.hpp"
+
+#include <charconv>
+
+std::optional<CommandReader::Command> CommandReader::feed(const std::byte byte)
+{
+    const auto c = static_cast<char>(byte);
+    if(c != '\n' && c != '\r')
+    {
+        if(lineLength_ < line_.size())
+        {
+            line_[lineLength_++] = c;
+        }
+        else
+        {
+            overflow_ = true;
+        }
+        return {};
+    }
+    // end of line, parse `<name> [<arg>]`
+    const std::string_view line{line_.data(), lineLength_};
+    const bool overflow = overflow_;
+    lineLength_ = 0;
+    overflow_ = false;
+    if(line.empty() || overflow)
+    {
+        return {};
+    }
+    Command command{};
+    const auto iSpace = line.find(' ');
+    command.name = line.substr(0, iSpace);
+    if(iSpace != std::string_view::npos)
+    {
+        const auto argStr = line.substr(iSpace + 1);
+        int32_t arg{};
+        const auto [ptr, ec] = std::from_chars(argStr.data(), argStr.data() + argStr.size(), arg);
+        if(ec != std::errc{} || ptr != argStr.data() + argStr.size())
+        {
+            return {};
+        }
+        command.arg = arg;
+    }
+    return command;
+}
@@ -0,0 +1,29 @@
+#ifndef _PPG_COMMAND_HPP
+#define _PPG_COMMAND_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Text commands received over serial, one per line: `<name> [<integer argument>]`
+class CommandReader
+{
+    public:
+        struct Command
+        {
+            std::string_view name; //< valid until the next call to feed()
+            std::optional<int32_t> arg;
+        };
+    public:
+        // feeds one received byte, returns the command once its line is complete
+        std::optional<Command> feed(const std::byte byte);
+    private:
+        static constexpr std::size_t maxLineLength_ = 32;
+        std::array<char, maxLineLength_> line_{};
+        std::size_t lineLength_{};
+        bool overflow_{};
+};
+
+#endif //_PPG_COMMAND_HPP
@@ -0,0 +1,135 @@
+#include "CoroPipeline.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(ppg);
+
+namespace Processor
+{
+    CoroPipeline::CoroPipeline(Hardware::IProximity& sensor, Hardware::Serial& serial, Hardware::IClock& clock, IPipelineProfile& profile)
+        : sensor_{sensor}
+        , serial_{serial}
+        , clock_{clock}
+        , profile_{profile}
+        , scheduler_{}
+        , ticker_{scheduler_}
+        , raw_{scheduler_}
+        , filtered_{scheduler_}
+        , output_{scheduler_}
+    { }
+
+    bool CoroPipeline::start()
+    {
+        // stages can be reordered or new ones inserted, as long as the channels connect them
+        stages_ = {acquire(), filter(), analyze(), serialize()};
+        for(const auto& stage : stages_)
+        {
+            if(!scheduler_.spawn(stage))
+            {
+                LOG_ERR("Coroutine frame pool too small for pipeline stages");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CoroPipeline::run()
+    {
+        using namespace std::chrono_literals;
+        profile_.reset();
+        ticker_.start(profile_.sampleTime());
+        // woken at least every 100 ms, so a disconnect is noticed while no sample arrives
+        while(serial_.isOpen())
+        {
+            scheduler_.runUntilIdle();
+            scheduler_.waitFor(100ms);
+        }
+        ticker_.stop();
+    }
+
+    uint32_t CoroPipeline::getNumMissedTicks() const
+    {
+        return ticker_.getNumMissed();
+    }
+
+    Coro::Task CoroPipeline::acquire()
+    {
+        while(true)
+        {
+            co_await ticker_.next();
+            const auto proximity = sensor_.getProximity();
+            if(!proximity.has_value())
+            {
+                LOG_WRN("Couldn't measure ppg");
+                continue;
+            }
+            PpgMeasurement measurement{};
+            measurement.timestamp = clock_.nowUs();
+            measurement.raw = proximity.value();
+            co_await raw_.send(measurement);
+        }
+    }
+
+    Coro::Task CoroPipeline::filter()
+    {
+        std::array<PpgMeasurement, BlockSize> block{};
+        std::array<float32_t, BlockSize> rawBlock{};
+        std::array<float32_t, BlockSize> filteredBlock{};
+        bool primed = false;
+        while(true)
+        {
+            for(std::size_t iSample = 0; iSample < BlockSize; ++iSample)
+            {
+                block[iSample] = co_await raw_.receive();
+                rawBlock[iSample] = block[iSample].raw;
+            }
+            if(!primed)
+            {
+                profile_.filter().prime(rawBlock[0]);
+                primed = true;
+            }
+            profile_.filter().process(std::span<const float32_t>{rawBlock}, std::span<float32_t>{filteredBlock});
+            for(std::size_t iSample = 0; iSample < BlockSize; ++iSample)
+            {
+                block[iSample].filtered = filteredBlock[iSample];
+                co_await filtered_.send(block[iSample]);
+            }
+        }
+    }
+
+    Coro::Task CoroPipeline::analyze()
+    {
+        while(true)
+        {
+            const auto measurement = co_await filtered_.receive();
+            const auto bpm = profile_.processHr(measurement);
+            co_await output_.send(Output{measurement, bpm});
+        }
+    }
+
+    Coro::Task CoroPipeline::serialize()
+    {
+        char buf[64];
+        while(true)
+        {
+            const auto output = co_await output_.receive();
+            if(!serial_.isOpen())
+            {
+                continue; //< disconnected, run returns and stops sampling
+            }
+            const auto len = snprintf(buf, sizeof(buf)
+                                    , "%" PRIu64 ",%d,%d,%d\r\n"
+                                    , output.measurement.timestamp
+                                    , output.measurement.raw
+                                    , output.measurement.filtered
+                                    , output.bpm);
+            serial_.write(reinterpret_cast<std::byte*>(buf), len);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef _PPG_CORO_PIPELINE_HPP
+#define _PPG_CORO_PIPELINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Clock.hpp"
+#include "Coroutine.hpp"
+#include "CoroTicker.hpp"
+#include "IProximity.hpp"
+#include "Serial.hpp"
+#include "PipelineProfile.hpp"
+#include "PpgMeasurement.hpp"
+
+namespace Processor
+{
+    // PPG pipeline as coroutine stages on one scheduler thread:
+    // acquisition -> filtering -> heart rate -> serial output, connected by bounded channels
+    class CoroPipeline
+    {
+        public:
+            static constexpr std::size_t BlockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+            static constexpr std::size_t ChannelCapacity = 2 * BlockSize;
+        public:
+            CoroPipeline(Hardware::IProximity& sensor, Hardware::Serial& serial, Hardware::IClock& clock, IPipelineProfile& profile);
+            // creates the stages, returns false if the frame pool is too small
+            bool start();
+            // samples and runs the stages while the serial port is open,
+            // returns with sampling stopped once it closes
+            void run();
+            uint32_t getNumMissedTicks() const;
+        private:
+            struct Output
+            {
+                PpgMeasurement measurement;
+                uint8_t bpm;
+            };
+            Coro::Task acquire();
+            Coro::Task filter();
+            Coro::Task analyze();
+            Coro::Task serialize();
+        private:
+            Hardware::IProximity& sensor_;
+            Hardware::Serial& serial_;
+            Hardware::IClock& clock_;
+            IPipelineProfile& profile_;
+            Coro::Scheduler scheduler_;
+            Coro::Ticker ticker_;
+            Coro::Channel<PpgMeasurement, ChannelCapacity> raw_;
+            Coro::Channel<PpgMeasurement, ChannelCapacity> filtered_;
+            Coro::Channel<Output, ChannelCapacity> output_;
+            std::array<Coro::Task, 4> stages_;
+    };
+}
+
+#endif //_PPG_CORO_PIPELINE_HPP
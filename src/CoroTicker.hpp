@@ -0,0 +1,128 @@
+#ifndef _PPG_CORO_TICKER_HPP
+#define _PPG_CORO_TICKER_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include "Coroutine.hpp"
+
+namespace Coro
+{
+    // Periodic kernel timer a coroutine can wait for with co_await ticker.next().
+    // Expiries while the coroutine is busy are kept and resumed immediately, missed ones are counted.
+    class Ticker
+    {
+        public:
+            Ticker(Scheduler& scheduler)
+                : scheduler_{scheduler}
+            {
+                k_timer_init(&timer_, &Ticker::expiryFunction, NULL);
+                k_timer_user_data_set(&timer_, this);
+            }
+
+            Ticker(const Ticker&) = delete;
+            Ticker& operator=(const Ticker&) = delete;
+
+            ~Ticker()
+            {
+                k_timer_stop(&timer_);
+            }
+
+            template <class Rep, class Period>
+            void start(const std::chrono::duration<Rep, Period>& period)
+            {
+                const auto periodUs = std::chrono::microseconds(period).count();
+                k_timer_start(&timer_, K_USEC(periodUs), K_USEC(periodUs));
+            }
+
+            void stop()
+            {
+                k_timer_stop(&timer_);
+                const k_spinlock_key_t key = k_spin_lock(&lock_);
+                numPending_ = 0;
+                k_spin_unlock(&lock_, key);
+            }
+
+            auto next()
+            {
+                struct Awaiter
+                {
+                    Ticker& ticker;
+                    bool await_ready() noexcept
+                    {
+                        return ticker.takePending();
+                    }
+                    bool await_suspend(std::coroutine_handle<> handle) noexcept
+                    {
+                        // the timer may have expired since await_ready
+                        const k_spinlock_key_t key = k_spin_lock(&ticker.lock_);
+                        const bool suspend = ticker.numPending_ == 0;
+                        if(suspend)
+                        {
+                            ticker.waiting_ = handle;
+                        }
+                        else
+                        {
+                            ticker.numPending_--;
+                        }
+                        k_spin_unlock(&ticker.lock_, key);
+                        return suspend;
+                    }
+                    void await_resume() noexcept { }
+                };
+                return Awaiter{*this};
+            }
+
+            uint32_t getNumMissed() const
+            {
+                return numMissed_;
+            }
+        private:
+            bool takePending()
+            {
+                const k_spinlock_key_t key = k_spin_lock(&lock_);
+                const bool pending = numPending_ > 0;
+                if(pending)
+                {
+                    numPending_--;
+                }
+                k_spin_unlock(&lock_, key);
+                return pending;
+            }
+
+            static void expiryFunction(k_timer* timer)
+            {
+                auto& ticker = *static_cast<Ticker*>(k_timer_user_data_get(timer));
+                const k_spinlock_key_t key = k_spin_lock(&ticker.lock_);
+                const auto waiting = ticker.waiting_;
+                ticker.waiting_ = {};
+                if(!waiting)
+                {
+                    // coroutine is still busy with a previous tick
+                    ticker.numPending_++;
+                    if(ticker.numPending_ > 1)
+                    {
+                        ticker.numMissed_++;
+                    }
+                }
+                k_spin_unlock(&ticker.lock_, key);
+                if(waiting)
+                {
+                    ticker.scheduler_.post(waiting);
+                }
+            }
+        private:
+            Scheduler& scheduler_;
+            k_timer timer_;
+            k_spinlock lock_{};
+            std::coroutine_handle<> waiting_{};
+            uint32_t numPending_{};
+            uint32_t numMissed_{};
+    };
+}
+
+#endif //_PPG_CORO_TICKER_HPP
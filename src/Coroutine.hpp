@@ -0,0 +1,358 @@
+#ifndef _PPG_COROUTINE_HPP
+#define _PPG_COROUTINE_HPP
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+
+#if defined(__ZEPHYR__)
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Allocation-free C++20 coroutines for pipeline stages.
+// Coroutine frames come from a static pool, the scheduler resumes ready coroutines on one thread,
+// and stages exchange values through bounded channels.
+namespace Coro
+{
+#if defined(CONFIG_PPG_CORO_NUM_FRAMES)
+    inline constexpr std::size_t NumFrames = CONFIG_PPG_CORO_NUM_FRAMES;
+    inline constexpr std::size_t FrameSize = CONFIG_PPG_CORO_FRAME_SIZE;
+#else
+    inline constexpr std::size_t NumFrames = 16;
+    inline constexpr std::size_t FrameSize = 512;
+#endif
+
+    // fixed size slots for coroutine frames, frames are created and destroyed on the scheduler thread
+    class FramePool
+    {
+        public:
+            static void* allocate(const std::size_t size) noexcept
+            {
+                if(size > FrameSize)
+                {
+                    return nullptr;
+                }
+                for(std::size_t iFrame = 0; iFrame < NumFrames; ++iFrame)
+                {
+                    if(!used_[iFrame])
+                    {
+                        used_[iFrame] = true;
+                        return frames_[iFrame].data();
+                    }
+                }
+                return nullptr;
+            }
+
+            static void deallocate(void* frame) noexcept
+            {
+                for(std::size_t iFrame = 0; iFrame < NumFrames; ++iFrame)
+                {
+                    if(frames_[iFrame].data() == frame)
+                    {
+                        used_[iFrame] = false;
+                    }
+                }
+            }
+
+            static std::size_t numUsed() noexcept
+            {
+                std::size_t numUsed = 0;
+                for(const auto used : used_)
+                {
+                    numUsed += used;
+                }
+                return numUsed;
+            }
+        private:
+            struct alignas(std::max_align_t) Frame
+            {
+                std::byte bytes[FrameSize];
+                void* data() { return bytes; }
+            };
+            static inline std::array<Frame, NumFrames> frames_{};
+            static inline std::array<bool, NumFrames> used_{};
+    };
+
+    // Coroutine started suspended, the scheduler resumes it. Owns the frame.
+    // A task whose frame didn't fit the pool is invalid, check with isValid().
+    class Task
+    {
+        public:
+            struct promise_type
+            {
+                Task get_return_object() noexcept
+                {
+                    return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                static Task get_return_object_on_allocation_failure() noexcept
+                {
+                    return Task{};
+                }
+                static void* operator new(const std::size_t size) noexcept
+                {
+                    return FramePool::allocate(size);
+                }
+                static void operator delete(void* frame) noexcept
+                {
+                    FramePool::deallocate(frame);
+                }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always final_suspend() noexcept { return {}; }
+                void return_void() noexcept { }
+                void unhandled_exception() noexcept { }
+            };
+        public:
+            Task() = default;
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+            Task(Task&& other) noexcept
+                : handle_{std::exchange(other.handle_, {})}
+            { }
+            Task& operator=(Task&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    destroy();
+                    handle_ = std::exchange(other.handle_, {});
+                }
+                return *this;
+            }
+            ~Task()
+            {
+                destroy();
+            }
+
+            bool isValid() const { return static_cast<bool>(handle_); }
+            bool isDone() const { return handle_ && handle_.done(); }
+            std::coroutine_handle<> handle() const { return handle_; }
+        private:
+            explicit Task(std::coroutine_handle<promise_type> handle)
+                : handle_{handle}
+            { }
+
+            void destroy()
+            {
+                if(handle_)
+                {
+                    handle_.destroy();
+                    handle_ = {};
+                }
+            }
+        private:
+            std::coroutine_handle<promise_type> handle_{};
+    };
+
+    // Resumes ready coroutines in FIFO order on the thread calling run.
+    // post may be called from other threads and on Zephyr from ISRs, e.g. timer expiry.
+    class Scheduler
+    {
+        public:
+            static constexpr std::size_t Capacity = NumFrames; //< a coroutine is queued at most once
+        public:
+#if defined(__ZEPHYR__)
+            Scheduler()
+            {
+                k_sem_init(&wake_, 0, 1);
+            }
+#endif
+
+            // queues the task to run, returns false if the task is invalid
+            bool spawn(const Task& task)
+            {
+                if(!task.isValid())
+                {
+                    return false;
+                }
+                return post(task.handle());
+            }
+
+            bool post(std::coroutine_handle<> handle)
+            {
+                bool posted = false;
+                {
+#if defined(__ZEPHYR__)
+                    const k_spinlock_key_t key = k_spin_lock(&lock_);
+#else
+                    std::lock_guard lock{mutex_};
+#endif
+                    if(numReady_ < Capacity)
+                    {
+                        ready_[(iFirst_ + numReady_) % Capacity] = handle;
+                        numReady_++;
+                        posted = true;
+                    }
+#if defined(__ZEPHYR__)
+                    k_spin_unlock(&lock_, key);
+#endif
+                }
+#if defined(__ZEPHYR__)
+                k_sem_give(&wake_);
+#else
+                wake_.notify_one();
+#endif
+                return posted;
+            }
+
+            // resumes ready coroutines until none is ready, returns number of resumes
+            std::size_t runUntilIdle()
+            {
+                std::size_t numResumed = 0;
+                while(true)
+                {
+                    const auto handle = pop();
+                    if(!handle.has_value())
+                    {
+                        return numResumed;
+                    }
+                    handle.value().resume();
+                    numResumed++;
+                }
+            }
+
+            // sleeps until a coroutine is ready or the timeout passes, returns false on timeout
+            template <class Rep, class Period>
+            bool waitFor(const std::chrono::duration<Rep, Period>& timeout)
+            {
+#if defined(__ZEPHYR__)
+                return k_sem_take(&wake_, K_USEC(std::chrono::microseconds(timeout).count())) == 0;
+#else
+                std::unique_lock lock{mutex_};
+                return wake_.wait_for(lock, timeout, [this] { return numReady_ > 0; });
+#endif
+            }
+
+            // resumes coroutines forever, sleeps while none is ready
+            [[noreturn]] void run()
+            {
+                while(true)
+                {
+                    runUntilIdle();
+                    wait();
+                }
+            }
+        private:
+            std::optional<std::coroutine_handle<>> pop()
+            {
+                std::optional<std::coroutine_handle<>> handle;
+#if defined(__ZEPHYR__)
+                const k_spinlock_key_t key = k_spin_lock(&lock_);
+#else
+                std::lock_guard lock{mutex_};
+#endif
+                if(numReady_ > 0)
+                {
+                    handle = ready_[iFirst_];
+                    iFirst_ = (iFirst_ + 1) % Capacity;
+                    numReady_--;
+                }
+#if defined(__ZEPHYR__)
+                k_spin_unlock(&lock_, key);
+#endif
+                return handle;
+            }
+
+            void wait()
+            {
+#if defined(__ZEPHYR__)
+                k_sem_take(&wake_, K_FOREVER);
+#else
+                std::unique_lock lock{mutex_};
+                wake_.wait(lock, [this] { return numReady_ > 0; });
+#endif
+            }
+        private:
+            std::array<std::coroutine_handle<>, Capacity> ready_{};
+            std::size_t iFirst_{};
+            std::size_t numReady_{};
+#if defined(__ZEPHYR__)
+            k_spinlock lock_{};
+            k_sem wake_;
+#else
+            std::mutex mutex_;
+            std::condition_variable wake_;
+#endif
+    };
+
+    // Bounded single producer, single consumer channel between two coroutines on the same scheduler.
+    // send suspends while the channel is full, receive suspends while it is empty.
+    template <typename T, std::size_t Capacity>
+    class Channel
+    {
+        public:
+            Channel(Scheduler& scheduler)
+                : scheduler_{scheduler}
+            {
+                static_assert(Capacity > 0, "Channel capacity must be > 0");
+            }
+
+            auto send(const T& value)
+            {
+                struct Awaiter
+                {
+                    Channel& channel;
+                    T value;
+                    bool await_ready() const noexcept { return channel.numItems_ < Capacity; }
+                    void await_suspend(std::coroutine_handle<> handle) noexcept { channel.sender_ = handle; }
+                    void await_resume() noexcept { channel.push(value); }
+                };
+                return Awaiter{*this, value};
+            }
+
+            auto receive()
+            {
+                struct Awaiter
+                {
+                    Channel& channel;
+                    bool await_ready() const noexcept { return channel.numItems_ > 0; }
+                    void await_suspend(std::coroutine_handle<> handle) noexcept { channel.receiver_ = handle; }
+                    T await_resume() noexcept { return channel.pop(); }
+                };
+                return Awaiter{*this};
+            }
+
+            std::size_t size() const
+            {
+                return numItems_;
+            }
+        private:
+            void push(const T& value)
+            {
+                items_[(iFirst_ + numItems_) % Capacity] = value;
+                numItems_++;
+                if(receiver_)
+                {
+                    scheduler_.post(std::exchange(receiver_, {}));
+                }
+            }
+
+            T pop()
+            {
+                T value = items_[iFirst_];
+                iFirst_ = (iFirst_ + 1) % Capacity;
+                numItems_--;
+                if(sender_)
+                {
+                    scheduler_.post(std::exchange(sender_, {}));
+                }
+                return value;
+            }
+        private:
+            Scheduler& scheduler_;
+            std::array<T, Capacity> items_{};
+            std::size_t iFirst_{};
+            std::size_t numItems_{};
+            std::coroutine_handle<> sender_{};
+            std::coroutine_handle<> receiver_{};
+    };
+}
+
+#endif //_PPG_COROUTINE_HPP
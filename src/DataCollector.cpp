@@ -1,16 +1,18 @@
 #include "DataCollector.hpp"
 
-#include <zephyr/kernel.h>
-#include <zephyr/logging/log.h>
+#include "Log.hpp"
 
 LOG_MODULE_DECLARE(ppg);
 
-DataCollector::DataCollector(Processor::Ppg& ppg)
+DataCollector::DataCollector(Processor::Ppg& ppg, Hardware::IClock& clock, Hardware::ITimer& sampleTimer)
     : ppg_{ppg}
+    , clock_{clock}
+    , sampleTimer_{sampleTimer}
 { }
 
 void DataCollector::start(const std::chrono::milliseconds& samplingTime)
 {
+    ppg_.reset();
     sampleTimer_.start(samplingTime, [this] { collectData(); });
 }
 
@@ -21,9 +23,7 @@ void DataCollector::stop()
 
 void DataCollector::collectData()
 {
-    auto timestamp = static_cast<uint64_t>(k_cycle_get_32()) * 1000000U
-                    / sys_clock_hw_cycles_per_sec();
-    if(!ppg_.measure(timestamp))
+    if(!ppg_.measure(clock_.nowUs()))
     {
         LOG_WRN("Couldn't measure ppg");
     }
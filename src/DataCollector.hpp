@@ -3,20 +3,22 @@
 
 #include <chrono>
 
-#include "Timer.hpp"
+#include "Clock.hpp"
 #include "PpgProcessor.hpp"
 
 class DataCollector
 {
     public:
-        DataCollector(Processor::Ppg& ppg);
+        // the clock timestamps the samples, the timer paces the sampling
+        DataCollector(Processor::Ppg& ppg, Hardware::IClock& clock, Hardware::ITimer& sampleTimer);
         void start(const std::chrono::milliseconds& samplingTime);
         void stop();
     private:
         void collectData();
     private:
-        Hardware::Timer sampleTimer_;
         Processor::Ppg& ppg_;
+        Hardware::IClock& clock_;
+        Hardware::ITimer& sampleTimer_;
 };
 
 #endif //_PPG_DATA_COLLECTOR_HPP
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef _PPG_DEADLINE_MONITOR_HPP
+#define _PPG_DEADLINE_MONITOR_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Checks that the work of every sample period fits in its execution budget, measured with a cycle counter.
+// The monitor switches to degraded mode on a deadline miss or when the sample backlog grows,
+// and back to normal after RecoveryPeriods periods in a row with headroom (at most half the budget used)
+// and no backlog beyond the low watermark.
+template <typename CounterT>
+class DeadlineMonitor
+{
+    public:
+        using duration = typename CounterT::duration;
+        enum class Mode
+        {
+            Normal,
+            Degraded,
+        };
+        struct Stats
+        {
+            uint32_t periods;
+            uint32_t overruns;
+            uint32_t transitions;
+            duration worst;
+        };
+    public:
+        DeadlineMonitor(CounterT& counter, const uint32_t recoveryPeriods
+                        , const std::size_t highBacklog, const std::size_t lowBacklog)
+            : counter_{counter}
+            , recoveryPeriods_{recoveryPeriods}
+            , highBacklog_{highBacklog}
+            , lowBacklog_{lowBacklog}
+            , budget_{}
+            , start_{}
+            , stats_{}
+            , calmPeriods_{}
+            , mode_{Mode::Normal}
+            , modeChanged_{}
+        { }
+
+        template <typename Rep, typename Period>
+        void setBudget(const std::chrono::duration<Rep, Period>& budget)
+        {
+            budget_ = std::chrono::duration_cast<duration>(budget);
+        }
+
+        void begin()
+        {
+            start_ = counter_.now();
+        }
+
+        // ends the period, backlog is the number of samples still waiting, returns true on deadline miss
+        bool end(const std::size_t backlog)
+        {
+            const duration elapsed = counter_.now() - start_;
+            stats_.periods++;
+            stats_.worst = std::max(stats_.worst, elapsed);
+            const bool missed = elapsed > budget_;
+            if(missed)
+            {
+                stats_.overruns++;
+            }
+            if(missed || backlog > highBacklog_)
+            {
+                calmPeriods_ = 0;
+                setMode(Mode::Degraded);
+            }
+            else if(mode_ == Mode::Degraded && 2 * elapsed <= budget_ && backlog <= lowBacklog_)
+            {
+                if(++calmPeriods_ >= recoveryPeriods_)
+                {
+                    setMode(Mode::Normal);
+                }
+            }
+            else
+            {
+                calmPeriods_ = 0;
+            }
+            return missed;
+        }
+
+        Mode mode() const
+        {
+            return mode_;
+        }
+
+        // true once after every mode change
+        bool modeChanged()
+        {
+            return std::exchange(modeChanged_, false);
+        }
+
+        const Stats& stats() const
+        {
+            return stats_;
+        }
+
+        duration budget() const
+        {
+            return budget_;
+        }
+
+        void reset()
+        {
+            stats_ = Stats{};
+            calmPeriods_ = 0;
+            setMode(Mode::Normal);
+        }
+    private:
+        void setMode(const Mode mode)
+        {
+            if(mode_ != mode)
+            {
+                mode_ = mode;
+                modeChanged_ = true;
+                stats_.transitions++;
+            }
+        }
+    private:
+        CounterT& counter_;
+        uint32_t recoveryPeriods_;
+        std::size_t highBacklog_;
+        std::size_t lowBacklog_;
+        duration budget_;
+        typename CounterT::time_point start_;
+        Stats stats_;
+        uint32_t calmPeriods_;
+        Mode mode_;
+        bool modeChanged_;
+};
+
+#endif //_PPG_DEADLINE_MONITOR_HPP
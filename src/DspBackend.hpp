@@ -0,0 +1,16 @@
+#ifndef _PPG_DSP_BACKEND_HPP
+#define _PPG_DSP_BACKEND_HPP
+
+// Selects the DSP kernels used by the Dsp:: classes.
+// Firmware builds use CMSIS-DSP, host builds use portable C++ with SIMD where available.
+// Every backend provides in Dsp::Backend:
+//   BiquadCascade      - direct form II transposed biquad cascade, CMSIS coefficient layout
+//   RealFft<Length>    - real FFT with CMSIS arm_rfft_fast_f32 output packing, and its inverse
+//   cmplxMagSquared    - squared magnitude of interleaved complex samples
+#if defined(CONFIG_CMSIS_DSP)
+#include "DspBackendCmsis.hpp"
+#else
+#include "DspBackendHost.hpp"
+#endif
+
+#endif //_PPG_DSP_BACKEND_HPP
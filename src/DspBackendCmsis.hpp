@@ -0,0 +1,129 @@
+#ifndef _PPG_DSP_BACKEND_CMSIS_HPP
+#define _PPG_DSP_BACKEND_CMSIS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <arm_math.h>
+#include <arm_common_tables.h>
+
+#include "FftTables.hpp"
+
+namespace Dsp::Backend
+{
+    class BiquadCascade
+    {
+        public:
+            BiquadCascade(const size_t numSections, float32_t* states, const float32_t* coeffs)
+                : inst_{static_cast<uint8_t>(numSections), states, coeffs}
+            { }
+
+            void process(const float32_t* in, float32_t* out, const uint32_t blockSize)
+            {
+                arm_biquad_cascade_df2T_f32(&inst_, in, out, blockSize);
+            }
+        private:
+            arm_biquad_cascade_df2T_instance_f32 inst_; //< CMSIS-DSP filter instance
+    };
+
+    // normalized LMS adaptive filter, states must hold numTaps + blockSize - 1 values
+    class NormalizedLms
+    {
+        public:
+            NormalizedLms(const size_t numTaps, float32_t* coeffs, float32_t* states
+                        , const float32_t mu, const uint32_t blockSize)
+            {
+                arm_lms_norm_init_f32(&inst_, static_cast<uint16_t>(numTaps), coeffs, states, mu, blockSize);
+            }
+
+            // err may alias ref
+            void process(const float32_t* in, float32_t* ref, float32_t* out, float32_t* err, const uint32_t blockSize)
+            {
+                arm_lms_norm_f32(&inst_, in, ref, out, err, blockSize);
+            }
+        private:
+            arm_lms_norm_instance_f32 inst_; //< CMSIS-DSP filter instance
+    };
+
+    // CMSIS-DSP bit reversal table of a complex FFT, the radix-8 based layout isn't generated here.
+    // Only the tables enabled with ARM_TABLE_BITREVIDX_FLT_<N> (CMakeLists.txt) are built,
+    // lengths without a specialisation fail to compile.
+    template <uint16_t CfftLength>
+    struct BitRevTable;
+
+#define PPG_CMSIS_BIT_REV_TABLE(LENGTH) \
+    template <> \
+    struct BitRevTable<LENGTH> \
+    { \
+        static constexpr const uint16_t* table = armBitRevIndexTable##LENGTH; \
+        static constexpr uint16_t length = ARMBITREVINDEXTABLE_##LENGTH##_TABLE_LENGTH; \
+    };
+
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_16)
+    PPG_CMSIS_BIT_REV_TABLE(16)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_32)
+    PPG_CMSIS_BIT_REV_TABLE(32)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_64)
+    PPG_CMSIS_BIT_REV_TABLE(64)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_128)
+    PPG_CMSIS_BIT_REV_TABLE(128)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_256)
+    PPG_CMSIS_BIT_REV_TABLE(256)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_512)
+    PPG_CMSIS_BIT_REV_TABLE(512)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_1024)
+    PPG_CMSIS_BIT_REV_TABLE(1024)
+#endif
+#if defined(ARM_ALL_FFT_TABLES) || defined(ARM_TABLE_BITREVIDX_FLT_2048)
+    PPG_CMSIS_BIT_REV_TABLE(2048)
+#endif
+
+#undef PPG_CMSIS_BIT_REV_TABLE
+
+    template <uint16_t Length>
+    class RealFft
+    {
+        private:
+            using Tables = FftTables<Length>;
+            using BitRev = BitRevTable<Tables::CfftLength>;
+        public:
+            // same fields as arm_rfft_fast_init_f32 sets, but pointing to the tables of this length only,
+            // the init function references the tables of every length
+            RealFft()
+            {
+                inst_.Sint.fftLen = Tables::CfftLength;
+                inst_.Sint.pTwiddle = Tables::cfftTwiddle.data();
+                inst_.Sint.pBitRevTable = BitRev::table;
+                inst_.Sint.bitRevLength = BitRev::length;
+                inst_.fftLenRFFT = Length;
+                inst_.pTwiddleRFFT = Tables::rfftTwiddle.data();
+            }
+
+            // input is used as scratch memory and is modified
+            void forward(float32_t* in, float32_t* out)
+            {
+                arm_rfft_fast_f32(&inst_, in, out, 0);
+            }
+
+            // inverse of forward, including the 1/Length scaling, input is modified as well
+            void inverse(float32_t* in, float32_t* out)
+            {
+                arm_rfft_fast_f32(&inst_, in, out, 1);
+            }
+        private:
+            arm_rfft_fast_instance_f32 inst_;
+    };
+
+    inline void cmplxMagSquared(const float32_t* in, float32_t* out, const uint32_t numSamples)
+    {
+        arm_cmplx_mag_squared_f32(in, out, numSamples);
+    }
+}
+
+#endif //_PPG_DSP_BACKEND_CMSIS_HPP
@@ -0,0 +1,263 @@
+#ifndef _PPG_DSP_BACKEND_HOST_HPP
+#define _PPG_DSP_BACKEND_HOST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "FftTables.hpp"
+
+using float32_t = float; //< same name as in CMSIS-DSP
+
+namespace Dsp::Backend
+{
+    // direct form II transposed, same arithmetic as arm_biquad_cascade_df2T_f32
+    class BiquadCascade
+    {
+        public:
+            BiquadCascade(const size_t numSections, float32_t* states, const float32_t* coeffs)
+                : numSections_{numSections}
+                , states_{states}
+                , coeffs_{coeffs}
+            { }
+
+            void process(const float32_t* in, float32_t* out, const uint32_t blockSize)
+            {
+                const float32_t* sectionIn = in;
+                for(size_t iSection = 0; iSection < numSections_; ++iSection)
+                {
+                    const float32_t* c = coeffs_ + 5 * iSection;
+                    const float32_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+                    float32_t d1 = states_[2 * iSection];
+                    float32_t d2 = states_[2 * iSection + 1];
+                    for(uint32_t iSample = 0; iSample < blockSize; ++iSample)
+                    {
+                        const float32_t x = sectionIn[iSample];
+                        const float32_t y = b0 * x + d1;
+                        d1 = b1 * x + d2;
+                        d1 += a1 * y;
+                        d2 = b2 * x;
+                        d2 += a2 * y;
+                        out[iSample] = y;
+                    }
+                    states_[2 * iSection] = d1;
+                    states_[2 * iSection + 1] = d2;
+                    sectionIn = out; //< following sections work in place on the output
+                }
+            }
+        private:
+            size_t numSections_;
+            float32_t* states_;
+            const float32_t* coeffs_;
+    };
+
+    // normalized LMS, same arithmetic and state layout as arm_lms_norm_f32:
+    // coeffs[0] weights the oldest sample, states hold numTaps - 1 past samples followed by the block
+    class NormalizedLms
+    {
+        public:
+            NormalizedLms(const size_t numTaps, float32_t* coeffs, float32_t* states
+                        , const float32_t mu, const uint32_t blockSize)
+                : numTaps_{numTaps}
+                , coeffs_{coeffs}
+                , states_{states}
+                , mu_{mu}
+                , energy_{}
+                , x0_{}
+            {
+                std::fill_n(states_, numTaps + blockSize - 1, 0.0f);
+            }
+
+            // err may alias ref
+            void process(const float32_t* in, float32_t* ref, float32_t* out, float32_t* err, const uint32_t blockSize)
+            {
+                static constexpr float32_t Delta = 0.000000119209289f; //< same regularization as CMSIS-DSP
+                float32_t* newest = states_ + numTaps_ - 1;
+                for(uint32_t iSample = 0; iSample < blockSize; ++iSample)
+                {
+                    const float32_t* window = states_ + iSample;
+                    const float32_t x = in[iSample];
+                    newest[iSample] = x;
+                    float32_t acc = 0.0f;
+                    for(size_t iTap = 0; iTap < numTaps_; ++iTap)
+                    {
+                        acc += window[iTap] * coeffs_[iTap];
+                    }
+                    out[iSample] = acc;
+                    const float32_t e = ref[iSample] - acc;
+                    err[iSample] = e;
+                    // energy of the window, sample leaving it is the previous oldest one
+                    energy_ -= x0_ * x0_;
+                    energy_ += x * x;
+                    const float32_t w = e * mu_ / (energy_ + Delta);
+                    for(size_t iTap = 0; iTap < numTaps_; ++iTap)
+                    {
+                        coeffs_[iTap] += w * window[iTap];
+                    }
+                    x0_ = window[0];
+                }
+                // keep numTaps - 1 newest samples for the next block
+                std::copy_n(states_ + blockSize, numTaps_ - 1, states_);
+            }
+        private:
+            size_t numTaps_;
+            float32_t* coeffs_;
+            float32_t* states_;
+            float32_t mu_;
+            float32_t energy_;
+            float32_t x0_;
+    };
+
+    // Real FFT computed as complex FFT of Length/2 points followed by a split stage,
+    // output packed like arm_rfft_fast_f32: {X[0].re, X[N/2].re, X[1].re, X[1].im, ...}
+    template <uint16_t Length>
+    class RealFft
+    {
+        private:
+            using Tables = FftTables<Length>;
+            static constexpr size_t NumComplex = Tables::CfftLength;
+            static constexpr const auto& bitRev_ = Tables::bitReversal;
+            static constexpr const auto& twiddle_ = Tables::rfftTwiddle; //< sin/cos of 2*pi*k/Length, k < Length/2
+        public:
+            // input is not modified, signature matches the CMSIS backend
+            void forward(float32_t* in, float32_t* out)
+            {
+                // pack even/odd samples as complex values, in bit reversed order
+                for(size_t i = 0; i < NumComplex; ++i)
+                {
+                    const size_t j = bitRev_[i];
+                    out[2 * j] = in[2 * i];
+                    out[2 * j + 1] = in[2 * i + 1];
+                }
+                complexFft(out);
+                split(out);
+            }
+
+            // inverse of forward, including the 1/Length scaling, input is not modified
+            void inverse(float32_t* in, float32_t* out)
+            {
+                // merge the real spectrum into the spectrum of even + j * odd samples, in bit reversed order,
+                // conjugated so the forward complex FFT computes the inverse
+                for(size_t k = 0; k < NumComplex; ++k)
+                {
+                    const size_t m = NumComplex - k;
+                    // X[0] and X[N/2] are both real and packed into bin 0
+                    const float32_t xkr = in[2 * k], xki = k ? in[2 * k + 1] : 0.0f;
+                    const float32_t xmr = k ? in[2 * m] : in[1], xmi = k ? in[2 * m + 1] : 0.0f;
+                    // E = (X[k] + conj(X[m])) / 2, O = (X[k] - conj(X[m])) * conj(W^k) / 2
+                    const float32_t er = 0.5f * (xkr + xmr), ei = 0.5f * (xki - xmi);
+                    const float32_t dr = 0.5f * (xkr - xmr), di = 0.5f * (xki + xmi);
+                    const float32_t wr = twiddle_[2 * k + 1], wi = twiddle_[2 * k];
+                    const float32_t or_ = wr * dr - wi * di;
+                    const float32_t oi = wr * di + wi * dr;
+                    // Z = E + j * O
+                    const size_t j = bitRev_[k];
+                    out[2 * j] = er - oi;
+                    out[2 * j + 1] = -(ei + or_);
+                }
+                complexFft(out);
+                const float32_t scale = 1.0f / NumComplex;
+                for(size_t i = 0; i < NumComplex; ++i)
+                {
+                    out[2 * i] *= scale;
+                    out[2 * i + 1] *= -scale;
+                }
+            }
+        private:
+            // iterative radix-2 decimation in time, input in bit reversed order,
+            // plain C++ left to the compiler's vectorizer, faster here than SSE2 intrinsics
+            void complexFft(float32_t* data)
+            {
+                for(size_t span = 1; span < NumComplex; span *= 2)
+                {
+                    // twiddle for the butterfly span from the length-N table
+                    const size_t step = Length / (2 * span);
+                    for(size_t iGroup = 0; iGroup < NumComplex; iGroup += 2 * span)
+                    {
+                        for(size_t k = 0; k < span; ++k)
+                        {
+                            const float32_t wr = twiddle_[2 * k * step + 1];
+                            const float32_t wi = -twiddle_[2 * k * step];
+                            float32_t* a = data + 2 * (iGroup + k);
+                            float32_t* b = data + 2 * (iGroup + k + span);
+                            const float32_t tr = wr * b[0] - wi * b[1];
+                            const float32_t ti = wr * b[1] + wi * b[0];
+                            b[0] = a[0] - tr;
+                            b[1] = a[1] - ti;
+                            a[0] += tr;
+                            a[1] += ti;
+                        }
+                    }
+                }
+            }
+
+            // separates the spectra of even and odd samples into the real signal spectrum
+            void split(float32_t* data)
+            {
+                const float32_t z0r = data[0], z0i = data[1];
+                data[0] = z0r + z0i;
+                data[1] = z0r - z0i;
+                for(size_t k = 1; k <= NumComplex / 2; ++k)
+                {
+                    const size_t m = NumComplex - k;
+                    const float32_t zkr = data[2 * k], zki = data[2 * k + 1];
+                    const float32_t zmr = data[2 * m], zmi = data[2 * m + 1];
+                    // even part E = (Z[k] + conj(Z[m])) / 2, odd part O = (Z[k] - conj(Z[m])) / 2j
+                    const float32_t er = 0.5f * (zkr + zmr), ei = 0.5f * (zki - zmi);
+                    const float32_t or_ = 0.5f * (zki + zmi), oi = -0.5f * (zkr - zmr);
+                    const float32_t wr = twiddle_[2 * k + 1], wi = -twiddle_[2 * k];
+                    // X[k] = E + W^k * O, X[m] = conj(E - W^k * O)
+                    const float32_t tr = wr * or_ - wi * oi;
+                    const float32_t ti = wr * oi + wi * or_;
+                    data[2 * k] = er + tr;
+                    data[2 * k + 1] = ei + ti;
+                    data[2 * m] = er - tr;
+                    data[2 * m + 1] = -(ei - ti);
+                }
+            }
+    };
+
+    inline void cmplxMagSquared(const float32_t* in, float32_t* out, const uint32_t numSamples)
+    {
+        uint32_t iSample = 0;
+#if defined(__AVX2__)
+        for(; iSample + 8 <= numSamples; iSample += 8)
+        {
+            const __m256 a = _mm256_loadu_ps(in + 2 * iSample);
+            const __m256 b = _mm256_loadu_ps(in + 2 * iSample + 8);
+            const __m256 aSqr = _mm256_mul_ps(a, a);
+            const __m256 bSqr = _mm256_mul_ps(b, b);
+            // per 128-bit lane: {re^2 of a, re^2 of b} + {im^2 of a, im^2 of b}
+            const __m256 sum = _mm256_add_ps(_mm256_shuffle_ps(aSqr, bSqr, _MM_SHUFFLE(2, 0, 2, 0))
+                                            , _mm256_shuffle_ps(aSqr, bSqr, _MM_SHUFFLE(3, 1, 3, 1)));
+            // lanes hold samples {0, 1, 4, 5 | 2, 3, 6, 7}, restore order
+            const __m256d ordered = _mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_ps(out + iSample, _mm256_castpd_ps(ordered));
+        }
+#endif
+#if defined(__SSE2__)
+        for(; iSample + 4 <= numSamples; iSample += 4)
+        {
+            const __m128 a = _mm_loadu_ps(in + 2 * iSample);
+            const __m128 b = _mm_loadu_ps(in + 2 * iSample + 4);
+            const __m128 aSqr = _mm_mul_ps(a, a);
+            const __m128 bSqr = _mm_mul_ps(b, b);
+            const __m128 sum = _mm_add_ps(_mm_shuffle_ps(aSqr, bSqr, _MM_SHUFFLE(2, 0, 2, 0))
+                                        , _mm_shuffle_ps(aSqr, bSqr, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm_storeu_ps(out + iSample, sum);
+        }
+#endif
+        for(; iSample < numSamples; ++iSample)
+        {
+            const float32_t re = in[2 * iSample];
+            const float32_t im = in[2 * iSample + 1];
+            out[iSample] = re * re + im * im;
+        }
+    }
+}
+
+#endif //_PPG_DSP_BACKEND_HOST_HPP
@@ -4,7 +4,7 @@
 #include <cstdint>
 #include <cmath>
 
-#include <arm_math.h>
+#include "DspBackend.hpp"
 
 #include "ITransform.hpp"
 
@@ -23,22 +23,30 @@ namespace Dsp
             Fft()
             {
                 static_assert(Length && !(Length & (Length - 1)), "FFT Length must be power of 2");
-                arm_rfft_fast_init_f32(&inst_, Length);
             }
 
             OutputT transform(const InputT& input) override
             {
                 OutputT transformed{};
                 InputT inputCopy{input};
-                arm_rfft_fast_f32(&inst_, inputCopy.data(), transformed.data(), 0);
+                fft_.forward(inputCopy.data(), transformed.data());
                 return transformed;
             }
 
+            // inverse of transform, spectrum packed like the transform output
+            InputT inverse(const OutputT& spectrum)
+            {
+                InputT output{};
+                OutputT spectrumCopy{spectrum};
+                fft_.inverse(spectrumCopy.data(), output.data());
+                return output;
+            }
+
             MagnitudeT getMagnitudeSqr(const InputT& input)
             {
                 MagnitudeT mag{};
                 auto fftInterleaved = transform(input);
-                arm_cmplx_mag_squared_f32(fftInterleaved.data(), mag.data(), mag.size());
+                Backend::cmplxMagSquared(fftInterleaved.data(), mag.data(), mag.size());
                 return mag;
             }
 
@@ -54,7 +62,7 @@ namespace Dsp
             }
 
         private:
-            arm_rfft_fast_instance_f32 inst_;
+            Backend::RealFft<Length> fft_;
     };
 }
 
@@ -0,0 +1,118 @@
+#ifndef _PPG_FFT_TABLES_HPP
+#define _PPG_FFT_TABLES_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <utility>
+
+namespace Dsp
+{
+    namespace Detail
+    {
+        // sin and cos of x in [0, pi/4], Taylor series in double, exact after rounding to float
+        constexpr std::pair<double, double> cosSinSmall(const double x)
+        {
+            double term = x;
+            double sin = 0.0;
+            for(int n = 1; n < 30; n += 2)
+            {
+                sin += term;
+                term *= -x * x / ((n + 1) * (n + 2));
+            }
+            term = 1.0;
+            double cos = 0.0;
+            for(int n = 0; n < 30; n += 2)
+            {
+                cos += term;
+                term *= -x * x / ((n + 1) * (n + 2));
+            }
+            return {cos, sin};
+        }
+
+        // cos and sin of 2*pi*num/den, reduced to the first octant with integer arithmetic
+        constexpr std::pair<double, double> cosSinTurns(const std::size_t num, const std::size_t den)
+        {
+            // position in quarter turns: quadrant and remainder in units of 1/den quarter turn
+            const std::size_t quarters = 4 * (num % den);
+            const std::size_t quadrant = quarters / den;
+            const std::size_t rem = quarters % den;
+            double c = 0.0, s = 0.0;
+            if(2 * rem <= den)
+            {
+                const auto [cosX, sinX] = cosSinSmall(std::numbers::pi / 2 * rem / den);
+                c = cosX;
+                s = sinX;
+            }
+            else
+            {
+                const auto [cosX, sinX] = cosSinSmall(std::numbers::pi / 2 * (den - rem) / den);
+                c = sinX;
+                s = cosX;
+            }
+            switch(quadrant)
+            {
+                case 0: return {c, s};
+                case 1: return {-s, c};
+                case 2: return {-c, -s};
+                default: return {s, -c};
+            }
+        }
+    }
+
+    // Twiddle tables of a real FFT of Length points, generated at compile time, in the CMSIS-DSP layout.
+    // Only the tables of the instantiated lengths end up in flash.
+    template <uint16_t Length>
+    struct FftTables
+    {
+        static_assert(Length >= 4 && !(Length & (Length - 1)), "FFT Length must be power of 2, >= 4");
+
+        // the real FFT is computed as a complex FFT of Length/2 points
+        static constexpr std::size_t CfftLength = Length / 2;
+
+        // sin/cos of 2*pi*k/Length interleaved, k < Length/2, like twiddleCoef_rfft_<Length>:
+        // sin first, the split stage of arm_rfft_fast_f32 multiplies by j * exp(-j*2*pi*k/Length)
+        static constexpr std::array<float, Length> rfftTwiddle = [] {
+            std::array<float, Length> table{};
+            for(std::size_t k = 0; k < Length / 2; ++k)
+            {
+                const auto [c, s] = Detail::cosSinTurns(k, Length);
+                table[2 * k] = static_cast<float>(s);
+                table[2 * k + 1] = static_cast<float>(c);
+            }
+            return table;
+        }();
+
+        // cos/sin of 2*pi*k/CfftLength interleaved, k < 3/4 CfftLength, like twiddleCoef_<CfftLength>
+        static constexpr std::array<float, 3 * CfftLength / 2> cfftTwiddle = [] {
+            std::array<float, 3 * CfftLength / 2> table{};
+            for(std::size_t k = 0; k < 3 * CfftLength / 4; ++k)
+            {
+                const auto [c, s] = Detail::cosSinTurns(k, CfftLength);
+                table[2 * k] = static_cast<float>(c);
+                table[2 * k + 1] = static_cast<float>(s);
+            }
+            return table;
+        }();
+
+        // bit reversed index permutation of the complex FFT, used by the host backend
+        static constexpr std::array<uint16_t, CfftLength> bitReversal = [] {
+            std::array<uint16_t, CfftLength> table{};
+            std::size_t numBits = 0;
+            while((std::size_t{1} << numBits) < CfftLength) ++numBits;
+            for(std::size_t i = 0; i < CfftLength; ++i)
+            {
+                std::size_t reversed = 0;
+                for(std::size_t iBit = 0; iBit < numBits; ++iBit)
+                {
+                    reversed |= ((i >> iBit) & 1U) << (numBits - 1 - iBit);
+                }
+                table[i] = static_cast<uint16_t>(reversed);
+            }
+            return table;
+        }();
+    };
+}
+
+#endif //_PPG_FFT_TABLES_HPP
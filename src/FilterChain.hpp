@@ -0,0 +1,152 @@
+#ifndef _PPG_FILTER_CHAIN_HPP
+#define _PPG_FILTER_CHAIN_HPP
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Dsp
+{
+    // filter with a non-virtual per-sample process()
+    template <typename FilterT, typename SampleT>
+    concept SampleFilter = requires(FilterT filter, const SampleT& sample)
+    {
+        filter.process(sample);
+    };
+
+    // filter which can additionally process a whole block at once (in place allowed)
+    template <typename FilterT, typename SampleT>
+    concept BlockFilter = SampleFilter<FilterT, SampleT>
+        && requires(FilterT filter, std::span<const SampleT> in, std::span<SampleT> out)
+    {
+        filter.process(in, out);
+    };
+
+    // Filters applied one after another, resolved at compile time.
+    // Stages are called directly, so the compiler can inline and fuse them,
+    // unlike calls through the virtual IFilter interface.
+    template <typename... Stages>
+    class FilterChain
+    {
+        public:
+            FilterChain(Stages... stages)
+                : stages_{std::move(stages)...}
+            {
+                static_assert(sizeof...(Stages) > 0, "Filter chain must have at least one stage");
+            }
+
+            template <typename SampleT>
+            auto process(const SampleT& sample)
+            {
+                return processSample<0>(sample);
+            }
+
+            template <typename SampleT>
+            auto operator()(const SampleT& sample)
+            {
+                return process(sample);
+            }
+
+            // first stage filters in into out, following stages work in place on out
+            template <typename SampleT>
+            void process(std::span<const SampleT> in, std::span<SampleT> out)
+            {
+                processBlock<0>(in, out);
+            }
+
+            template <typename InBlockT, typename OutBlockT>
+            void apply(const InBlockT& in, OutBlockT& out)
+            {
+                using SampleT = std::remove_cvref_t<decltype(*out.data())>;
+                process(std::span<const SampleT>{in.data(), in.size()}, std::span<SampleT>{out.data(), out.size()});
+            }
+
+            // resets every stage which has state to reset
+            void reset()
+            {
+                std::apply([](auto&... stages) {
+                    ([](auto& stage) {
+                        if constexpr(requires { stage.reset(); })
+                        {
+                            stage.reset();
+                        }
+                    }(stages), ...);
+                }, stages_);
+            }
+
+            // primes every stage which supports it with its steady state input for a constant sample
+            template <typename SampleT>
+            void prime(const SampleT& sample)
+            {
+                primeStage<0>(sample);
+            }
+
+            template <std::size_t Index>
+            auto& stage()
+            {
+                return std::get<Index>(stages_);
+            }
+        private:
+            template <std::size_t Index, typename SampleT>
+            auto processSample(const SampleT& sample)
+            {
+                auto filtered = std::get<Index>(stages_).process(sample);
+                if constexpr(Index + 1 < sizeof...(Stages))
+                {
+                    return processSample<Index + 1>(filtered);
+                }
+                else
+                {
+                    return filtered;
+                }
+            }
+
+            template <std::size_t Index, typename SampleT>
+            void primeStage(const SampleT& sample)
+            {
+                auto& stage = std::get<Index>(stages_);
+                auto steadyState = [&stage, &sample] {
+                    if constexpr(requires { stage.prime(sample); })
+                    {
+                        return stage.prime(sample);
+                    }
+                    else
+                    {
+                        return sample; //< stage without priming support, assume unity gain
+                    }
+                }();
+                if constexpr(Index + 1 < sizeof...(Stages))
+                {
+                    primeStage<Index + 1>(steadyState);
+                }
+            }
+
+            template <std::size_t Index, typename SampleT>
+            void processBlock(std::span<const SampleT> in, std::span<SampleT> out)
+            {
+                auto& stage = std::get<Index>(stages_);
+                using StageT = std::remove_cvref_t<decltype(stage)>;
+                if constexpr(BlockFilter<StageT, SampleT>)
+                {
+                    stage.process(in, out);
+                }
+                else
+                {
+                    for(std::size_t iSample = 0; iSample < in.size(); ++iSample)
+                    {
+                        out[iSample] = stage.process(in[iSample]);
+                    }
+                }
+                if constexpr(Index + 1 < sizeof...(Stages))
+                {
+                    processBlock<Index + 1>(std::span<const SampleT>{out.data(), in.size()}, out);
+                }
+            }
+        private:
+            std::tuple<Stages...> stages_;
+    };
+}
+
+#endif //_PPG_FILTER_CHAIN_HPP
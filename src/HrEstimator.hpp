@@ -0,0 +1,97 @@
+#ifndef _PPG_HR_ESTIMATOR_HPP
+#define _PPG_HR_ESTIMATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "Fft.hpp"
+
+namespace Processor
+{
+    // Heart rate of an analysis frame from its power spectrum (squared FFT magnitudes, bins 0 .. FftLength/2 - 1)
+
+    // frequency of the largest bin
+    template <size_t FftLength>
+    class ArgmaxHrEstimator
+    {
+        public:
+            using PowerT = typename Dsp::Fft<FftLength>::MagnitudeT;
+
+            uint8_t estimate(const PowerT& power, const uint32_t fs)
+            {
+                const auto iMax = std::distance(power.cbegin(), std::max_element(power.cbegin(), power.cend()));
+                return (60 * fs * iMax) / FftLength;
+            }
+    };
+
+    // Spectral peaks of the heart rate band scored by the sum of their harmonics, weighted by the
+    // autocorrelation at their period. A second harmonic stronger than the fundamental wins the argmax,
+    // but the autocorrelation at its period (half the pulse period) is low; a subharmonic has no peak of its own.
+    // The autocorrelation is the inverse transform of the power spectrum (Wiener-Khinchin), one inverse FFT per frame,
+    // the history is zero padded to FftLength, so it isn't circular for lags up to FftLength - history.
+    template <size_t FftLength>
+    class HarmonicHrEstimator
+    {
+        public:
+            using PowerT = typename Dsp::Fft<FftLength>::MagnitudeT;
+            static constexpr uint32_t MinBpm = 40;
+            static constexpr uint32_t MaxBpm = 220;
+            static constexpr size_t NumHarmonics = 3;
+            static constexpr float32_t MinRelativePeak = 0.1f; //< of the largest peak in the band, smaller peaks aren't candidates
+
+            uint8_t estimate(const PowerT& power, const uint32_t fs)
+            {
+                // real spectrum packed like the FFT output, DC and Nyquist share bin 0 of the magnitudes,
+                // the filtered signal has neither; imaginary parts stay 0
+                spectrum_[0] = power[0];
+                for(size_t iBin = 1; iBin < power.size(); ++iBin)
+                {
+                    spectrum_[2 * iBin] = power[iBin];
+                }
+                const auto acf = fft_.inverse(spectrum_);
+                const size_t firstBin = std::max<size_t>((MinBpm * FftLength + 60 * fs - 1) / (60 * fs), 2);
+                const size_t lastBin = std::min<size_t>(MaxBpm * FftLength / (60 * fs), power.size() - 2);
+                if(acf[0] <= 0.0f || firstBin > lastBin)
+                {
+                    return 0;
+                }
+                const auto itrPeak = std::max_element(power.cbegin() + firstBin, power.cbegin() + lastBin + 1);
+                size_t bestBin = std::distance(power.cbegin(), itrPeak);
+                const float32_t minPeak = MinRelativePeak * *itrPeak;
+                float32_t bestScore = 0.0f;
+                for(size_t iBin = firstBin; iBin <= lastBin; ++iBin)
+                {
+                    if(power[iBin] < minPeak || power[iBin] < power[iBin - 1] || power[iBin] < power[iBin + 1])
+                    {
+                        continue;
+                    }
+                    // harmonics may fall between bins
+                    float32_t harmonicSum = 0.0f;
+                    for(size_t iHarmonic = 1; iHarmonic <= NumHarmonics && iHarmonic * iBin + 1 < power.size(); ++iHarmonic)
+                    {
+                        const size_t harmonicBin = iHarmonic * iBin;
+                        harmonicSum += std::max({power[harmonicBin - 1], power[harmonicBin], power[harmonicBin + 1]});
+                    }
+                    // period of the bin frequency in samples, interpolated between the lags
+                    const float32_t lag = static_cast<float32_t>(FftLength) / iBin;
+                    const size_t iLag = static_cast<size_t>(lag);
+                    const float32_t frac = lag - iLag;
+                    const float32_t correlation = (acf[iLag] * (1.0f - frac) + acf[iLag + 1] * frac) / acf[0];
+                    const float32_t score = harmonicSum * std::max(correlation, 0.0f);
+                    if(score > bestScore)
+                    {
+                        bestScore = score;
+                        bestBin = iBin;
+                    }
+                }
+                return (60 * fs * bestBin) / FftLength;
+            }
+        private:
+            Dsp::Fft<FftLength> fft_;
+            typename Dsp::Fft<FftLength>::OutputT spectrum_{}; //< member, frame buffers are kept off the stack
+    };
+}
+
+#endif //_PPG_HR_ESTIMATOR_HPP
@@ -4,9 +4,13 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <optional>
 
-#include "PpgProcessor.hpp"
+#include "PpgMeasurement.hpp"
+#include "SpectrumFrame.hpp"
 #include "Fft.hpp"
+#include "HrEstimator.hpp"
+#include "Trace.hpp"
 
 namespace Processor
 {
@@ -14,35 +18,61 @@ namespace Processor
         size_t NumSamples
         , size_t NumSamplesHistory = NumSamples
         , size_t FftLength = 1024
+        , typename EstimatorT = ArgmaxHrEstimator<FftLength>
     >
     class HeartRate
     {
+        public:
+            // until the history is full, provisional estimates are made from the samples received so far,
+            // the first after ProvisionalMinSamples and then every ProvisionalStep samples
+            static constexpr size_t ProvisionalMinSamples = NumSamples / 2;
+            static constexpr size_t ProvisionalStep = NumSamples / 4 ? NumSamples / 4 : 1;
+            // band of the captured spectrum frames
+            static constexpr uint32_t SpectrumMinBpm = 30;
+            static constexpr uint32_t SpectrumMaxBpm = 240;
+            static constexpr size_t MaxSpectrumBins = std::min<size_t>(FftLength / 2, 255);
         public:
             HeartRate(const uint16_t fs)
                 : samples_{}
                 , iSample_{}
+                , numReceived_{}
                 , fft_{}
+                , estimator_{}
                 , fs_{fs}
                 , bpm_{}
+                , spectrumEnabled_{true}
+                , numSkippedFrames_{}
+                , spectrum_{}
+                , spectrumFirstBin_{(SpectrumMinBpm * FftLength + 60 * fs - 1) / (60 * fs)}
+                , spectrumNumBins_{}
+                , spectrumCapture_{}
+                , spectrumReady_{}
             {
+                const size_t lastBin = std::min<size_t>(SpectrumMaxBpm * FftLength / (60 * fs), FftLength / 2 - 1);
+                spectrumNumBins_ = lastBin >= spectrumFirstBin_ ? std::min(lastBin - spectrumFirstBin_ + 1, MaxSpectrumBins) : 0;
                 static_assert(FftLength >= NumSamples, "FFT length must be >= than NumSamples");
                 static_assert(FftLength >= NumSamplesHistory, "FFT length must be >= than NumSamplesHistory");
                 static_assert(NumSamplesHistory >= NumSamples, "FFT length must be >= than NumSamples");
             }
 
-            uint8_t process(const Ppg::Measurement& measurement)
+            uint8_t process(const PpgMeasurement& measurement)
             {
                 samples_[NumSamplesHistory - NumSamples + iSample_] = measurement.filtered;
                 iSample_++;
+                if(numReceived_ < NumSamplesHistory)
+                {
+                    numReceived_++;
+                }
                 if(iSample_ == NumSamples)
                 {
-                    // calculate fft
-                    auto fftMag = fft_.getMagnitudeSqr(samples_);
-                    // find frequency of max fft value
-                    const auto itrFftMax = std::max_element(fftMag.cbegin(), fftMag.cend());
-                    const auto iFftMax = std::distance(fftMag.cbegin(), itrFftMax);
-                    // convert maxIndex to frequency and calculate bpm
-                    bpm_ = (60 * (fs_/2) * iFftMax) / (FftLength / 2);
+                    if(spectrumEnabled_)
+                    {
+                        estimate();
+                    }
+                    else
+                    {
+                        numSkippedFrames_++; //< previous estimate is kept
+                    }
                     // shift samples
                     for(size_t i = NumSamples; i < NumSamplesHistory; ++i)
                     {
@@ -50,14 +80,91 @@ namespace Processor
                     }
                     iSample_ = 0;
                 }
+                else if(spectrumEnabled_ && isProvisional() && numReceived_ >= ProvisionalMinSamples
+                        && numReceived_ % ProvisionalStep == 0)
+                {
+                    // slots after the newest sample still hold shifted copies, the window must end at the newest sample
+                    std::fill(samples_.begin() + NumSamplesHistory - NumSamples + iSample_
+                            , samples_.begin() + NumSamplesHistory, 0.0f);
+                    estimate();
+                }
                 return bpm_;
             }
+
+            // estimate is based on less than the full history
+            bool isProvisional() const
+            {
+                return numReceived_ < NumSamplesHistory;
+            }
+
+            // disabled spectrum skips the FFT frames and keeps the last estimate, samples are still collected
+            void setSpectrumEnabled(const bool enabled)
+            {
+                spectrumEnabled_ = enabled;
+            }
+
+            uint32_t getNumSkippedFrames() const
+            {
+                return numSkippedFrames_;
+            }
+
+            // keeps the heart rate band of the spectrum of every analysis frame while enabled
+            void setSpectrumCapture(const bool enabled)
+            {
+                spectrumCapture_ = enabled;
+                spectrumReady_ = false;
+            }
+
+            // band spectrum of the last analysis frame, returned once per frame
+            std::optional<SpectrumFrame> takeSpectrum()
+            {
+                if(!spectrumReady_)
+                {
+                    return {};
+                }
+                spectrumReady_ = false;
+                return SpectrumFrame{static_cast<uint16_t>(fs_), static_cast<uint16_t>(FftLength)
+                                    , static_cast<uint16_t>(spectrumFirstBin_), bpm_, isProvisional()
+                                    , std::span<const float>{spectrum_.data(), spectrumNumBins_}};
+            }
+
+            void reset()
+            {
+                samples_.fill(0.0f);
+                iSample_ = 0;
+                numReceived_ = 0;
+                bpm_ = 0;
+                spectrumReady_ = false;
+            }
+        private:
+            void estimate()
+            {
+                PPG_TRACE(HrFrameBegin, 0);
+                // calculate fft
+                auto fftMag = fft_.getMagnitudeSqr(samples_);
+                bpm_ = estimator_.estimate(fftMag, fs_);
+                if(spectrumCapture_)
+                {
+                    std::copy_n(fftMag.cbegin() + spectrumFirstBin_, spectrumNumBins_, spectrum_.begin());
+                    spectrumReady_ = true;
+                }
+                PPG_TRACE(HrFrameEnd, bpm_);
+            }
         private:
             std::array<float32_t, FftLength> samples_;
             size_t iSample_;
+            size_t numReceived_;
             Dsp::Fft<FftLength> fft_;
+            EstimatorT estimator_;
             uint32_t fs_;
             uint8_t bpm_;
+            bool spectrumEnabled_;
+            uint32_t numSkippedFrames_;
+            std::array<float32_t, MaxSpectrumBins> spectrum_;
+            size_t spectrumFirstBin_;
+            size_t spectrumNumBins_;
+            bool spectrumCapture_;
+            bool spectrumReady_;
     };
 }
 
@@ -3,8 +3,9 @@
 
 #include <algorithm>
 #include <array>
+#include <span>
 
-#include <arm_math.h>
+#include "DspBackend.hpp"
 
 #include "IFilter.hpp"
 
@@ -25,11 +26,20 @@ namespace Dsp
             IIRFilter(const CoeffsT& coeffs)
                 : coeffs_{coeffs}
                 , states_{}
-                , inst_{NumSections, states_.data(), coeffs_.data()}
+                , cascade_{NumSections, states_.data(), coeffs_.data()}
             {
                 static_assert(Order > 0, "Filter order must be > 0");
             }
 
+            // backend keeps pointers to coeffs and states, rebind them to the copy
+            IIRFilter(const IIRFilter& other)
+                : coeffs_{other.coeffs_}
+                , states_{other.states_}
+                , cascade_{NumSections, states_.data(), coeffs_.data()}
+            { }
+
+            IIRFilter& operator=(const IIRFilter&) = delete;
+
             float32_t apply(const float32_t& sample) override
             {
                 float32_t filteredSample{};
@@ -37,8 +47,55 @@ namespace Dsp
                 return filteredSample;
             }
 
-            template<typename BlockT>
-            void apply(const BlockT& in, BlockT& out)
+            // non-virtual interface, used by FilterChain
+            // single sample is filtered inline instead of calling the block kernel with blockSize 1,
+            // same direct form II transposed arithmetic as the backend, see BenchmarkDSP benchmark 2 vs 13
+            float32_t process(const float32_t& sample)
+            {
+                float32_t x = sample;
+                for(size_t iSection = 0; iSection < NumSections; ++iSection)
+                {
+                    const float32_t* c = coeffs_.data() + NumCoeffsPerSection * iSection;
+                    float32_t* d = states_.data() + NumStateVarsPerSection * iSection;
+                    const float32_t y = c[0] * x + d[0];
+                    d[0] = c[1] * x + c[3] * y + d[1];
+                    d[1] = c[2] * x + c[4] * y;
+                    x = y;
+                }
+                return x;
+            }
+
+            void process(std::span<const float32_t> in, std::span<float32_t> out)
+            {
+                apply(in.data(), out.data(), in.size());
+            }
+
+            void reset()
+            {
+                states_.fill(0.0f);
+            }
+
+            // sets the states to the steady state for a constant input (like scipy lfilter_zi),
+            // so a large DC offset in the first samples doesn't cause a transient,
+            // returns the steady state output
+            float32_t prime(const float32_t& sample)
+            {
+                float32_t x = sample;
+                for(size_t iSection = 0; iSection < NumSections; ++iSection)
+                {
+                    const float32_t* c = coeffs_.data() + NumCoeffsPerSection * iSection;
+                    float32_t* d = states_.data() + NumStateVarsPerSection * iSection;
+                    // DC gain of the section, a1 and a2 are stored negated
+                    const float32_t y = x * (c[0] + c[1] + c[2]) / (1.0f - c[3] - c[4]);
+                    d[1] = c[2] * x + c[4] * y;
+                    d[0] = c[1] * x + c[3] * y + d[1];
+                    x = y;
+                }
+                return x;
+            }
+
+            template<typename InBlockT, typename OutBlockT>
+            void apply(const InBlockT& in, OutBlockT& out)
             {
                 apply(in.data(), out.data(), in.size());
             }
@@ -46,7 +103,7 @@ namespace Dsp
         private:
             void apply(const float32_t* in, float32_t* out, const uint32_t blockSize)
             {
-                arm_biquad_cascade_df2T_f32(&inst_, in, out, blockSize);
+                cascade_.process(in, out, blockSize);
             }
         private:
             const CoeffsT coeffs_;
@@ -54,7 +111,7 @@ namespace Dsp
             static constexpr size_t NumStateVars = NumStateVarsPerSection * NumSections;
             using StatesT = std::array<float32_t, NumStateVarsPerSection * NumSections>;
             StatesT states_;
-            arm_biquad_cascade_df2T_instance_f32 inst_; //< CMSIS-DSP filter instance
+            Backend::BiquadCascade cascade_;
     };
 }
 
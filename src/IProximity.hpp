@@ -0,0 +1,21 @@
+#ifndef _PPG_IPROXIMITY_HPP
+#define _PPG_IPROXIMITY_HPP
+
+#include <cstdint>
+#include <optional>
+
+namespace Hardware
+{
+    // Proximity reading of the PPG sensor: Hardware::Proximity on the device,
+    // recorded samples in the host replay (host/PpgReplay.cpp)
+    class IProximity
+    {
+        public:
+            using ValueT = uint16_t;
+        public:
+            virtual ~IProximity() = default;
+            virtual std::optional<ValueT> getProximity() = 0;
+    };
+}
+
+#endif //_PPG_IPROXIMITY_HPP
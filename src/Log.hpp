@@ -0,0 +1,16 @@
+#ifndef _PPG_LOG_HPP
+#define _PPG_LOG_HPP
+
+// Zephyr logging of the components that also run on host (host/PpgReplay.cpp),
+// on host the messages are dropped, the components count what they log about
+#if defined(__ZEPHYR__)
+#include <zephyr/logging/log.h>
+#else
+#define LOG_MODULE_DECLARE(...) static_assert(true, "")
+#define LOG_ERR(...) do { } while(0)
+#define LOG_WRN(...) do { } while(0)
+#define LOG_INF(...) do { } while(0)
+#define LOG_DBG(...) do { } while(0)
+#endif
+
+#endif //_PPG_LOG_HPP
@@ -0,0 +1,69 @@
+#ifndef _PPG_MESSAGE_QUEUE_HPP
+#define _PPG_MESSAGE_QUEUE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#if defined(__ZEPHYR__)
+#include <zephyr/kernel.h>
+#endif
+
+// Bounded queue between the sampling and the main loop: Hardware::MessageQueue (k_msgq) on the device,
+// Hardware::VirtualMessageQueue (VirtualTime.hpp) for the replays on host
+namespace Hardware
+{
+    template <typename T>
+    class IMessageQueue
+    {
+        public:
+            virtual ~IMessageQueue() = default;
+            // doesn't wait, returns false if the queue is full
+            virtual bool put(const T& item) = 0;
+            // waits at most timeout for an item
+            virtual std::optional<T> get(const std::chrono::milliseconds& timeout) = 0;
+            // number of queued items
+            virtual std::size_t size() = 0;
+    };
+
+#if defined(__ZEPHYR__)
+    template <typename T, std::size_t Capacity>
+    class MessageQueue
+        : public IMessageQueue<T>
+    {
+        public:
+            MessageQueue()
+            {
+                k_msgq_init(&queue_, buffer_, sizeof(T), Capacity);
+            }
+
+            MessageQueue(const MessageQueue&) = delete;
+            MessageQueue& operator=(const MessageQueue&) = delete;
+
+            bool put(const T& item) override
+            {
+                return k_msgq_put(&queue_, &item, K_NO_WAIT) == 0;
+            }
+
+            std::optional<T> get(const std::chrono::milliseconds& timeout) override
+            {
+                T item;
+                if(k_msgq_get(&queue_, &item, K_MSEC(timeout.count())) != 0)
+                {
+                    return {};
+                }
+                return item;
+            }
+
+            std::size_t size() override
+            {
+                return k_msgq_num_used_get(&queue_);
+            }
+        private:
+            char __aligned(4) buffer_[Capacity * sizeof(T)]{};
+            k_msgq queue_;
+    };
+#endif
+}
+
+#endif //_PPG_MESSAGE_QUEUE_HPP
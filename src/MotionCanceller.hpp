@@ -0,0 +1,87 @@
+#ifndef _PPG_MOTION_CANCELLER_HPP
+#define _PPG_MOTION_CANCELLER_HPP
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "Acceleration.hpp"
+#include "IIRFilter.hpp"
+#include "NlmsFilter.hpp"
+
+namespace Processor
+{
+    // Removes motion artifacts from the filtered PPG signal, using the accelerometer as noise reference.
+    // Gravity is removed from every axis with a DC blocker, then one NLMS filter per axis
+    // cancels the part of the signal correlated with that axis.
+    template <size_t NumTaps, size_t MaxBlockSize>
+    class MotionCanceller
+    {
+        private:
+            static constexpr size_t NumAxes = 3;
+            // y[n] = x[n] - x[n-1] + 0.99 y[n-1], a1 is stored negated
+            static constexpr std::array<float32_t, 5> DcBlockerCoeffs{1.0f, -1.0f, 0.0f, 0.99f, 0.0f};
+        public:
+            static constexpr float32_t DefaultStepSize = 0.01f; //< NLMS mu
+        public:
+            MotionCanceller(const float32_t mu = DefaultStepSize)
+                : dcBlockers_{DcBlockerCoeffs, DcBlockerCoeffs, DcBlockerCoeffs}
+                , nlms_{NlmsT{mu}, NlmsT{mu}, NlmsT{mu}}
+                , reference_{}
+                , primed_{}
+            { }
+
+            // motion holds one accelerometer sample per signal sample, signal is cleaned in place
+            void process(std::span<const Hardware::Acceleration> motion, std::span<float32_t> signal)
+            {
+                if(!primed_ && !motion.empty())
+                {
+                    // start from the first sample's gravity vector, instead of a step from zero
+                    for(size_t iAxis = 0; iAxis < NumAxes; ++iAxis)
+                    {
+                        dcBlockers_[iAxis].prime(axis(motion[0], iAxis));
+                    }
+                    primed_ = true;
+                }
+                for(size_t iSample = 0; iSample < signal.size(); iSample += MaxBlockSize)
+                {
+                    const auto blockSize = std::min(MaxBlockSize, signal.size() - iSample);
+                    const auto block = signal.subspan(iSample, blockSize);
+                    const auto reference = std::span<float32_t>{reference_.data(), blockSize};
+                    for(size_t iAxis = 0; iAxis < NumAxes; ++iAxis)
+                    {
+                        for(size_t i = 0; i < blockSize; ++i)
+                        {
+                            reference[i] = axis(motion[iSample + i], iAxis);
+                        }
+                        dcBlockers_[iAxis].process(std::span<const float32_t>{reference}, reference);
+                        nlms_[iAxis].process(reference, block);
+                    }
+                }
+            }
+
+            void reset()
+            {
+                for(size_t iAxis = 0; iAxis < NumAxes; ++iAxis)
+                {
+                    dcBlockers_[iAxis].reset();
+                    nlms_[iAxis].reset();
+                }
+                primed_ = false;
+            }
+        private:
+            using NlmsT = Dsp::NlmsFilter<NumTaps, MaxBlockSize>;
+
+            static float32_t axis(const Hardware::Acceleration& acceleration, const size_t iAxis)
+            {
+                return iAxis == 0 ? acceleration.x : (iAxis == 1 ? acceleration.y : acceleration.z);
+            }
+        private:
+            std::array<Dsp::IIRFilter<1>, NumAxes> dcBlockers_;
+            std::array<NlmsT, NumAxes> nlms_;
+            std::array<float32_t, MaxBlockSize> reference_;
+            bool primed_;
+    };
+}
+
+#endif //_PPG_MOTION_CANCELLER_HPP
@@ -2,13 +2,23 @@
 #define _PPG_MOVING_AVERAGE_FILTER_HPP
 
 #include <array>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 #include "IFilter.hpp"
 
 namespace Dsp
 {
-    template <size_t NumSamples, typename SampleT, typename FilteredT = SampleT>
+    // Moving average over the last NumSamples samples, O(1) per sample for integer samples, amortized O(1) for floating point.
+    // Integer samples are summed in a 64-bit accumulator, so uint16_t proximity counts can't overflow,
+    // and for power of 2 lengths the division is a shift (rounds towards -inf for negative sums).
+    // Floating point sums are recomputed once per window to bound the add/subtract drift, O(NumSamples) for that sample.
+    template <
+        size_t NumSamples, typename SampleT, typename FilteredT = SampleT
+        , typename AccumulatorT = std::conditional_t<std::is_integral_v<SampleT>, int64_t, SampleT>
+    >
     class MovingAverageFilter
         : public IFilter<SampleT, FilteredT>
     {
@@ -17,22 +27,79 @@ namespace Dsp
                 : samples_{}
                 , iTail_{}
                 , sum_{}
-            { }
+            {
+                static_assert(NumSamples > 0, "Moving average length must be > 0");
+            }
+
+            FilteredT apply(const SampleT& sample) override
+            {
+                return process(sample);
+            }
 
-            FilteredT apply(const SampleT& sample)
+            // non-virtual interface, used by FilterChain
+            FilteredT process(const SampleT& sample)
             {
-                auto oldestSample = samples_[iTail_];
-                sum_ -= oldestSample;
-                sum_ += sample;
+                sum_ -= static_cast<AccumulatorT>(samples_[iTail_]);
+                sum_ += static_cast<AccumulatorT>(sample);
                 samples_[iTail_] = sample;
-                iTail_ = (iTail_ == samples_.size()) ? 0 : iTail_ + 1;
-                return sum_ / NumSamples;
-            }            
+                iTail_++;
+                if(iTail_ == NumSamples)
+                {
+                    iTail_ = 0;
+                    if constexpr(std::is_floating_point_v<AccumulatorT>)
+                    {
+                        resync();
+                    }
+                }
+                return average();
+            }
+
+            void reset()
+            {
+                samples_.fill(SampleT{});
+                iTail_ = 0;
+                sum_ = AccumulatorT{};
+            }
+
+            // fills the window with a constant input, returns the steady state output
+            FilteredT prime(const SampleT& sample)
+            {
+                samples_.fill(sample);
+                iTail_ = 0;
+                sum_ = static_cast<AccumulatorT>(sample) * static_cast<AccumulatorT>(NumSamples);
+                return average();
+            }
+        private:
+            FilteredT average() const
+            {
+                if constexpr(std::is_integral_v<AccumulatorT> && std::has_single_bit(NumSamples))
+                {
+                    return static_cast<FilteredT>(sum_ >> std::countr_zero(NumSamples));
+                }
+                else if constexpr(std::is_floating_point_v<AccumulatorT>)
+                {
+                    return static_cast<FilteredT>(sum_ * (AccumulatorT{1} / NumSamples));
+                }
+                else
+                {
+                    return static_cast<FilteredT>(sum_ / static_cast<AccumulatorT>(NumSamples));
+                }
+            }
+
+            void resync()
+            {
+                AccumulatorT sum{};
+                for(const auto& sample : samples_)
+                {
+                    sum += static_cast<AccumulatorT>(sample);
+                }
+                sum_ = sum;
+            }
         private:
             std::array<SampleT, NumSamples> samples_;
             size_t iTail_;
-            SampleT sum_;
+            AccumulatorT sum_;
     };
 }
 
-#endif // _PPG_MOVING_AVERAGE_FILTER_HPP
\ No newline at end of file
+#endif // _PPG_MOVING_AVERAGE_FILTER_HPP
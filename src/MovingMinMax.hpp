@@ -0,0 +1,80 @@
+#ifndef _PPG_MOVING_MIN_MAX_HPP
+#define _PPG_MOVING_MIN_MAX_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dsp
+{
+    // Minimum and maximum over the last NumSamples samples.
+    // Two monotonic deques in fixed ring buffers, amortized O(1) per sample, no allocation.
+    template <size_t NumSamples, typename SampleT>
+    class MovingMinMax
+    {
+        public:
+            MovingMinMax()
+                : numPushed_{}
+            {
+                static_assert(NumSamples > 0, "Moving min/max length must be > 0");
+            }
+
+            void push(const SampleT& sample)
+            {
+                minDeque_.push(sample, numPushed_, [](const SampleT& back, const SampleT& s) { return back >= s; });
+                maxDeque_.push(sample, numPushed_, [](const SampleT& back, const SampleT& s) { return back <= s; });
+                numPushed_++;
+            }
+
+            SampleT min() const { return minDeque_.front(); }
+            SampleT max() const { return maxDeque_.front(); }
+            // number of samples in the window
+            size_t size() const { return numPushed_ < NumSamples ? numPushed_ : NumSamples; }
+        private:
+            // deque of (value, sample number), values monotonic from front to back
+            class MonotonicDeque
+            {
+                public:
+                    template <typename DominatedF>
+                    void push(const SampleT& sample, const uint32_t sampleNumber, DominatedF isDominated)
+                    {
+                        // front falls out of the window, evicted first so the new sample always fits
+                        if(count_ && sampleNumber - sampleNumbers_[head_] >= NumSamples)
+                        {
+                            head_ = (head_ + 1) % NumSamples;
+                            count_--;
+                        }
+                        // samples which can't become the extreme anymore are removed from the back
+                        while(count_ && isDominated(values_[back()], sample))
+                        {
+                            count_--;
+                        }
+                        const size_t iNew = (head_ + count_) % NumSamples;
+                        values_[iNew] = sample;
+                        sampleNumbers_[iNew] = sampleNumber;
+                        count_++;
+                    }
+
+                    SampleT front() const
+                    {
+                        return values_[head_];
+                    }
+                private:
+                    size_t back() const
+                    {
+                        return (head_ + count_ - 1) % NumSamples;
+                    }
+                private:
+                    std::array<SampleT, NumSamples> values_{};
+                    std::array<uint32_t, NumSamples> sampleNumbers_{};
+                    size_t head_{};
+                    size_t count_{};
+            };
+        private:
+            MonotonicDeque minDeque_;
+            MonotonicDeque maxDeque_;
+            uint32_t numPushed_;
+    };
+}
+
+#endif //_PPG_MOVING_MIN_MAX_HPP
@@ -0,0 +1,85 @@
+#ifndef _PPG_MOVING_VARIANCE_HPP
+#define _PPG_MOVING_VARIANCE_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace Dsp
+{
+    // Mean and variance over the last NumSamples samples, amortized O(1) per sample.
+    // Uses Welford's update, extended with removal of the oldest sample once the window is full.
+    // Mean and M2 are recomputed once per window to bound the rounding drift, O(NumSamples) for that sample.
+    template <size_t NumSamples, typename SampleT, typename AccumulatorT = float>
+    class MovingVariance
+    {
+        public:
+            MovingVariance()
+                : samples_{}
+                , iTail_{}
+                , count_{}
+                , mean_{}
+                , m2_{}
+            {
+                static_assert(NumSamples > 1, "Moving variance length must be > 1");
+            }
+
+            void push(const SampleT& sample)
+            {
+                const auto x = static_cast<AccumulatorT>(sample);
+                if(count_ < NumSamples)
+                {
+                    count_++;
+                    const auto delta = x - mean_;
+                    mean_ += delta / static_cast<AccumulatorT>(count_);
+                    m2_ += delta * (x - mean_);
+                }
+                else
+                {
+                    // replace the oldest sample
+                    const auto oldest = static_cast<AccumulatorT>(samples_[iTail_]);
+                    const auto oldMean = mean_;
+                    mean_ += (x - oldest) * (AccumulatorT{1} / NumSamples);
+                    m2_ += (x - oldest) * (x - mean_ + oldest - oldMean);
+                    if(m2_ < AccumulatorT{}) m2_ = AccumulatorT{}; //< rounding can push it below 0
+                }
+                samples_[iTail_] = sample;
+                iTail_ = (iTail_ + 1 == NumSamples) ? 0 : iTail_ + 1;
+                if(iTail_ == 0)
+                {
+                    resync();
+                }
+            }
+
+            AccumulatorT mean() const { return mean_; }
+            // population variance of the samples in the window
+            AccumulatorT variance() const { return count_ ? m2_ / static_cast<AccumulatorT>(count_) : AccumulatorT{}; }
+            AccumulatorT stdDev() const { return std::sqrt(variance()); }
+            size_t size() const { return count_; }
+        private:
+            void resync()
+            {
+                AccumulatorT sum{};
+                for(const auto& sample : samples_)
+                {
+                    sum += static_cast<AccumulatorT>(sample);
+                }
+                mean_ = sum * (AccumulatorT{1} / NumSamples);
+                AccumulatorT m2{};
+                for(const auto& sample : samples_)
+                {
+                    const auto delta = static_cast<AccumulatorT>(sample) - mean_;
+                    m2 += delta * delta;
+                }
+                m2_ = m2;
+            }
+        private:
+            std::array<SampleT, NumSamples> samples_;
+            size_t iTail_;
+            size_t count_;
+            AccumulatorT mean_;
+            AccumulatorT m2_;
+    };
+}
+
+#endif //_PPG_MOVING_VARIANCE_HPP
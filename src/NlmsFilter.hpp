@@ -0,0 +1,62 @@
+#ifndef _PPG_NLMS_FILTER_HPP
+#define _PPG_NLMS_FILTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "DspBackend.hpp"
+
+namespace Dsp
+{
+    // Normalized LMS adaptive noise canceller.
+    // The FIR filter adapts to estimate the part of the signal correlated with the noise reference,
+    // the signal is replaced with the error, i.e. the signal without that estimate.
+    template <size_t NumTaps, size_t MaxBlockSize>
+    class NlmsFilter
+    {
+        public:
+            NlmsFilter(const float32_t mu)
+                : mu_{mu}
+                , coeffs_{}
+                , states_{}
+                , estimate_{}
+                , lms_{NumTaps, coeffs_.data(), states_.data(), mu_, MaxBlockSize}
+            {
+                static_assert(NumTaps > 0 && MaxBlockSize > 0, "NLMS taps and block size must be > 0");
+            }
+
+            // backend keeps pointers to coeffs and states
+            NlmsFilter(const NlmsFilter&) = delete;
+            NlmsFilter& operator=(const NlmsFilter&) = delete;
+
+            void process(std::span<const float32_t> reference, std::span<float32_t> signal)
+            {
+                for(size_t iSample = 0; iSample < signal.size(); iSample += MaxBlockSize)
+                {
+                    const auto blockSize = std::min(MaxBlockSize, signal.size() - iSample);
+                    float32_t* block = signal.data() + iSample;
+                    lms_.process(reference.data() + iSample, block, estimate_.data(), block, blockSize);
+                }
+            }
+
+            void reset()
+            {
+                coeffs_.fill(0.0f);
+                lms_ = Backend::NormalizedLms{NumTaps, coeffs_.data(), states_.data(), mu_, MaxBlockSize};
+            }
+
+            const std::array<float32_t, NumTaps>& getCoeffs() const
+            {
+                return coeffs_;
+            }
+        private:
+            float32_t mu_;
+            std::array<float32_t, NumTaps> coeffs_;
+            std::array<float32_t, NumTaps + MaxBlockSize - 1> states_;
+            std::array<float32_t, MaxBlockSize> estimate_;
+            Backend::NormalizedLms lms_;
+    };
+}
+
+#endif //_PPG_NLMS_FILTER_HPP
@@ -0,0 +1,115 @@
+#ifndef _PPG_OUTPUT_STAGE_HPP
+#define _PPG_OUTPUT_STAGE_HPP
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+#include "DeadlineMonitor.hpp"
+#include "PipelineProfile.hpp"
+#include "PpgProcessor.hpp"
+
+namespace Processor
+{
+    // Heart rate and sample line of every measurement taken from the Ppg queue, within the deadline monitored period.
+    // In degraded mode the heart rate spectral frames are skipped and only every DegradedOutputDecimation-th line is written.
+    // The main loop of Application and the host replay (host/PpgReplay.cpp) run the same stage.
+    template <typename CounterT>
+    class OutputStage
+    {
+        public:
+            using MonitorT = DeadlineMonitor<CounterT>;
+            static constexpr std::size_t DegradedOutputDecimation = 4;
+            static constexpr uint32_t RecoveryPeriods = CONFIG_PPG_DEADLINE_RECOVERY_PERIODS;
+            static constexpr uint32_t BudgetPercent = CONFIG_PPG_DEADLINE_BUDGET_PERCENT;
+        public:
+            OutputStage(CounterT& counter, IPipelineProfile& profile)
+                : deadlineMonitor_{counter, RecoveryPeriods, Ppg::QueueSize - Ppg::BlockSize, Ppg::BlockSize - 1}
+                , profile_{&profile}
+            {
+                setBudget();
+            }
+
+            // starts the period of one measurement
+            void begin()
+            {
+                deadlineMonitor_.begin();
+            }
+
+            // runs the heart rate, returns the sample line, empty if it is skipped in degraded mode
+            std::string_view process(const Ppg::Measurement& measurement)
+            {
+                bpm_ = profile_->processHr(measurement);
+                if(isDegraded() && (iOutput_++ % DegradedOutputDecimation) != 0)
+                {
+                    return {};
+                }
+                const auto len = snprintf(line_.data(), line_.size()
+                                        , "%" PRIu64 ",%d,%d,%d\r\n"
+                                        , measurement.timestamp
+                                        , measurement.raw
+                                        , measurement.filtered
+                                        , bpm_);
+                return {line_.data(), static_cast<std::size_t>(len)};
+            }
+
+            // ends the period once the line is written, backlog is the number of measurements still queued,
+            // returns true if the mode changed
+            bool end(const std::size_t backlog)
+            {
+                deadlineMonitor_.end(backlog);
+                if(!deadlineMonitor_.modeChanged())
+                {
+                    return false;
+                }
+                profile_->setSkipSpectrum(isDegraded());
+                iOutput_ = 0;
+                return true;
+            }
+
+            // switches to the profile in normal mode, the budget follows its sample time
+            void setProfile(IPipelineProfile& profile)
+            {
+                profile_->setSkipSpectrum(false);
+                profile_ = &profile;
+                setBudget();
+                deadlineMonitor_.reset();
+                deadlineMonitor_.modeChanged();
+                iOutput_ = 0;
+            }
+
+            bool isDegraded() const
+            {
+                return deadlineMonitor_.mode() == MonitorT::Mode::Degraded;
+            }
+
+            // estimate of the last processed measurement
+            uint8_t getBpm() const
+            {
+                return bpm_;
+            }
+
+            const MonitorT& monitor() const
+            {
+                return deadlineMonitor_;
+            }
+        private:
+            void setBudget()
+            {
+                using namespace std::chrono;
+                deadlineMonitor_.setBudget(duration_cast<microseconds>(profile_->sampleTime()) * BudgetPercent / 100);
+            }
+        private:
+            MonitorT deadlineMonitor_;
+            IPipelineProfile* profile_;
+            std::size_t iOutput_{};
+            uint8_t bpm_{};
+            std::array<char, 64> line_{};
+    };
+}
+
+#endif //_PPG_OUTPUT_STAGE_HPP
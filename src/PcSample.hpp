@@ -0,0 +1,16 @@
+#ifndef _PPG_PC_SAMPLE_HPP
+#define _PPG_PC_SAMPLE_HPP
+
+#include <cstdint>
+
+namespace Profiler
+{
+    // one sample of the PC sampling profiler
+    struct PcSample
+    {
+        uint32_t pc;        //< interrupted program counter, 0 if an interrupt handler was interrupted
+        uint32_t thread;    //< address of the interrupted thread (struct k_thread)
+    };
+}
+
+#endif //_PPG_PC_SAMPLE_HPP
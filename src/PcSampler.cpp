@@ -0,0 +1,105 @@
+#include "PcSampler.hpp"
+
+#include <zephyr/drivers/counter.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(ppg);
+
+namespace
+{
+    // PC of the interrupted thread, 0 if another interrupt was interrupted
+    // or the architecture doesn't expose the exception frame
+    uint32_t interruptedPc()
+    {
+#if defined(CONFIG_CPU_CORTEX_M)
+        // RETTOBASE is set only if no other exception is active, then the
+        // interrupted context is a thread and its exception frame is on the process stack
+        if((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) == 0)
+        {
+            return 0;
+        }
+        const auto* const frame = reinterpret_cast<const uint32_t*>(__get_PSP());
+        return frame[6]; //< r0-r3, r12, lr, pc, xpsr
+#else
+        return 0;
+#endif
+    }
+}
+
+namespace Profiler
+{
+    PcSampler::PcSampler(const device* const dev)
+        : Device{dev}
+    { }
+
+    bool PcSampler::start(const uint16_t rate)
+    {
+        if(rate == 0 || running_)
+        {
+            return false;
+        }
+        counter_top_cfg top{};
+        top.ticks = counter_get_frequency(device_) / rate;
+        top.callback = &PcSampler::onTop;
+        top.user_data = this;
+        top.flags = 0;
+        if(top.ticks == 0 || counter_set_top_value(device_, &top) != 0)
+        {
+            LOG_ERR("Can't set profiler timer to %u Hz", rate);
+            return false;
+        }
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        numLost_.store(0, std::memory_order_relaxed);
+        if(counter_start(device_) != 0)
+        {
+            LOG_ERR("Can't start profiler timer");
+            return false;
+        }
+        rate_ = rate;
+        running_ = true;
+        return true;
+    }
+
+    void PcSampler::stop()
+    {
+        if(!running_)
+        {
+            return;
+        }
+        counter_stop(device_);
+        running_ = false;
+    }
+
+    std::size_t PcSampler::drain(std::span<PcSample> out)
+    {
+        const auto head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        std::size_t numDrained = 0;
+        while(tail != head && numDrained < out.size())
+        {
+            out[numDrained++] = ring_[tail & (RingSize - 1)];
+            ++tail;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return numDrained;
+    }
+
+    void PcSampler::onTop(const device*, void* userData)
+    {
+        static_cast<PcSampler*>(userData)->sample();
+    }
+
+    void PcSampler::sample()
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if(head - tail_.load(std::memory_order_acquire) >= RingSize)
+        {
+            numLost_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring_[head & (RingSize - 1)] = PcSample{interruptedPc(), static_cast<uint32_t>(reinterpret_cast<uintptr_t>(k_current_get()))};
+        head_.store(head + 1, std::memory_order_release);
+    }
+}
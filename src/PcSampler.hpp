@@ -0,0 +1,47 @@
+#ifndef _PPG_PC_SAMPLER_HPP
+#define _PPG_PC_SAMPLER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Device.hpp"
+#include "PcSample.hpp"
+
+namespace Profiler
+{
+    // Statistical profiler, a counter alarm interrupts at a fixed rate and records
+    // the interrupted PC and thread into a lock-free single producer, single consumer ring,
+    // drained from thread context
+    class PcSampler
+        : public Hardware::Device
+    {
+        public:
+            static constexpr std::size_t RingSize = CONFIG_PPG_PROFILER_RING_SIZE;
+            static_assert((RingSize & (RingSize - 1)) == 0, "profiler ring size must be a power of 2");
+        public:
+            PcSampler(const device* const dev);
+            bool start(const uint16_t rate);
+            void stop();
+            bool isRunning() const { return running_; }
+            uint16_t getRate() const { return rate_; }
+            // moves the recorded samples to out, returns number of samples moved
+            std::size_t drain(std::span<PcSample> out);
+            // samples lost because the ring was full
+            uint32_t getNumLost() const { return numLost_.load(std::memory_order_relaxed); }
+        private:
+            static void onTop(const device* dev, void* userData);
+            void sample();
+        private:
+            std::array<PcSample, RingSize> ring_{};
+            std::atomic<uint32_t> head_{};  //< written by the interrupt
+            std::atomic<uint32_t> tail_{};  //< written by drain
+            std::atomic<uint32_t> numLost_{};
+            uint16_t rate_{};
+            bool running_{};
+    };
+}
+
+#endif //_PPG_PC_SAMPLER_HPP
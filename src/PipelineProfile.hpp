@@ -0,0 +1,145 @@
+#ifndef _PPG_PIPELINE_PROFILE_HPP
+#define _PPG_PIPELINE_PROFILE_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "PpgFilter.hpp"
+#include "PpgMeasurement.hpp"
+#include "HrProcessor.hpp"
+#if defined(CONFIG_PPG_RESAMPLING)
+#include "Resampler.hpp"
+#endif
+
+namespace Processor
+{
+    // Sample rate, filter and heart rate windows of the processing pipeline,
+    // profiles are pre-instantiated and switched at runtime
+    class IPipelineProfile
+    {
+        public:
+            virtual std::string_view name() const = 0;
+            virtual uint16_t sampleRate() const = 0;
+            virtual std::chrono::milliseconds sampleTime() const = 0;
+            virtual PpgFilter& filter() = 0;
+            virtual uint8_t processHr(const PpgMeasurement& measurement) = 0;
+            // skips the heart rate spectral frames while enabled, the last estimate is kept
+            virtual void setSkipSpectrum(const bool skip) = 0;
+            virtual uint32_t getNumSkippedFrames() const = 0;
+            // heart rate band spectrum of every analysis frame, see HeartRate::takeSpectrum
+            virtual void setSpectrumCapture(const bool enabled) = 0;
+            virtual std::optional<SpectrumFrame> takeSpectrum() = 0;
+#if defined(CONFIG_PPG_RESAMPLING)
+            // grid samples interpolated over dropped samples, and grid restarts after long gaps
+            virtual uint32_t getNumFilledSamples() const = 0;
+            virtual uint32_t getNumResyncs() const = 0;
+#endif
+            // clears filter and heart rate state, called when the profile is activated
+            virtual void reset() = 0;
+    };
+
+    template <
+        uint16_t SampleRateHz
+        , size_t NumHrSamples
+        , size_t NumHrSamplesHistory
+        , size_t FftLength
+    >
+    class PipelineProfile
+        : public IPipelineProfile
+    {
+        public:
+            static constexpr uint16_t SampleRate = SampleRateHz;
+        public:
+            PipelineProfile(std::string_view name)
+                : name_{name}
+                , filter_{makePpgFilter<SampleRate>()}
+                , hr_{SampleRate}
+#if defined(CONFIG_PPG_RESAMPLING)
+                , resampler_{SampleRate, std::chrono::milliseconds(CONFIG_PPG_RESAMPLER_MAX_GAP_MS)}
+#endif
+            { }
+
+            std::string_view name() const override { return name_; }
+            uint16_t sampleRate() const override { return SampleRate; }
+            std::chrono::milliseconds sampleTime() const override { return std::chrono::milliseconds(1000 / SampleRate); }
+            PpgFilter& filter() override { return filter_; }
+
+            uint8_t processHr(const PpgMeasurement& measurement) override
+            {
+#if defined(CONFIG_PPG_RESAMPLING)
+                // the heart rate history is filled from the uniform grid, not from the jittered samples
+                resampler_.process(measurement.timestamp, measurement.filtered, [this, &measurement](const float32_t sample) {
+                    PpgMeasurement resampled = measurement;
+                    resampled.filtered = static_cast<int16_t>(std::lround(sample));
+                    bpm_ = hr_.process(resampled);
+                });
+                return bpm_;
+#else
+                return hr_.process(measurement);
+#endif
+            }
+
+            void setSkipSpectrum(const bool skip) override
+            {
+                hr_.setSpectrumEnabled(!skip);
+            }
+
+            uint32_t getNumSkippedFrames() const override
+            {
+                return hr_.getNumSkippedFrames();
+            }
+
+            void setSpectrumCapture(const bool enabled) override
+            {
+                hr_.setSpectrumCapture(enabled);
+            }
+
+            std::optional<SpectrumFrame> takeSpectrum() override
+            {
+                return hr_.takeSpectrum();
+            }
+
+#if defined(CONFIG_PPG_RESAMPLING)
+            uint32_t getNumFilledSamples() const override
+            {
+                return resampler_.getNumFilled();
+            }
+
+            uint32_t getNumResyncs() const override
+            {
+                return resampler_.getNumResyncs();
+            }
+#endif
+
+            void reset() override
+            {
+                filter_.reset();
+                hr_.reset();
+#if defined(CONFIG_PPG_RESAMPLING)
+                resampler_.reset();
+                bpm_ = 0;
+#endif
+            }
+        private:
+            std::string_view name_;
+            PpgFilter filter_;
+#if defined(CONFIG_PPG_HR_HARMONIC_ESTIMATOR)
+            HeartRate<NumHrSamples, NumHrSamplesHistory, FftLength, HarmonicHrEstimator<FftLength>> hr_;
+#else
+            HeartRate<NumHrSamples, NumHrSamplesHistory, FftLength> hr_;
+#endif
+#if defined(CONFIG_PPG_RESAMPLING)
+#if defined(CONFIG_PPG_RESAMPLER_CUBIC)
+            Dsp::Resampler<Dsp::Interpolation::Cubic> resampler_;
+#else
+            Dsp::Resampler<Dsp::Interpolation::Linear> resampler_;
+#endif
+            uint8_t bpm_{};
+#endif
+    };
+}
+
+#endif //_PPG_PIPELINE_PROFILE_HPP
@@ -0,0 +1,40 @@
+#ifndef _PPG_PPG_FILTER_HPP
+#define _PPG_PPG_FILTER_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "FilterChain.hpp"
+#include "IIRFilter.hpp"
+
+namespace Processor
+{
+    // filter applied to raw proximity samples, shared by the firmware and host tools
+    using PpgFilter = Dsp::FilterChain<Dsp::IIRFilter<2>>;
+    using PpgFilterCoeffsT = std::array<float32_t, 5>;
+
+    // sos = sig.butter(1, [0.5, 3], btype='bandpass', fs=SampleRate, output='sos')
+    // only defined for the supported sample rates
+    template <uint16_t SampleRate>
+    struct PpgFilterCoeffs;
+
+    template <>
+    struct PpgFilterCoeffs<25>
+    {
+        static constexpr PpgFilterCoeffsT value{ 0.24523728f, 0.0f, -0.24523728f, 1.4361496f, -0.50952545f };
+    };
+
+    template <>
+    struct PpgFilterCoeffs<50>
+    {
+        static constexpr PpgFilterCoeffsT value{ 0.13672873f, 0.0f, -0.13672873f, 1.705965f, -0.72654253f };
+    };
+
+    template <uint16_t SampleRate = 50>
+    PpgFilter makePpgFilter()
+    {
+        return PpgFilter{Dsp::IIRFilter<2>{PpgFilterCoeffs<SampleRate>::value}};
+    }
+}
+
+#endif //_PPG_PPG_FILTER_HPP
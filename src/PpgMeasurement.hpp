@@ -0,0 +1,16 @@
+#ifndef _PPG_PPG_MEASUREMENT_HPP
+#define _PPG_PPG_MEASUREMENT_HPP
+
+#include <cstdint>
+
+namespace Processor
+{
+    struct PpgMeasurement
+    {
+        uint64_t timestamp;
+        uint16_t raw;
+        int16_t filtered;
+    };
+}
+
+#endif //_PPG_PPG_MEASUREMENT_HPP
@@ -1,50 +1,145 @@
 #include "PpgProcessor.hpp"
-
-#include <zephyr/logging/log.h>
+#include "Trace.hpp"
+#include "Log.hpp"
 
 LOG_MODULE_DECLARE(ppg);
 
 namespace Processor
 {
-    Ppg::Ppg(Ppg::Proximity& sensor)
+    Ppg::Ppg(Hardware::IProximity& sensor, PpgFilter& filter, QueueT& queue)
         : sensor_{sensor}
-        // sos = sig.butter(1, [0.5, 3], btype='bandpass', fs=fs, output='sos')
-        , filter_{{ 0.13672873f, 0.0f, -0.13672873f, 1.705965f, -0.72654253f }}
-    {
-        k_msgq_init(&queue_, queueBuffer_, sizeof(Measurement), queueSize_);
-    }
+        , filter_{&filter}
+        , queue_{queue}
+    { }
 
     bool Ppg::measure(const uint64_t& timestamp)
     {
-        Measurement measurement{};
         // create new measurement
         auto proximity = sensor_.getProximity();
-        if(proximity.has_value())
+        if(!proximity.has_value())
         {
-            measurement.raw = proximity.value();
-            measurement.filtered = filter_(measurement.raw);
+            return false;
         }
-        else
+        if(!primed_)
         {
-            return false;
+            // start the filter from steady state at the first sample's DC level
+            filter_->prime(static_cast<float32_t>(proximity.value()));
+            primed_ = true;
         }
+        auto& measurement = pending_[iBlock_];
         measurement.timestamp = timestamp;
-        // put measurement in queue
-        if(k_msgq_put(&queue_, &measurement, K_NO_WAIT) != 0)
+        measurement.raw = proximity.value();
+        rawBlock_[iBlock_] = measurement.raw;
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+        if(accelerometer_)
         {
-            LOG_WRN("Queue is full. Sample dropped.");
-            return false;
+            // hold the last acceleration if a read fails, the PPG sample is still usable
+            const auto acceleration = accelerometer_->getAcceleration();
+            if(acceleration.has_value())
+            {
+                lastAcceleration_ = acceleration.value();
+            }
+            motionBlock_[iBlock_] = lastAcceleration_;
+        }
+#endif
+        iBlock_++;
+        if(iBlock_ < BlockSize)
+        {
+            return true;
+        }
+        // filter the whole block at once
+        iBlock_ = 0;
+        return publishBlock(BlockSize);
+    }
+
+    bool Ppg::flush()
+    {
+        const auto numSamples = iBlock_;
+        iBlock_ = 0;
+        return numSamples ? publishBlock(numSamples) : true;
+    }
+
+    void Ppg::setFilter(PpgFilter& filter)
+    {
+        filter_ = &filter;
+    }
+
+    std::size_t Ppg::getBacklog()
+    {
+        return queue_.size();
+    }
+
+    uint32_t Ppg::getNumDropped() const
+    {
+        return numDropped_;
+    }
+
+    bool Ppg::publishBlock(const std::size_t numSamples)
+    {
+        filter_->process(std::span<const float32_t>{rawBlock_.data(), numSamples}
+                        , std::span<float32_t>{filteredBlock_.data(), numSamples});
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+        if(accelerometer_)
+        {
+            const auto duration = Benchmark::benchmark(cycleCounter_, [this, numSamples] {
+                motionCanceller_.process(std::span<const Hardware::Acceleration>{motionBlock_.data(), numSamples}
+                                        , std::span<float32_t>{filteredBlock_.data(), numSamples});
+            });
+            motionCycles_ += duration.count();
+            motionSamples_ += numSamples;
+        }
+#endif
+        bool published = true;
+        for(std::size_t iSample = 0; iSample < numSamples; ++iSample)
+        {
+            auto& measurement = pending_[iSample];
+            measurement.filtered = filteredBlock_[iSample];
+            // put measurement in queue
+            if(!queue_.put(measurement))
+            {
+                LOG_WRN("Queue is full. Sample dropped.");
+                numDropped_++;
+                published = false;
+            }
+            PPG_TRACE(QueuePut, queue_.size());
+        }
+        return published;
+    }
+
+    void Ppg::reset()
+    {
+        // drop partially collected block, its samples would be stale on restart
+        iBlock_ = 0;
+        primed_ = false;
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+        motionCanceller_.reset();
+#endif
+    }
+
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+    void Ppg::setMotionReference(Hardware::Accelerometer& accelerometer)
+    {
+        accelerometer_ = &accelerometer;
+        motionCanceller_.reset();
+    }
+
+    std::optional<uint32_t> Ppg::getMotionCyclesPerSample() const
+    {
+        if(motionSamples_ == 0)
+        {
+            return {};
         }
-        return true;
+        return static_cast<uint32_t>(motionCycles_ / motionSamples_);
     }
+#endif
 
     std::optional<Ppg::Measurement> Ppg::getMeasurement(const std::chrono::milliseconds& timeout)
     {
-        Measurement measurement;
-        if(k_msgq_get(&queue_, &measurement, K_MSEC(timeout.count())) == 0)
+        const auto measurement = queue_.get(timeout);
+        if(measurement.has_value())
         {
-            return measurement;
+            PPG_TRACE(QueueGet, queue_.size());
         }
-        return {};
+        return measurement;
     }
 }
\ No newline at end of file
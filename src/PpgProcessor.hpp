@@ -1,38 +1,81 @@
 #ifndef _PPG_PPG_PROCESSOR_HPP
 #define _PPG_PPG_PROCESSOR_HPP
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <optional>
 
-#include <zephyr/kernel.h>
+#include "IProximity.hpp"
+#include "MessageQueue.hpp"
+#include "PpgFilter.hpp"
+#include "PpgMeasurement.hpp"
 
-#include "Proximity.hpp"
-#include "IIRFilter.hpp"
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+#include "Accelerometer.hpp"
+#include "CycleCounter.hpp"
+#include "MotionCanceller.hpp"
+#endif
 
 namespace Processor
 {
     class Ppg
     {
-        using Proximity = Hardware::Proximity;
         public:
-            struct Measurement
-            {
-                uint64_t timestamp;
-                uint16_t raw;
-                int16_t filtered;
-            };
+            using Measurement = PpgMeasurement;
+            using QueueT = Hardware::IMessageQueue<Measurement>;
+            // raw samples are filtered in blocks of BlockSize, with one filter call per block
+            static constexpr std::size_t BlockSize = CONFIG_PPG_FILTER_BLOCK_SIZE;
+            // message queue capacity, must hold at least two full blocks
+            static constexpr std::size_t QueueSize = std::max<std::size_t>(10, 2 * BlockSize);
         public:
-            Ppg(Proximity& sensor);
+            // the queue holds QueueSize measurements
+            Ppg(Hardware::IProximity& sensor, PpgFilter& filter, QueueT& queue);
             bool measure(const uint64_t& timestamp);
             std::optional<Measurement> getMeasurement(const std::chrono::milliseconds& timeout);
+            void reset();
+            // filters and publishes the partially collected block, call only while not measuring
+            bool flush();
+            // call only while not measuring
+            void setFilter(PpgFilter& filter);
+            // number of filtered samples waiting in the queue
+            std::size_t getBacklog();
+            // number of samples dropped because the queue was full
+            uint32_t getNumDropped() const;
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+            // enables motion artifact cancellation, the accelerometer is sampled with every measurement,
+            // call only while not measuring
+            void setMotionReference(Hardware::Accelerometer& accelerometer);
+            // average CPU cycles per sample added by the motion cancellation stage
+            std::optional<uint32_t> getMotionCyclesPerSample() const;
+#endif
         private:
-            Proximity& sensor_;
-            Dsp::IIRFilter<2> filter_;
+            bool publishBlock(const std::size_t numSamples);
+        private:
+            Hardware::IProximity& sensor_;
+            PpgFilter* filter_;
+            // block filtering related
+            using BlockT = std::array<float32_t, BlockSize>;
+            BlockT rawBlock_{};
+            BlockT filteredBlock_{};
+            std::array<Measurement, BlockSize> pending_{};
+            std::size_t iBlock_{};
+            bool primed_{};
+#if defined(CONFIG_PPG_MOTION_CANCELLATION)
+            // motion cancellation related
+            using MotionCancellerT = MotionCanceller<CONFIG_PPG_MOTION_NLMS_TAPS, BlockSize>;
+            Hardware::Accelerometer* accelerometer_{};
+            std::array<Hardware::Acceleration, BlockSize> motionBlock_{};
+            Hardware::Acceleration lastAcceleration_{};
+            MotionCancellerT motionCanceller_{};
+            CycleCounter cycleCounter_{};
+            uint64_t motionCycles_{};
+            uint64_t motionSamples_{};
+#endif
             // message queue related
-            static constexpr std::size_t queueSize_ = 10;
-            char __aligned(4) queueBuffer_[queueSize_ * sizeof(Measurement)]{};
-            k_msgq queue_;
+            QueueT& queue_;
+            uint32_t numDropped_{};
     };
 }
 
@@ -0,0 +1,73 @@
+#ifndef _PPG_PROFILE_RECORD_HPP
+#define _PPG_PROFILE_RECORD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "PcSample.hpp"
+#include "SpectrumRecord.hpp"
+
+// Binary record of PC samples, written over USB-CDC between the text sample lines,
+// framed like SpectrumRecord (non-ASCII sync, CRC-16/CCITT-FALSE)
+//
+// Record layout (little-endian):
+//   Header
+//   PcSample samples[numSamples]
+//   uint16_t crc           CRC-16/CCITT-FALSE of header and samples
+namespace ProfileRecord
+{
+    static constexpr std::array<uint8_t, 2> Sync{0xA5, 0xC3};
+    static constexpr uint8_t Version = 1;
+    static constexpr std::size_t MaxSamples = 64;
+
+    struct Header
+    {
+        std::array<uint8_t, 2> sync;
+        uint8_t version;
+        uint8_t numSamples;
+        uint16_t rate;          //< Hz, sampling rate
+        uint16_t reserved;
+        uint32_t numLost;       //< samples lost to a full ring since the profiler started
+    };
+    static_assert(sizeof(Header) == 12);
+    static_assert(sizeof(Profiler::PcSample) == 8);
+
+    static constexpr std::size_t CrcSize = sizeof(uint16_t);
+    static constexpr std::size_t MaxSize = sizeof(Header) + MaxSamples * sizeof(Profiler::PcSample) + CrcSize;
+
+    constexpr std::size_t size(const std::size_t numSamples)
+    {
+        return sizeof(Header) + numSamples * sizeof(Profiler::PcSample) + CrcSize;
+    }
+
+    // writes the record of up to MaxSamples samples to out, returns its size, 0 if out is too small
+    inline std::size_t encode(std::span<const Profiler::PcSample> samples, const uint16_t rate, const uint32_t numLost
+                            , std::span<uint8_t> out)
+    {
+        const auto numSamples = std::min(samples.size(), MaxSamples);
+        const auto recordSize = size(numSamples);
+        if(out.size() < recordSize)
+        {
+            return 0;
+        }
+        Header header{};
+        header.sync = Sync;
+        header.version = Version;
+        header.numSamples = static_cast<uint8_t>(numSamples);
+        header.rate = rate;
+        header.numLost = numLost;
+        std::memcpy(out.data(), &header, sizeof(header));
+        const auto payloadSize = numSamples * sizeof(Profiler::PcSample);
+        std::memcpy(out.data() + sizeof(header), samples.data(), payloadSize);
+        const auto crc = SpectrumRecord::crc16(out.first(sizeof(header) + payloadSize));
+        out[sizeof(header) + payloadSize] = static_cast<uint8_t>(crc & 0xFF);
+        out[sizeof(header) + payloadSize + 1] = static_cast<uint8_t>(crc >> 8);
+        return recordSize;
+    }
+}
+
+#endif //_PPG_PROFILE_RECORD_HPP
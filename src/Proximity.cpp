@@ -1,5 +1,7 @@
 #include "Proximity.hpp"
 
+#include "Trace.hpp"
+
 namespace Hardware
 {
     Proximity::Proximity(const device* const dev)
@@ -9,7 +11,10 @@ namespace Hardware
     std::optional<Proximity::ValueT> Proximity::getProximity()
     {
         const auto dev = getDevicePointer();
-        if(sensor_sample_fetch(dev) < 0)
+        PPG_TRACE(SensorFetchBegin, 0);
+        const bool fetched = sensor_sample_fetch(dev) >= 0;
+        PPG_TRACE(SensorFetchEnd, fetched);
+        if(!fetched)
         {
             return {};
         }
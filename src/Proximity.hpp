@@ -7,17 +7,17 @@
 #include <zephyr/drivers/sensor.h>
 
 #include "Device.hpp"
+#include "IProximity.hpp"
 
 namespace Hardware
 {
     class Proximity
         : public Device
+        , public IProximity
     {
-        public:
-            using ValueT = uint16_t;
         public:
             Proximity(const device* const dev);
-            std::optional<ValueT> getProximity();
+            std::optional<ValueT> getProximity() override;
     };
 }
 
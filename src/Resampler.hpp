@@ -0,0 +1,193 @@
+#ifndef _PPG_RESAMPLER_HPP
+#define _PPG_RESAMPLER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "DspBackend.hpp"
+
+namespace Dsp
+{
+    enum class Interpolation
+    {
+        Linear,
+        Cubic, //< 4 point Lagrange in Farrow form, output is delayed by one more input sample
+    };
+
+    // Streaming resampler of timestamped samples onto a uniform grid at fs.
+    // Intervals longer than 1.5 periods (dropped samples) are bridged by linear interpolation and counted as filled.
+    // Gaps longer than maxGap, or timestamps going backwards, restart the grid at the new sample.
+    template <Interpolation Kind = Interpolation::Linear>
+    class Resampler
+    {
+        public:
+            Resampler(const uint16_t fs, const std::chrono::microseconds& maxGap)
+                : periodNs_{1000000000U / fs}
+                , maxGapNs_{static_cast<uint64_t>(maxGap.count()) * 1000U}
+                , times_{}
+                , values_{}
+                , numPoints_{}
+                , gridTime_{}
+                , numFilled_{}
+                , numResyncs_{}
+            { }
+
+            // takes a sample measured at timestampUs (microseconds), calls sink(float32_t) for every grid sample
+            // which became available, returns the number of grid samples
+            template <typename SinkF>
+            size_t process(const uint64_t timestampUs, const float32_t sample, SinkF&& sink)
+            {
+                const uint64_t time = timestampUs * 1000U;
+                size_t numOutput = 0;
+                if(numPoints_ > 0)
+                {
+                    const uint64_t newest = times_[NumPoints - 1];
+                    if(time == newest)
+                    {
+                        return 0; //< duplicate, the first sample is kept
+                    }
+                    if(time < newest || time - newest > maxGapNs_)
+                    {
+                        if constexpr(Kind == Interpolation::Cubic)
+                        {
+                            // the last interval is still pending, close it with a linear end
+                            numOutput += flush(sink);
+                        }
+                        numPoints_ = 0;
+                        numResyncs_++;
+                    }
+                }
+                push(time, sample);
+                if(numPoints_ == 1)
+                {
+                    sink(sample);
+                    gridTime_ = time + periodNs_;
+                    return numOutput + 1;
+                }
+                if constexpr(Kind == Interpolation::Linear)
+                {
+                    numOutput += emitInterval(sink);
+                }
+                else if(numPoints_ >= 3)
+                {
+                    // interval between the two previous samples, the newest one completes the stencil
+                    numOutput += emitInterval(sink);
+                }
+                return numOutput;
+            }
+
+            // number of grid samples standing in for dropped samples
+            uint32_t getNumFilled() const
+            {
+                return numFilled_;
+            }
+
+            // number of times the grid was restarted because of a long gap or a timestamp going backwards
+            uint32_t getNumResyncs() const
+            {
+                return numResyncs_;
+            }
+
+            void reset()
+            {
+                numPoints_ = 0;
+                numFilled_ = 0;
+                numResyncs_ = 0;
+            }
+        private:
+            // last samples, the newest at NumPoints - 1
+            static constexpr size_t NumPoints = Kind == Interpolation::Linear ? 2 : 4;
+
+            void push(const uint64_t time, const float32_t sample)
+            {
+                for(size_t iPoint = 1; iPoint < NumPoints; ++iPoint)
+                {
+                    times_[iPoint - 1] = times_[iPoint];
+                    values_[iPoint - 1] = values_[iPoint];
+                }
+                times_[NumPoints - 1] = time;
+                values_[NumPoints - 1] = sample;
+                if(numPoints_ < NumPoints)
+                {
+                    numPoints_++;
+                }
+            }
+
+            bool isGap(const uint64_t from, const uint64_t to) const
+            {
+                return 2 * (to - from) > 3 * periodNs_;
+            }
+
+            // grid samples in the interval ending at the newest sample (linear)
+            // or at the sample before the newest (cubic)
+            template <typename SinkF>
+            size_t emitInterval(SinkF&& sink)
+            {
+                constexpr size_t iEnd = Kind == Interpolation::Linear ? NumPoints - 1 : NumPoints - 2;
+                const uint64_t t1 = times_[iEnd - 1];
+                const uint64_t t2 = times_[iEnd];
+                const float32_t x1 = values_[iEnd - 1];
+                const float32_t x2 = values_[iEnd];
+                const bool gap = isGap(t1, t2);
+                const float32_t invInterval = 1.0f / static_cast<float32_t>(t2 - t1);
+                if constexpr(Kind == Interpolation::Cubic)
+                {
+                    if(!gap)
+                    {
+                        // missing neighbours, at the start or across a gap, are extrapolated linearly
+                        const bool hasPrevious = numPoints_ == NumPoints && !isGap(times_[0], t1);
+                        const bool hasNext = !isGap(t2, times_[NumPoints - 1]);
+                        const float32_t x0 = hasPrevious ? values_[0] : 2.0f * x1 - x2;
+                        const float32_t x3 = hasNext ? values_[NumPoints - 1] : 2.0f * x2 - x1;
+                        // Farrow coefficients, y(mu) = ((c3 * mu + c2) * mu + c1) * mu + x1
+                        const float32_t c1 = x2 - x0 / 3.0f - x1 / 2.0f - x3 / 6.0f;
+                        const float32_t c2 = (x0 + x2) / 2.0f - x1;
+                        const float32_t c3 = (x3 - x0) / 6.0f + (x1 - x2) / 2.0f;
+                        size_t numOutput = 0;
+                        for(; gridTime_ <= t2; gridTime_ += periodNs_, ++numOutput)
+                        {
+                            const float32_t mu = static_cast<float32_t>(gridTime_ - t1) * invInterval;
+                            sink(((c3 * mu + c2) * mu + c1) * mu + x1);
+                        }
+                        return numOutput;
+                    }
+                }
+                size_t numOutput = 0;
+                for(; gridTime_ <= t2; gridTime_ += periodNs_, ++numOutput)
+                {
+                    const float32_t mu = static_cast<float32_t>(gridTime_ - t1) * invInterval;
+                    sink(x1 + mu * (x2 - x1));
+                }
+                if(gap && numOutput > 1)
+                {
+                    numFilled_ += numOutput - 1; //< one grid sample per interval stands for the measured one
+                }
+                return numOutput;
+            }
+
+            template <typename SinkF>
+            size_t flush(SinkF&& sink)
+            {
+                if(numPoints_ < 2)
+                {
+                    return 0;
+                }
+                // a linearly extrapolated sample one period after the newest completes the stencil
+                push(times_[NumPoints - 1] + periodNs_, 2.0f * values_[NumPoints - 1] - values_[NumPoints - 2]);
+                return emitInterval(sink);
+            }
+        private:
+            uint64_t periodNs_;
+            uint64_t maxGapNs_;
+            std::array<uint64_t, NumPoints> times_;
+            std::array<float32_t, NumPoints> values_;
+            size_t numPoints_;
+            uint64_t gridTime_;
+            uint32_t numFilled_;
+            uint32_t numResyncs_;
+    };
+}
+
+#endif //_PPG_RESAMPLER_HPP
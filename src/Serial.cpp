@@ -1,5 +1,7 @@
 #include "Serial.hpp"
 
+#include "Trace.hpp"
+
 #include <zephyr/kernel.h>
 #include <zephyr/usb/usb_device.h>
 #include <zephyr/drivers/uart.h>
@@ -24,10 +26,12 @@ namespace Hardware
 
     void Serial::write(const std::byte* const data, const std::size_t numBytes)
     {
+        PPG_TRACE(SerialWriteBegin, numBytes);
         for(std::size_t iByte = 0; iByte < numBytes; ++iByte)
         {
             uart_poll_out(getDevicePointer(), static_cast<uint8_t>(data[iByte]));
         }
+        PPG_TRACE(SerialWriteEnd, 0);
     }
     
     void Serial::read(std::byte* data, const std::size_t numBytes)
@@ -40,4 +44,15 @@ namespace Hardware
             }
         }
     }
+
+    std::size_t Serial::readAvailable(std::byte* data, const std::size_t maxBytes)
+    {
+        std::size_t numRead = 0;
+        while(numRead < maxBytes
+            && uart_poll_in(getDevicePointer(), reinterpret_cast<uint8_t*>(data + numRead)) == 0)
+        {
+            numRead++;
+        }
+        return numRead;
+    }
 }
\ No newline at end of file
@@ -16,6 +16,8 @@ namespace Hardware
             bool isOpen();
             void write(const std::byte* const data, const std::size_t numBytes);
             void read(std::byte* data, const std::size_t numBytes);
+            // reads only the bytes already received, returns number of bytes read
+            std::size_t readAvailable(std::byte* data, const std::size_t maxBytes);
     };
 }
 
@@ -0,0 +1,21 @@
+#ifndef _PPG_SPECTRUM_FRAME_HPP
+#define _PPG_SPECTRUM_FRAME_HPP
+
+#include <cstdint>
+#include <span>
+
+namespace Processor
+{
+    // heart rate band of the squared magnitude spectrum of one heart rate analysis frame
+    struct SpectrumFrame
+    {
+        uint16_t sampleRate;
+        uint16_t fftLength;
+        uint16_t firstBin;
+        uint8_t bpm;
+        bool provisional;
+        std::span<const float> magnitudeSqr; //< valid until the next frame
+    };
+}
+
+#endif //_PPG_SPECTRUM_FRAME_HPP
@@ -0,0 +1,106 @@
+#ifndef _PPG_SPECTRUM_RECORD_HPP
+#define _PPG_SPECTRUM_RECORD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "SpectrumFrame.hpp"
+
+// Binary record of one spectrum frame, written over USB-CDC between the text sample lines
+//
+// Record layout (little-endian):
+//   Header
+//   uint8_t bins[numBins]  level of every bin in DbStep dB steps below the peak, 255 for below
+//   uint16_t crc           CRC-16/CCITT-FALSE of header and bins
+//
+// The sync bytes are not ASCII, so a reader of the sample lines finds records
+// by the first byte of a line.
+namespace SpectrumRecord
+{
+    static constexpr std::array<uint8_t, 2> Sync{0xA5, 0x5A};
+    static constexpr uint8_t Version = 1;
+    static constexpr float DbStep = 0.5f;
+    static constexpr std::size_t MaxBins = 255;
+
+    struct Header
+    {
+        std::array<uint8_t, 2> sync;
+        uint8_t version;
+        uint8_t numBins;
+        uint16_t sampleRate;    //< Hz
+        uint16_t fftLength;
+        uint16_t firstBin;      //< bin of the first value, bin frequency is bin * sampleRate / fftLength
+        uint8_t bpm;
+        uint8_t flags;          //< Provisional
+        float peak;             //< largest squared magnitude in the band
+        uint64_t timestamp;     //< us, of the sample which completed the frame
+    };
+    static_assert(sizeof(Header) == 24);
+
+    enum Flags : uint8_t
+    {
+        Provisional = 1 << 0,
+    };
+
+    static constexpr std::size_t CrcSize = sizeof(uint16_t);
+    static constexpr std::size_t MaxSize = sizeof(Header) + MaxBins + CrcSize;
+
+    constexpr std::size_t size(const std::size_t numBins)
+    {
+        return sizeof(Header) + numBins + CrcSize;
+    }
+
+    constexpr uint16_t crc16(std::span<const uint8_t> data, uint16_t crc = 0xFFFF)
+    {
+        for(const auto byte : data)
+        {
+            crc ^= static_cast<uint16_t>(byte) << 8;
+            for(int iBit = 0; iBit < 8; ++iBit)
+            {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    // writes the record of frame to out, returns its size, 0 if out is too small
+    inline std::size_t encode(const Processor::SpectrumFrame& frame, const uint64_t timestamp, std::span<uint8_t> out)
+    {
+        const auto numBins = std::min(frame.magnitudeSqr.size(), MaxBins);
+        const auto recordSize = size(numBins);
+        if(out.size() < recordSize)
+        {
+            return 0;
+        }
+        const auto bins = frame.magnitudeSqr.first(numBins);
+        const float peak = bins.empty() ? 0.0f : *std::max_element(bins.begin(), bins.end());
+        Header header{};
+        header.sync = Sync;
+        header.version = Version;
+        header.numBins = static_cast<uint8_t>(numBins);
+        header.sampleRate = frame.sampleRate;
+        header.fftLength = frame.fftLength;
+        header.firstBin = frame.firstBin;
+        header.bpm = frame.bpm;
+        header.flags = frame.provisional ? Provisional : 0;
+        header.peak = peak;
+        header.timestamp = timestamp;
+        std::memcpy(out.data(), &header, sizeof(header));
+        for(std::size_t iBin = 0; iBin < numBins; ++iBin)
+        {
+            const float level = bins[iBin] > 0.0f && peak > 0.0f ? -10.0f * std::log10(bins[iBin] / peak) / DbStep : 255.0f;
+            out[sizeof(header) + iBin] = static_cast<uint8_t>(std::min(255.0f, level + 0.5f));
+        }
+        const auto crc = crc16(out.first(sizeof(header) + numBins));
+        out[sizeof(header) + numBins] = static_cast<uint8_t>(crc & 0xFF);
+        out[sizeof(header) + numBins + 1] = static_cast<uint8_t>(crc >> 8);
+        return recordSize;
+    }
+}
+
+#endif //_PPG_SPECTRUM_RECORD_HPP
@@ -0,0 +1,25 @@
+#ifndef _PPG_SYSTEM_CLOCK_HPP
+#define _PPG_SYSTEM_CLOCK_HPP
+
+#include <cstdint>
+
+#include <zephyr/kernel.h>
+
+#include "Clock.hpp"
+
+namespace Hardware
+{
+    // hardware cycle counter of the kernel, the timestamps wrap around with its 32 bits
+    class SystemClock
+        : public IClock
+    {
+        public:
+            uint64_t nowUs() override
+            {
+                return static_cast<uint64_t>(k_cycle_get_32()) * 1000000U
+                        / sys_clock_hw_cycles_per_sec();
+            }
+    };
+}
+
+#endif //_PPG_SYSTEM_CLOCK_HPP
@@ -1,5 +1,7 @@
 #include "Timer.hpp"
 
+#include "Trace.hpp"
+
 namespace Hardware
 {
     std::array<Timer*, Timer::maxNumTimers> Timer::timers{};
@@ -33,11 +35,13 @@ namespace Hardware
         {
             if(&(timers[iTimer]->timer_) == timer)
             {
+                PPG_TRACE(TimerExpiry, iTimer);
                 if(timers[iTimer]->callback_)
                 {
                     if(timers[iTimer]->workqueue_)
                     {
                         iTimerWorkqueue = iTimer;
+                        PPG_TRACE(WorkSubmit, iTimer);
                         k_work_submit(&Timer::work_);
                     }
                     else
@@ -51,6 +55,7 @@ namespace Hardware
 
     void Timer::workqueueFunction(k_work* work)
     {
+        PPG_TRACE(WorkStart, iTimerWorkqueue);
         if(timers[iTimerWorkqueue]->callback_)
         {
             timers[iTimerWorkqueue]->callback_();
@@ -1,34 +1,39 @@
 #ifndef _PPG_TIMER_HPP
 #define _PPG_TIMER_HPP
 
+#include <array>
 #include <cassert>
 #include <chrono>
-#include <functional>
 
 #include <zephyr/kernel.h>
 
+#include "Clock.hpp"
+
 namespace Hardware
 {
     class Timer
+        : public ITimer
     {
-        private:
-            using CallbackT = std::function<void()>;
         public:
             Timer();
-            ~Timer();
+            ~Timer() override;
 
-            template< class Rep, class Period >
-            void start(const std::chrono::duration<Rep, Period>& period, const CallbackT& callback, bool inIsr = false)
+            void stop() override
             {
-                callback_ = callback;
-                workqueue_ = !inIsr;
-                const auto periodUs = std::chrono::microseconds(period).count();
-                k_timer_start(&timer_, K_USEC(periodUs), K_USEC(periodUs));
+                k_timer_stop(&timer_);
+                if(workqueue_)
+                {
+                    // wait for an already submitted callback to finish
+                    k_work_sync sync;
+                    k_work_flush(&work_, &sync);
+                }
             }
-
-            void stop()
+        protected:
+            void startPeriodic(const std::chrono::microseconds& period, const CallbackT& callback, bool inIsr) override
             {
-                k_timer_stop(&timer_);
+                callback_ = callback;
+                workqueue_ = !inIsr;
+                k_timer_start(&timer_, K_USEC(period.count()), K_USEC(period.count()));
             }
         private:
             // for callbacks
@@ -0,0 +1,125 @@
+#include "Trace.hpp"
+
+#include <array>
+#include <atomic>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#if defined(CONFIG_CPU_CORTEX_M)
+#include "CycleCounter.hpp"
+#endif
+
+namespace
+{
+    static constexpr std::size_t RingSize = CONFIG_PPG_TRACE_RING_SIZE;
+    static_assert((RingSize & (RingSize - 1)) == 0, "trace ring size must be a power of 2");
+
+    // one ring per CPU, the lock only contends with drain
+    struct Ring
+    {
+        std::array<Trace::Record, RingSize> records{};
+        uint32_t head{};
+        uint32_t tail{};
+        k_spinlock lock{};
+    };
+
+    std::array<Ring, CONFIG_MP_MAX_NUM_CPUS> rings;
+    std::atomic<bool> enabled{};
+    std::atomic<uint32_t> numLost{};
+
+#if defined(CONFIG_CPU_CORTEX_M)
+    CycleCounter cycleCounter; //< enables CYCCNT
+
+    uint32_t timestamp()
+    {
+        return cycleCounter.now().time_since_epoch().count();
+    }
+#else
+    uint32_t timestamp()
+    {
+        return k_cycle_get_32();
+    }
+#endif
+}
+
+namespace Trace
+{
+    void record(const Event event, const uint16_t arg)
+    {
+        if(!enabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        const Record record{timestamp(), static_cast<uint8_t>(event), static_cast<uint8_t>(k_is_in_isr())
+                            , arg, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(k_current_get()))};
+        // interrupts are locked, so the CPU can't change until unlock
+        Ring& ring = rings[arch_curr_cpu()->id];
+        const k_spinlock_key_t key = k_spin_lock(&ring.lock);
+        if(ring.head - ring.tail < RingSize)
+        {
+            ring.records[ring.head++ & (RingSize - 1)] = record;
+        }
+        else
+        {
+            numLost.fetch_add(1, std::memory_order_relaxed);
+        }
+        k_spin_unlock(&ring.lock, key);
+    }
+
+    void setEnabled(const bool enable)
+    {
+        if(enable && !enabled.load())
+        {
+            for(auto& ring : rings)
+            {
+                const k_spinlock_key_t key = k_spin_lock(&ring.lock);
+                ring.tail = ring.head;
+                k_spin_unlock(&ring.lock, key);
+            }
+            numLost.store(0);
+        }
+        enabled.store(enable);
+    }
+
+    bool isEnabled()
+    {
+        return enabled.load();
+    }
+
+    std::size_t drain(const uint8_t cpu, std::span<Record> out)
+    {
+        if(cpu >= rings.size())
+        {
+            return 0;
+        }
+        Ring& ring = rings[cpu];
+        const k_spinlock_key_t key = k_spin_lock(&ring.lock);
+        std::size_t numDrained = 0;
+        while(ring.tail != ring.head && numDrained < out.size())
+        {
+            out[numDrained++] = ring.records[ring.tail++ & (RingSize - 1)];
+        }
+        k_spin_unlock(&ring.lock, key);
+        return numDrained;
+    }
+
+    uint8_t getNumCpus()
+    {
+        return static_cast<uint8_t>(rings.size());
+    }
+
+    uint32_t getNumLost()
+    {
+        return numLost.load(std::memory_order_relaxed);
+    }
+
+    uint32_t getFrequency()
+    {
+#if defined(CONFIG_CPU_CORTEX_M)
+        return CpuFrequency;
+#else
+        return sys_clock_hw_cycles_per_sec();
+#endif
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef _PPG_TRACE_HPP
+#define _PPG_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Timeline tracing of the pipeline events, selected at compile time with CONFIG_PPG_TRACE.
+// Every event is one record stamped with the cycle counter in a per-CPU ring,
+// streamed as TraceRecords and converted to CTF on the host by scripts/ctf_export.py.
+namespace Trace
+{
+    // ids of the CTF events, keep in sync with scripts/ctf_export.py
+    enum class Event : uint8_t
+    {
+        TimerExpiry,        //< arg: timer index
+        WorkSubmit,         //< arg: timer index
+        WorkStart,          //< arg: timer index
+        SensorFetchBegin,
+        SensorFetchEnd,     //< arg: 1 on success
+        QueuePut,           //< arg: samples in the queue
+        QueueGet,           //< arg: samples left in the queue
+        HrFrameBegin,
+        HrFrameEnd,         //< arg: BPM
+        SerialWriteBegin,   //< arg: number of bytes
+        SerialWriteEnd,
+        Count
+    };
+
+    // layout of the CTF event: header (timestamp, id), context (isr, arg, thread), no payload
+    struct Record
+    {
+        uint32_t timestamp; //< cycles
+        uint8_t id;
+        uint8_t isr;        //< 1 if recorded in an interrupt
+        uint16_t arg;
+        uint32_t thread;    //< address of the current thread (struct k_thread)
+    };
+    static_assert(sizeof(Record) == 12);
+
+#if defined(CONFIG_PPG_TRACE)
+    void record(const Event event, const uint16_t arg);
+    void setEnabled(const bool enabled);
+    bool isEnabled();
+    // moves the records of the ring of cpu to out, returns number of records moved
+    std::size_t drain(const uint8_t cpu, std::span<Record> out);
+    uint8_t getNumCpus();
+    // records lost because a ring was full, since enabled
+    uint32_t getNumLost();
+    // Hz, of the record timestamps
+    uint32_t getFrequency();
+#endif
+}
+
+#if defined(CONFIG_PPG_TRACE)
+#define PPG_TRACE(event, arg) ::Trace::record(::Trace::Event::event, static_cast<uint16_t>(arg))
+#else
+#define PPG_TRACE(event, arg) do { } while(0)
+#endif
+
+#endif //_PPG_TRACE_HPP
@@ -0,0 +1,74 @@
+#ifndef _PPG_TRACE_RECORD_HPP
+#define _PPG_TRACE_RECORD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "SpectrumRecord.hpp"
+#include "Trace.hpp"
+
+// Binary record of trace events of one CPU, written over USB-CDC between the text sample lines,
+// framed like SpectrumRecord (non-ASCII sync, CRC-16/CCITT-FALSE)
+//
+// Record layout (little-endian):
+//   Header
+//   Trace::Record events[numEvents]    CTF event records, see scripts/ctf_export.py
+//   uint16_t crc                       CRC-16/CCITT-FALSE of header and events
+namespace TraceRecord
+{
+    static constexpr std::array<uint8_t, 2> Sync{0xA5, 0x7E};
+    static constexpr uint8_t Version = 1;
+    static constexpr std::size_t MaxEvents = 32;
+
+    struct Header
+    {
+        std::array<uint8_t, 2> sync;
+        uint8_t version;
+        uint8_t numEvents;
+        uint8_t cpu;
+        uint8_t reserved[3];
+        uint32_t frequency;     //< Hz, of the event timestamps
+        uint32_t numLost;       //< events lost to a full ring since tracing was enabled
+    };
+    static_assert(sizeof(Header) == 16);
+
+    static constexpr std::size_t CrcSize = sizeof(uint16_t);
+    static constexpr std::size_t MaxSize = sizeof(Header) + MaxEvents * sizeof(Trace::Record) + CrcSize;
+
+    constexpr std::size_t size(const std::size_t numEvents)
+    {
+        return sizeof(Header) + numEvents * sizeof(Trace::Record) + CrcSize;
+    }
+
+    // writes the record of up to MaxEvents events to out, returns its size, 0 if out is too small
+    inline std::size_t encode(std::span<const Trace::Record> events, const uint8_t cpu, const uint32_t frequency
+                            , const uint32_t numLost, std::span<uint8_t> out)
+    {
+        const auto numEvents = std::min(events.size(), MaxEvents);
+        const auto recordSize = size(numEvents);
+        if(out.size() < recordSize)
+        {
+            return 0;
+        }
+        Header header{};
+        header.sync = Sync;
+        header.version = Version;
+        header.numEvents = static_cast<uint8_t>(numEvents);
+        header.cpu = cpu;
+        header.frequency = frequency;
+        header.numLost = numLost;
+        std::memcpy(out.data(), &header, sizeof(header));
+        const auto payloadSize = numEvents * sizeof(Trace::Record);
+        std::memcpy(out.data() + sizeof(header), events.data(), payloadSize);
+        const auto crc = SpectrumRecord::crc16(out.first(sizeof(header) + payloadSize));
+        out[sizeof(header) + payloadSize] = static_cast<uint8_t>(crc & 0xFF);
+        out[sizeof(header) + payloadSize + 1] = static_cast<uint8_t>(crc >> 8);
+        return recordSize;
+    }
+}
+
+#endif //_PPG_TRACE_RECORD_HPP
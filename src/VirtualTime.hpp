@@ -0,0 +1,225 @@
+#ifndef _PPG_VIRTUAL_TIME_HPP
+#define _PPG_VIRTUAL_TIME_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include "Clock.hpp"
+#include "MessageQueue.hpp"
+
+namespace Hardware
+{
+    // Time that only advances to the next scheduled event, the events run on the thread calling runNext or runUntil.
+    // Hours of samples pass in seconds, and every run has the same timing.
+    // Events at the same time run in the order they were scheduled.
+    class VirtualClock
+        : public IClock
+    {
+        public:
+            using EventT = std::function<void()>;
+            using EventId = uint64_t;
+        public:
+            uint64_t nowUs() override
+            {
+                return nowUs_;
+            }
+
+            // events in the past run at the current time
+            EventId schedule(const uint64_t timeUs, EventT event)
+            {
+                const EventId id = nextId_++;
+                events_.emplace(Key{std::max(timeUs, nowUs_), id}, std::move(event));
+                return id;
+            }
+
+            void cancel(const EventId id)
+            {
+                std::erase_if(events_, [id](const auto& event) { return event.first.id == id; });
+            }
+
+            // advances to the next event and runs it, returns false when none is scheduled
+            bool runNext()
+            {
+                if(events_.empty())
+                {
+                    return false;
+                }
+                auto event = events_.extract(events_.begin());
+                nowUs_ = event.key().timeUs;
+                event.mapped()();
+                numRun_++;
+                return true;
+            }
+
+            // runs the events up to the time, including the ones they schedule, then advances to it
+            void runUntil(const uint64_t timeUs)
+            {
+                while(!events_.empty() && events_.begin()->first.timeUs <= timeUs)
+                {
+                    runNext();
+                }
+                nowUs_ = std::max(nowUs_, timeUs);
+            }
+
+            // spends time, e.g. the processing time of the caller, running the events due meanwhile
+            void runFor(const std::chrono::microseconds& duration)
+            {
+                runUntil(nowUs_ + duration.count());
+            }
+
+            std::optional<uint64_t> getNextEventTime() const
+            {
+                if(events_.empty())
+                {
+                    return {};
+                }
+                return events_.begin()->first.timeUs;
+            }
+
+            std::size_t getNumScheduled() const
+            {
+                return events_.size();
+            }
+
+            uint64_t getNumRun() const
+            {
+                return numRun_;
+            }
+        private:
+            struct Key
+            {
+                uint64_t timeUs;
+                EventId id;
+                auto operator<=>(const Key&) const = default;
+            };
+        private:
+            std::map<Key, EventT> events_;
+            uint64_t nowUs_{};
+            EventId nextId_{};
+            uint64_t numRun_{};
+    };
+
+    // Periodic timer on virtual time, expiries are exact multiples of the period after start,
+    // the callback runs from VirtualClock::runNext in both the workqueue and the ISR mode
+    class VirtualTimer
+        : public ITimer
+    {
+        public:
+            VirtualTimer(VirtualClock& clock)
+                : clock_{clock}
+            { }
+
+            VirtualTimer(const VirtualTimer&) = delete;
+            VirtualTimer& operator=(const VirtualTimer&) = delete;
+
+            ~VirtualTimer() override
+            {
+                stop();
+            }
+
+            void stop() override
+            {
+                if(pending_.has_value())
+                {
+                    clock_.cancel(pending_.value());
+                    pending_.reset();
+                }
+            }
+
+            uint32_t getNumExpiries() const
+            {
+                return numExpiries_;
+            }
+        protected:
+            void startPeriodic(const std::chrono::microseconds& period, const CallbackT& callback, [[maybe_unused]] bool inIsr) override
+            {
+                stop();
+                periodUs_ = period.count();
+                callback_ = callback;
+                scheduleExpiry(clock_.nowUs() + periodUs_);
+            }
+        private:
+            void scheduleExpiry(const uint64_t timeUs)
+            {
+                pending_ = clock_.schedule(timeUs, [this, timeUs] {
+                    // the next expiry is scheduled first, so the callback can stop the timer
+                    scheduleExpiry(timeUs + periodUs_);
+                    numExpiries_++;
+                    if(callback_)
+                    {
+                        callback_();
+                    }
+                });
+            }
+        private:
+            VirtualClock& clock_;
+            CallbackT callback_;
+            uint64_t periodUs_{};
+            std::optional<VirtualClock::EventId> pending_;
+            uint32_t numExpiries_{};
+    };
+
+    // Message queue on virtual time, waiting in get runs the events due until an item arrives or the timeout passes
+    template <typename T, std::size_t Capacity>
+    class VirtualMessageQueue
+        : public IMessageQueue<T>
+    {
+        public:
+            VirtualMessageQueue(VirtualClock& clock)
+                : clock_{clock}
+            { }
+
+            bool put(const T& item) override
+            {
+                if(items_.size() == Capacity)
+                {
+                    return false;
+                }
+                items_.push_back(item);
+                maxSize_ = std::max(maxSize_, items_.size());
+                return true;
+            }
+
+            std::optional<T> get(const std::chrono::milliseconds& timeout) override
+            {
+                const uint64_t timeoutUs = clock_.nowUs() + std::chrono::microseconds(timeout).count();
+                while(items_.empty())
+                {
+                    const auto nextEventTime = clock_.getNextEventTime();
+                    if(!nextEventTime.has_value() || nextEventTime.value() > timeoutUs)
+                    {
+                        clock_.runUntil(timeoutUs);
+                        return {};
+                    }
+                    clock_.runNext();
+                }
+                const T item = items_.front();
+                items_.pop_front();
+                return item;
+            }
+
+            std::size_t size() override
+            {
+                return items_.size();
+            }
+
+            // most items queued at once
+            std::size_t getMaxSize() const
+            {
+                return maxSize_;
+            }
+        private:
+            VirtualClock& clock_;
+            std::deque<T> items_;
+            std::size_t maxSize_{};
+    };
+}
+
+#endif //_PPG_VIRTUAL_TIME_HPP
@@ -7,7 +7,8 @@ LOG_MODULE_REGISTER(ppg, LOG_LEVEL_INF);
 
 int main()
 {
-    Application app;
+    // statically allocated, profiles own large DSP buffers
+    static Application app;
 
     if(!app.run())
     {